@@ -0,0 +1,54 @@
+/**
+ * @file    Allocator_bench.cpp
+ * @ingroup benchmarks
+ * @brief   Benchmarks of an allocation-heavy workload with the pool allocator against the default SQLite allocator.
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#include <thread>
+#include <vector>
+#include <sqlite3.h>
+#include <benchmark/benchmark.h>
+#include <SQLiteCpp/Allocator.h>
+#include "Bench.h"
+
+// Bulk insert then sorted scan of 1000 rows in a private in-memory database, as in the unit tests
+static void workload() {
+  SQLite::Database db(SQLite::MEMORY);
+  createBenchTable(db, 1000);
+  SQLite::Statement query(db, "SELECT name, value FROM bench ORDER BY value DESC");
+  while (query.executeStep())
+    benchmark::DoNotOptimize(query.getColumn(0).getText());
+}
+
+// Run the workload on state.range(0) threads at once, each with its own connection
+static void runWorkload(benchmark::State& state) {
+  const int count = static_cast<int>(state.range(0));
+  for (auto _ : state) {
+    std::vector<std::thread> threads;
+    for (int i = 0; i < count; ++i)
+      threads.emplace_back(workload);
+    for (std::thread& thread : threads)
+      thread.join();
+  }
+  state.SetItemsProcessed(state.iterations() * count * 1000);
+}
+
+static void BM_Workload_Pool(benchmark::State& state) {
+  sqlite3_shutdown();
+  SQLite::configureAllocator();
+  const SQLite::AllocatorStats before = SQLite::getAllocatorStats();
+  runWorkload(state);
+  const SQLite::AllocatorStats after = SQLite::getAllocatorStats();
+  sqlite3_shutdown();
+  SQLite::restoreAllocator();
+  state.counters["cache_hit_rate"] = static_cast<double>(after.cacheHits - before.cacheHits) /
+                                     static_cast<double>(after.mallocCount - before.mallocCount);
+}
+BENCHMARK(BM_Workload_Pool)->Arg(1)->Arg(4)->UseRealTime();
+
+static void BM_Workload_System(benchmark::State& state) {
+  runWorkload(state);
+}
+BENCHMARK(BM_Workload_System)->Arg(1)->Arg(4)->UseRealTime();
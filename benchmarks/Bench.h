@@ -0,0 +1,43 @@
+/**
+ * @file    Bench.h
+ * @ingroup benchmarks
+ * @brief   Shared fixtures of the SQLiteCpp benchmarks.
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <string>
+#include <SQLiteCpp/Database.h>
+#include <SQLiteCpp/Statement.h>
+#include <SQLiteCpp/Transaction.h>
+
+/// Path to the bundled chinook sample database (defined by CMake)
+#ifndef SQLITECPP_BENCH_CHINOOK
+#define SQLITECPP_BENCH_CHINOOK "examples/chinook/chinook.db3"
+#endif
+
+/// Number of rows of the "tracks" table of the chinook database
+const int CHINOOK_TRACKS = 3503;
+
+/**
+ * @brief Create the synthetic "bench" table (id INTEGER PRIMARY KEY, name TEXT, value REAL, count INTEGER)
+ *        and fill it with aRows rows in a single transaction.
+ */
+inline void createBenchTable(SQLite::Database& aDatabase, const int aRows) {
+  aDatabase.exec("DROP TABLE IF EXISTS bench");
+  aDatabase.exec("CREATE TABLE bench (id INTEGER PRIMARY KEY, name TEXT, value REAL, count INTEGER)");
+
+  SQLite::Transaction transaction(aDatabase);
+  SQLite::Statement insert(aDatabase, "INSERT INTO bench VALUES (?, ?, ?, ?)");
+  for (int i = 1; i <= aRows; ++i) {
+    insert.bind(1, i);
+    insert.bind(2, "name #" + std::to_string(i));
+    insert.bind(3, i * 0.5);
+    insert.bind(4, i % 100);
+    insert.exec();
+    insert.reset();
+  }
+  transaction.commit();
+}
@@ -0,0 +1,47 @@
+/**
+ * @file    Export_bench.cpp
+ * @ingroup benchmarks
+ * @brief   Benchmark of the buffered CSV exporter against operator<<(std::ostream&, const Column&).
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#include <sstream>
+#include <benchmark/benchmark.h>
+#include <SQLiteCpp/Export.h>
+#include "Bench.h"
+
+static const int EXPORT_ROWS = 100000;
+
+// exportCsv() of the bench table
+static void BM_Export_Csv(benchmark::State& state) {
+  SQLite::Database db(":memory:", SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE);
+  createBenchTable(db, EXPORT_ROWS);
+  SQLite::Statement query(db, "SELECT id, name, value, count FROM bench");
+  for (auto _ : state) {
+    std::ostringstream output;
+    benchmark::DoNotOptimize(SQLite::exportCsv(query, output));
+    query.reset();
+  }
+  state.SetItemsProcessed(state.iterations() * EXPORT_ROWS);
+}
+BENCHMARK(BM_Export_Csv)->Unit(benchmark::kMillisecond);
+
+// Same output written Column by Column with operator<< (without any quoting)
+static void BM_Export_Stream(benchmark::State& state) {
+  SQLite::Database db(":memory:", SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE);
+  createBenchTable(db, EXPORT_ROWS);
+  SQLite::Statement query(db, "SELECT id, name, value, count FROM bench");
+  for (auto _ : state) {
+    std::ostringstream output;
+    output << "id,name,value,count\n";
+    while (query.executeStep()) {
+      output << query.getColumn(0) << ',' << query.getColumn(1) << ','
+             << query.getColumn(2) << ',' << query.getColumn(3) << '\n';
+    }
+    benchmark::DoNotOptimize(output.tellp());
+    query.reset();
+  }
+  state.SetItemsProcessed(state.iterations() * EXPORT_ROWS);
+}
+BENCHMARK(BM_Export_Stream)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,83 @@
+/**
+ * @file    Function_bench.cpp
+ * @ingroup benchmarks
+ * @brief   Benchmarks of the call overhead of type-safe SQL functions against raw sqlite3 C functions.
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#include <string_view>
+#include <sqlite3.h>
+#include <benchmark/benchmark.h>
+#include "Bench.h"
+
+static const int ROWS = 10000;
+
+// Raw sqlite3 C implementation of "scale(value, count)"
+static void rawScale(sqlite3_context* apContext, int, sqlite3_value** apArgs) {
+  sqlite3_result_double(apContext, sqlite3_value_double(apArgs[0]) * sqlite3_value_int64(apArgs[1]));
+}
+
+// Raw sqlite3 C implementation of "name_length(name)"
+static void rawNameLength(sqlite3_context* apContext, int, sqlite3_value** apArgs) {
+  sqlite3_value_text(apArgs[0]);
+  sqlite3_result_int(apContext, sqlite3_value_bytes(apArgs[0]));
+}
+
+// Call a numeric function with 2 arguments on each row of the synthetic table
+static void BM_NumericFunction_Wrapper(benchmark::State& state) {
+  SQLite::Database db(SQLite::MEMORY);
+  createBenchTable(db, ROWS);
+  db.createFunction("scale", [](double aValue, long long aCount) { return aValue * aCount; });
+  SQLite::Statement query(db, "SELECT sum(scale(value, count)) FROM bench");
+  for (auto _ : state) {
+    query.executeStep();
+    benchmark::DoNotOptimize(query.getColumn(0).getDouble());
+    query.reset();
+  }
+  state.SetItemsProcessed(state.iterations() * ROWS);
+}
+BENCHMARK(BM_NumericFunction_Wrapper);
+
+static void BM_NumericFunction_Raw(benchmark::State& state) {
+  SQLite::Database db(SQLite::MEMORY);
+  createBenchTable(db, ROWS);
+  db.createFunction("scale", 2, true, nullptr, &rawScale, nullptr, nullptr, nullptr);
+  SQLite::Statement query(db, "SELECT sum(scale(value, count)) FROM bench");
+  for (auto _ : state) {
+    query.executeStep();
+    benchmark::DoNotOptimize(query.getColumn(0).getDouble());
+    query.reset();
+  }
+  state.SetItemsProcessed(state.iterations() * ROWS);
+}
+BENCHMARK(BM_NumericFunction_Raw);
+
+// Call a text function on each row of the synthetic table
+static void BM_TextFunction_Wrapper(benchmark::State& state) {
+  SQLite::Database db(SQLite::MEMORY);
+  createBenchTable(db, ROWS);
+  db.createFunction("name_length", [](std::string_view aName) { return static_cast<int>(aName.size()); });
+  SQLite::Statement query(db, "SELECT sum(name_length(name)) FROM bench");
+  for (auto _ : state) {
+    query.executeStep();
+    benchmark::DoNotOptimize(query.getColumn(0).getInt64());
+    query.reset();
+  }
+  state.SetItemsProcessed(state.iterations() * ROWS);
+}
+BENCHMARK(BM_TextFunction_Wrapper);
+
+static void BM_TextFunction_Raw(benchmark::State& state) {
+  SQLite::Database db(SQLite::MEMORY);
+  createBenchTable(db, ROWS);
+  db.createFunction("name_length", 1, true, nullptr, &rawNameLength, nullptr, nullptr, nullptr);
+  SQLite::Statement query(db, "SELECT sum(name_length(name)) FROM bench");
+  for (auto _ : state) {
+    query.executeStep();
+    benchmark::DoNotOptimize(query.getColumn(0).getInt64());
+    query.reset();
+  }
+  state.SetItemsProcessed(state.iterations() * ROWS);
+}
+BENCHMARK(BM_TextFunction_Raw);
@@ -0,0 +1,84 @@
+/**
+ * @file    Import_bench.cpp
+ * @ingroup benchmarks
+ * @brief   Benchmark of the CSV importer against a getline() parser with a Statement::bind() loop.
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <benchmark/benchmark.h>
+#include <SQLiteCpp/Import.h>
+#include "Bench.h"
+
+static const char* const IMPORT_FILE = "bench_import.csv";
+static const int IMPORT_ROWS = 200000;
+
+// CSV file of the rows of the bench table, with a header and some quoted fields
+static void writeImportFile() {
+  std::ofstream file(IMPORT_FILE, std::ios::binary);
+  file << "id,name,value,count\n";
+  for (int i = 0; i < IMPORT_ROWS; ++i) {
+    if (i % 10 == 0)
+      file << i << ",\"name, " << i << "\"," << i * 0.5 << ',' << i % 100 << '\n';
+    else
+      file << i << ",name " << i << ',' << i * 0.5 << ',' << i % 100 << '\n';
+  }
+}
+
+// importCsv() of the file, parsed by range(0) threads
+static void BM_Import_Csv(benchmark::State& state) {
+  writeImportFile();
+  SQLite::CsvOptions options;
+  options.parserThreads = static_cast<unsigned>(state.range(0));
+  for (auto _ : state) {
+    SQLite::Database db(":memory:", SQLite::OPEN_READWRITE);
+    createBenchTable(db, 0);
+    const SQLite::ImportResult result = SQLite::importCsv(db, "bench", IMPORT_FILE, options);
+    benchmark::DoNotOptimize(result.rows);
+  }
+  std::remove(IMPORT_FILE);
+  state.SetItemsProcessed(state.iterations() * IMPORT_ROWS);
+}
+BENCHMARK(BM_Import_Csv)->Arg(1)->Arg(2)->Arg(4)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Line by line parsing into strings bound by copy, in a single transaction (only handles the quotes of the name)
+static void BM_Import_BindLoop(benchmark::State& state) {
+  writeImportFile();
+  for (auto _ : state) {
+    SQLite::Database db(":memory:", SQLite::OPEN_READWRITE);
+    createBenchTable(db, 0);
+    SQLite::Statement insert(db, "INSERT INTO bench (id, name, value, count) VALUES (?, ?, ?, ?)");
+    SQLite::Transaction transaction(db);
+    std::ifstream file(IMPORT_FILE, std::ios::binary);
+    std::string line;
+    std::getline(file, line);
+    while (std::getline(file, line)) {
+      std::istringstream fields(line);
+      std::string id, name, value, count;
+      std::getline(fields, id, ',');
+      if (fields.peek() == '"') {
+        fields.get();
+        std::getline(fields, name, '"');
+        fields.get();
+      } else {
+        std::getline(fields, name, ',');
+      }
+      std::getline(fields, value, ',');
+      std::getline(fields, count);
+      insert.bind(1, id);
+      insert.bind(2, name);
+      insert.bind(3, value);
+      insert.bind(4, count);
+      insert.exec();
+      insert.reset();
+    }
+    transaction.commit();
+  }
+  std::remove(IMPORT_FILE);
+  state.SetItemsProcessed(state.iterations() * IMPORT_ROWS);
+}
+BENCHMARK(BM_Import_BindLoop)->Unit(benchmark::kMillisecond)->UseRealTime();
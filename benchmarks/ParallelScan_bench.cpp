@@ -0,0 +1,63 @@
+/**
+ * @file    ParallelScan_bench.cpp
+ * @ingroup benchmarks
+ * @brief   Benchmark of a table aggregated by rowid-range partitions on 1 to 8 reader threads,
+ *          against the same aggregate run by a single connection.
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#include <benchmark/benchmark.h>
+#include "Bench.h"
+#include <SQLiteCpp/RoutingDatabase.h>
+
+#include <cstdio>
+
+static const int SCAN_ROWS = 500000;
+static const unsigned SCAN_READERS = 8;
+static const char* const SCAN_FILENAME = "bench_parallel_scan.db3";
+
+// The WAL database file scanned by the benchmarks, created by the first one
+static void createScanDatabase() {
+  static bool bCreated = false;
+  if (!bCreated) {
+    std::remove(SCAN_FILENAME);
+    std::remove((std::string(SCAN_FILENAME) + "-wal").c_str());
+    std::remove((std::string(SCAN_FILENAME) + "-shm").c_str());
+    SQLite::Database db(SCAN_FILENAME, SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE);
+    db.exec("PRAGMA journal_mode = WAL");
+    createBenchTable(db, SCAN_ROWS);
+    bCreated = true;
+  }
+}
+
+// Sum of a column split into state.range(0) partitions, each one read by its own reader and thread
+static void BM_ParallelScan(benchmark::State& state) {
+  createScanDatabase();
+  SQLite::RoutingDatabase db(SCAN_FILENAME, SCAN_READERS, SQLite::OPEN_READWRITE, 1000);
+  const unsigned partitions = static_cast<unsigned>(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(db.parallelScan("bench", "value", 0.0,
+        [](double& aPartial, SQLite::Statement& aRow) { aPartial += aRow.getColumn(0).getDouble(); },
+        [](double aLeft, double aRight) { return aLeft + aRight; },
+        partitions));
+  }
+  state.SetItemsProcessed(state.iterations() * SCAN_ROWS);
+}
+BENCHMARK(BM_ParallelScan)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Same sum stepped through by a single connection
+static void BM_ParallelScan_SingleConnection(benchmark::State& state) {
+  createScanDatabase();
+  SQLite::Database db(SCAN_FILENAME, SQLite::OPEN_READONLY);
+  SQLite::Statement query(db, "SELECT value FROM bench");
+  for (auto _ : state) {
+    double total = 0.0;
+    while (query.executeStep())
+      total += query.getColumn(0).getDouble();
+    query.reset();
+    benchmark::DoNotOptimize(total);
+  }
+  state.SetItemsProcessed(state.iterations() * SCAN_ROWS);
+}
+BENCHMARK(BM_ParallelScan_SingleConnection)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,104 @@
+/**
+ * @file    Pragma_bench.cpp
+ * @ingroup benchmarks
+ * @brief   Benchmark matrix of the connection profiles on the same write, bulk load and read workloads.
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#include <cstdio>
+#include <string>
+#include <benchmark/benchmark.h>
+#include <SQLiteCpp/Pragma.h>
+#include "Bench.h"
+
+static const char* const PROFILE_FILE = "bench_profile.db3";
+static const char* const PROFILE_NAMES[] = {"Default", "ReadHeavy", "WriteHeavy", "BulkLoad", "InMemoryEphemeral"};
+
+static SQLite::ConnectionProfile getProfile(const int aIndex) {
+  switch (aIndex) {
+  case 1:   return SQLite::ConnectionProfile::readHeavy();
+  case 2:   return SQLite::ConnectionProfile::writeHeavy();
+  case 3:   return SQLite::ConnectionProfile::bulkLoad();
+  case 4:   return SQLite::ConnectionProfile::inMemoryEphemeral();
+  default:  return SQLite::ConnectionProfile();
+  }
+}
+
+static void removeProfileFile() {
+  const std::string file = PROFILE_FILE;
+  std::remove(file.c_str());
+  std::remove((file + "-wal").c_str());
+  std::remove((file + "-shm").c_str());
+  std::remove((file + "-journal").c_str());
+}
+
+// Small write transactions: one INSERT per transaction, on a new database file
+static void BM_Profile_Write(benchmark::State& state) {
+  const int profile = static_cast<int>(state.range(0));
+  state.SetLabel(PROFILE_NAMES[profile]);
+  removeProfileFile();
+  {
+    SQLite::Database db(PROFILE_FILE, SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE, getProfile(profile));
+    createBenchTable(db, 0);
+    SQLite::Statement insert(db, "INSERT INTO bench (name, value, count) VALUES (?, ?, ?)");
+    int i = 0;
+    for (auto _ : state) {
+      SQLite::Transaction transaction(db);
+      insert.bind(1, "some name");
+      insert.bind(2, i * 0.5);
+      insert.bind(3, i++ % 100);
+      insert.exec();
+      insert.reset();
+      transaction.commit();
+    }
+  }
+  removeProfileFile();
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Profile_Write)->DenseRange(0, 4)->UseRealTime();
+
+// Bulk load of 100000 rows in a single transaction, on a new database file
+static void BM_Profile_BulkLoad(benchmark::State& state) {
+  const int profile = static_cast<int>(state.range(0));
+  state.SetLabel(PROFILE_NAMES[profile]);
+  for (auto _ : state) {
+    state.PauseTiming();
+    removeProfileFile();
+    state.ResumeTiming();
+    SQLite::Database db(PROFILE_FILE, SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE, getProfile(profile));
+    createBenchTable(db, 100000);
+  }
+  removeProfileFile();
+  state.SetItemsProcessed(state.iterations() * 100000);
+}
+BENCHMARK(BM_Profile_BulkLoad)->DenseRange(0, 4)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// Point lookups and a sorted range scan on a database file of 100000 rows
+static void BM_Profile_Read(benchmark::State& state) {
+  const int profile = static_cast<int>(state.range(0));
+  state.SetLabel(PROFILE_NAMES[profile]);
+  removeProfileFile();
+  {
+    SQLite::Database db(PROFILE_FILE, SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE, getProfile(profile));
+    createBenchTable(db, 100000);
+    SQLite::Statement lookup(db, "SELECT name, value FROM bench WHERE id = ?");
+    SQLite::Statement scan(db, "SELECT id FROM bench WHERE count = ? ORDER BY value DESC LIMIT 100");
+    int i = 0;
+    for (auto _ : state) {
+      for (int j = 0; j < 100; ++j) {
+        lookup.bind(1, 1 + (i++ * 7919) % 100000);
+        lookup.executeStep();
+        benchmark::DoNotOptimize(lookup.getColumn(1).getDouble());
+        lookup.reset();
+      }
+      scan.bind(1, i % 100);
+      while (scan.executeStep())
+        benchmark::DoNotOptimize(scan.getColumn(0).getInt());
+      scan.reset();
+    }
+  }
+  removeProfileFile();
+  state.SetItemsProcessed(state.iterations() * 101);
+}
+BENCHMARK(BM_Profile_Read)->DenseRange(0, 4)->UseRealTime();
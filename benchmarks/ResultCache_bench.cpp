@@ -0,0 +1,46 @@
+/**
+ * @file    ResultCache_bench.cpp
+ * @ingroup benchmarks
+ * @brief   Benchmark of a repeated dashboard query answered by the result cache, against executing it each time.
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#include <benchmark/benchmark.h>
+#include "Bench.h"
+
+static const int CACHE_ROWS = 100000;
+static const char* const CACHE_QUERY = "SELECT count, count(*), total(value) FROM bench WHERE count < ? GROUP BY count";
+
+// Same query and parameter each time: answered from the cache after the first execution
+static void BM_ResultCache_Hit(benchmark::State& state) {
+  SQLite::Database db(":memory:", SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE);
+  createBenchTable(db, CACHE_ROWS);
+  db.setResultCache(16 * 1024 * 1024);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(db.queryCached(CACHE_QUERY, 10)->getRowCount());
+}
+BENCHMARK(BM_ResultCache_Hit);
+
+// Same query without the cache: executed each time
+static void BM_ResultCache_Disabled(benchmark::State& state) {
+  SQLite::Database db(":memory:", SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE);
+  createBenchTable(db, CACHE_ROWS);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(db.queryCached(CACHE_QUERY, 10)->getRowCount());
+}
+BENCHMARK(BM_ResultCache_Disabled)->Unit(benchmark::kMicrosecond);
+
+// A write to the table between each query: invalidated, then executed again
+static void BM_ResultCache_Invalidated(benchmark::State& state) {
+  SQLite::Database db(":memory:", SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE);
+  createBenchTable(db, CACHE_ROWS);
+  db.setResultCache(16 * 1024 * 1024);
+  SQLite::Statement update(db, "UPDATE bench SET value = value + 1 WHERE id = 1");
+  for (auto _ : state) {
+    update.exec();
+    update.reset();
+    benchmark::DoNotOptimize(db.queryCached(CACHE_QUERY, 10)->getRowCount());
+  }
+}
+BENCHMARK(BM_ResultCache_Invalidated)->Unit(benchmark::kMicrosecond);
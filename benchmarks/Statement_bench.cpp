@@ -0,0 +1,319 @@
+/**
+ * @file    Statement_bench.cpp
+ * @ingroup benchmarks
+ * @brief   Benchmarks of Statement bind(), executeStep() and getColumn() against the raw sqlite3 C API.
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#include <sqlite3.h>
+#include <string>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include <SQLiteCpp/Column.h>
+#include <SQLiteCpp/Fields.h>
+#include "Bench.h"
+
+// Point lookup of a track by its primary key on the chinook database
+static void BM_PointLookup_Wrapper(benchmark::State& state) {
+  SQLite::Database db(SQLITECPP_BENCH_CHINOOK, SQLite::OPEN_READONLY);
+  SQLite::Statement query(db, "SELECT Name, Milliseconds FROM tracks WHERE TrackId = ?");
+  int id = 0;
+  for (auto _ : state) {
+    query.bind(1, 1 + (id++ % CHINOOK_TRACKS));
+    query.executeStep();
+    benchmark::DoNotOptimize(query.getColumn(0).getText());
+    benchmark::DoNotOptimize(query.getColumn(1).getInt());
+    query.reset();
+  }
+}
+BENCHMARK(BM_PointLookup_Wrapper);
+
+static void BM_PointLookup_Raw(benchmark::State& state) {
+  SQLite::Database db(SQLITECPP_BENCH_CHINOOK, SQLite::OPEN_READONLY);
+  sqlite3_stmt* stmt = nullptr;
+  sqlite3_prepare_v2(db.getHandle(), "SELECT Name, Milliseconds FROM tracks WHERE TrackId = ?", -1, &stmt, nullptr);
+  int id = 0;
+  for (auto _ : state) {
+    sqlite3_bind_int(stmt, 1, 1 + (id++ % CHINOOK_TRACKS));
+    sqlite3_step(stmt);
+    benchmark::DoNotOptimize(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0)));
+    benchmark::DoNotOptimize(sqlite3_column_int(stmt, 1));
+    sqlite3_reset(stmt);
+  }
+  sqlite3_finalize(stmt);
+}
+BENCHMARK(BM_PointLookup_Raw);
+
+// Range scan of state.range(0) tracks on the chinook database
+static void BM_RangeScan_Wrapper(benchmark::State& state) {
+  SQLite::Database db(SQLITECPP_BENCH_CHINOOK, SQLite::OPEN_READONLY);
+  SQLite::Statement query(db, "SELECT Name, Milliseconds, UnitPrice FROM tracks WHERE TrackId BETWEEN ? AND ?");
+  const int count = static_cast<int>(state.range(0));
+  for (auto _ : state) {
+    query.bind(1, 1);
+    query.bind(2, count);
+    while (query.executeStep()) {
+      benchmark::DoNotOptimize(query.getColumn(0).getText());
+      benchmark::DoNotOptimize(query.getColumn(1).getInt());
+      benchmark::DoNotOptimize(query.getColumn(2).getDouble());
+    }
+    query.reset();
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_RangeScan_Wrapper)->Arg(10)->Arg(100)->Arg(CHINOOK_TRACKS);
+
+static void BM_RangeScan_Raw(benchmark::State& state) {
+  SQLite::Database db(SQLITECPP_BENCH_CHINOOK, SQLite::OPEN_READONLY);
+  sqlite3_stmt* stmt = nullptr;
+  sqlite3_prepare_v2(db.getHandle(), "SELECT Name, Milliseconds, UnitPrice FROM tracks WHERE TrackId BETWEEN ? AND ?",
+                     -1, &stmt, nullptr);
+  const int count = static_cast<int>(state.range(0));
+  for (auto _ : state) {
+    sqlite3_bind_int(stmt, 1, 1);
+    sqlite3_bind_int(stmt, 2, count);
+    while (SQLITE_ROW == sqlite3_step(stmt)) {
+      benchmark::DoNotOptimize(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0)));
+      benchmark::DoNotOptimize(sqlite3_column_int(stmt, 1));
+      benchmark::DoNotOptimize(sqlite3_column_double(stmt, 2));
+    }
+    sqlite3_reset(stmt);
+  }
+  sqlite3_finalize(stmt);
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_RangeScan_Raw)->Arg(10)->Arg(100)->Arg(CHINOOK_TRACKS);
+
+// Bind the 4 parameters of an INSERT statement, by index and by name
+static void BM_BindIndexed_Wrapper(benchmark::State& state) {
+  SQLite::Database db(SQLite::MEMORY);
+  createBenchTable(db, 0);
+  SQLite::Statement insert(db, "INSERT INTO bench VALUES (:id, :name, :value, :count)");
+  const std::string name = "some name";
+  for (auto _ : state) {
+    insert.bind(1, 42);
+    insert.bind(2, name);
+    insert.bind(3, 0.5);
+    insert.bind(4, 7);
+  }
+}
+BENCHMARK(BM_BindIndexed_Wrapper);
+
+static void BM_BindNamed_Wrapper(benchmark::State& state) {
+  SQLite::Database db(SQLite::MEMORY);
+  createBenchTable(db, 0);
+  SQLite::Statement insert(db, "INSERT INTO bench VALUES (:id, :name, :value, :count)");
+  const std::string name = "some name";
+  for (auto _ : state) {
+    insert.bind(":id", 42);
+    insert.bind(":name", name);
+    insert.bind(":value", 0.5);
+    insert.bind(":count", 7);
+  }
+}
+BENCHMARK(BM_BindNamed_Wrapper);
+
+static void BM_BindIndexed_Raw(benchmark::State& state) {
+  SQLite::Database db(SQLite::MEMORY);
+  createBenchTable(db, 0);
+  sqlite3_stmt* stmt = nullptr;
+  sqlite3_prepare_v2(db.getHandle(), "INSERT INTO bench VALUES (:id, :name, :value, :count)", -1, &stmt, nullptr);
+  const std::string name = "some name";
+  for (auto _ : state) {
+    sqlite3_bind_int(stmt, 1, 42);
+    sqlite3_bind_text(stmt, 2, name.c_str(), static_cast<int>(name.size()), SQLITE_TRANSIENT);
+    sqlite3_bind_double(stmt, 3, 0.5);
+    sqlite3_bind_int(stmt, 4, 7);
+  }
+  sqlite3_finalize(stmt);
+}
+BENCHMARK(BM_BindIndexed_Raw);
+
+static void BM_BindNamed_Raw(benchmark::State& state) {
+  SQLite::Database db(SQLite::MEMORY);
+  createBenchTable(db, 0);
+  sqlite3_stmt* stmt = nullptr;
+  sqlite3_prepare_v2(db.getHandle(), "INSERT INTO bench VALUES (:id, :name, :value, :count)", -1, &stmt, nullptr);
+  const std::string name = "some name";
+  for (auto _ : state) {
+    sqlite3_bind_int(stmt, sqlite3_bind_parameter_index(stmt, ":id"), 42);
+    sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, ":name"), name.c_str(),
+                      static_cast<int>(name.size()), SQLITE_TRANSIENT);
+    sqlite3_bind_double(stmt, sqlite3_bind_parameter_index(stmt, ":value"), 0.5);
+    sqlite3_bind_int(stmt, sqlite3_bind_parameter_index(stmt, ":count"), 7);
+  }
+  sqlite3_finalize(stmt);
+}
+BENCHMARK(BM_BindNamed_Raw);
+
+// Access the 4 columns of each row of the synthetic table, by index and by name
+static void BM_ColumnByIndex_Wrapper(benchmark::State& state) {
+  SQLite::Database db(SQLite::MEMORY);
+  createBenchTable(db, 1000);
+  SQLite::Statement query(db, "SELECT id, name, value, count FROM bench");
+  for (auto _ : state) {
+    while (query.executeStep()) {
+      benchmark::DoNotOptimize(query.getColumn(0).getInt64());
+      benchmark::DoNotOptimize(query.getColumn(1).getText());
+      benchmark::DoNotOptimize(query.getColumn(2).getDouble());
+      benchmark::DoNotOptimize(query.getColumn(3).getInt());
+    }
+    query.reset();
+  }
+  state.SetItemsProcessed(state.iterations() * 1000);
+}
+BENCHMARK(BM_ColumnByIndex_Wrapper);
+
+static void BM_ColumnByName_Wrapper(benchmark::State& state) {
+  SQLite::Database db(SQLite::MEMORY);
+  createBenchTable(db, 1000);
+  SQLite::Statement query(db, "SELECT id, name, value, count FROM bench");
+  for (auto _ : state) {
+    while (query.executeStep()) {
+      benchmark::DoNotOptimize(query.getColumn("id").getInt64());
+      benchmark::DoNotOptimize(query.getColumn("name").getText());
+      benchmark::DoNotOptimize(query.getColumn("value").getDouble());
+      benchmark::DoNotOptimize(query.getColumn("count").getInt());
+    }
+    query.reset();
+  }
+  state.SetItemsProcessed(state.iterations() * 1000);
+}
+BENCHMARK(BM_ColumnByName_Wrapper);
+
+static void BM_ColumnByIndex_Raw(benchmark::State& state) {
+  SQLite::Database db(SQLite::MEMORY);
+  createBenchTable(db, 1000);
+  sqlite3_stmt* stmt = nullptr;
+  sqlite3_prepare_v2(db.getHandle(), "SELECT id, name, value, count FROM bench", -1, &stmt, nullptr);
+  for (auto _ : state) {
+    while (SQLITE_ROW == sqlite3_step(stmt)) {
+      benchmark::DoNotOptimize(sqlite3_column_int64(stmt, 0));
+      benchmark::DoNotOptimize(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1)));
+      benchmark::DoNotOptimize(sqlite3_column_double(stmt, 2));
+      benchmark::DoNotOptimize(sqlite3_column_int(stmt, 3));
+    }
+    sqlite3_reset(stmt);
+  }
+  sqlite3_finalize(stmt);
+  state.SetItemsProcessed(state.iterations() * 1000);
+}
+BENCHMARK(BM_ColumnByIndex_Raw);
+
+namespace {
+
+struct BenchRow {
+  long long   id;
+  std::string name;
+  double      value;
+  int         count;
+};
+
+} // namespace
+
+template<>
+struct SQLite::FieldsOf<BenchRow> {
+  static constexpr auto fields = SQLite::fields(&BenchRow::id, &BenchRow::name, &BenchRow::value, &BenchRow::count);
+};
+
+// Map all the rows of the synthetic table into a vector of structs, with field descriptors and with getColumn()
+static void BM_ReadAll_Fields(benchmark::State& state) {
+  SQLite::Database db(SQLite::MEMORY);
+  createBenchTable(db, 1000);
+  SQLite::Statement query(db, "SELECT id, name, value, count FROM bench");
+  for (auto _ : state) {
+    std::vector<BenchRow> rows;
+    SQLite::readAll(query, rows, 1000);
+    query.reset();
+    benchmark::DoNotOptimize(rows.data());
+  }
+  state.SetItemsProcessed(state.iterations() * 1000);
+}
+BENCHMARK(BM_ReadAll_Fields);
+
+static void BM_ReadAll_Column(benchmark::State& state) {
+  SQLite::Database db(SQLite::MEMORY);
+  createBenchTable(db, 1000);
+  SQLite::Statement query(db, "SELECT id, name, value, count FROM bench");
+  for (auto _ : state) {
+    std::vector<BenchRow> rows;
+    rows.reserve(1000);
+    while (query.executeStep()) {
+      rows.push_back(BenchRow{query.getColumn(0).getInt64(), query.getColumn(1).getString(),
+                              query.getColumn(2).getDouble(), query.getColumn(3).getInt()});
+    }
+    query.reset();
+    benchmark::DoNotOptimize(rows.data());
+  }
+  state.SetItemsProcessed(state.iterations() * 1000);
+}
+BENCHMARK(BM_ReadAll_Column);
+
+// Select state.range(0) rows by a list of ids: one prepared IN carray(?) against a generated IN (?, ?, ...)
+static void BM_InList_Array(benchmark::State& state) {
+  SQLite::Database db(SQLite::MEMORY);
+  createBenchTable(db, 10000);
+  db.createArrayFunction();
+  std::vector<long long> ids(static_cast<size_t>(state.range(0)));
+  for (size_t i = 0; i < ids.size(); ++i)
+    ids[i] = static_cast<long long>(1 + (i * 7) % 10000);
+  SQLite::Statement query(db, "SELECT name FROM bench WHERE id IN carray(?)");
+  for (auto _ : state) {
+    query.bindArray(1, ids);
+    while (query.executeStep())
+      benchmark::DoNotOptimize(query.getColumn(0).getText());
+    query.reset();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_InList_Array)->Arg(10)->Arg(1000);
+
+static void BM_InList_Sql(benchmark::State& state) {
+  SQLite::Database db(SQLite::MEMORY);
+  createBenchTable(db, 10000);
+  std::vector<long long> ids(static_cast<size_t>(state.range(0)));
+  for (size_t i = 0; i < ids.size(); ++i)
+    ids[i] = static_cast<long long>(1 + (i * 7) % 10000);
+  for (auto _ : state) {
+    std::string sql = "SELECT name FROM bench WHERE id IN (?";
+    for (size_t i = 1; i < ids.size(); ++i)
+      sql += ", ?";
+    sql += ")";
+    SQLite::Statement query(db, sql);
+    for (size_t i = 0; i < ids.size(); ++i)
+      query.bind(static_cast<int>(i + 1), ids[i]);
+    while (query.executeStep())
+      benchmark::DoNotOptimize(query.getColumn(0).getText());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_InList_Sql)->Arg(10)->Arg(1000);
+
+// Failing INSERT (constraint violation) handled with exceptions
+static void BM_Error_Exception(benchmark::State& state) {
+  SQLite::Database db(SQLite::MEMORY);
+  createBenchTable(db, 1);
+  SQLite::Statement insert(db, "INSERT INTO bench VALUES (1, 'duplicate', 0.0, 0)");
+  for (auto _ : state) {
+    try {
+      insert.exec();
+    } catch (const SQLite::Exception& e) {
+      benchmark::DoNotOptimize(e.code());
+    }
+    insert.tryReset();
+  }
+}
+BENCHMARK(BM_Error_Exception);
+
+// Same failing INSERT handled with the non-throwing API
+static void BM_Error_Result(benchmark::State& state) {
+  SQLite::Database db(SQLite::MEMORY);
+  createBenchTable(db, 1);
+  SQLite::Statement insert(db, "INSERT INTO bench VALUES (1, 'duplicate', 0.0, 0)");
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(insert.tryExec().getErrorCode());
+    insert.tryReset();
+  }
+}
+BENCHMARK(BM_Error_Result);
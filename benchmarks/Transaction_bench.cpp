@@ -0,0 +1,85 @@
+/**
+ * @file    Transaction_bench.cpp
+ * @ingroup benchmarks
+ * @brief   Benchmarks of bulk inserts in a Transaction against the raw sqlite3 C API.
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#include <sqlite3.h>
+#include <benchmark/benchmark.h>
+#include "Bench.h"
+
+// Insert state.range(0) rows into the synthetic table in a single transaction
+static void BM_BulkInsert_Wrapper(benchmark::State& state) {
+  SQLite::Database db(SQLite::MEMORY);
+  const int count = static_cast<int>(state.range(0));
+  const std::string name = "some name";
+  for (auto _ : state) {
+    state.PauseTiming();
+    createBenchTable(db, 0);
+    state.ResumeTiming();
+
+    SQLite::Transaction transaction(db);
+    SQLite::Statement insert(db, "INSERT INTO bench VALUES (?, ?, ?, ?)");
+    for (int i = 1; i <= count; ++i) {
+      insert.bind(1, i);
+      insert.bind(2, name);
+      insert.bind(3, i * 0.5);
+      insert.bind(4, i % 100);
+      insert.exec();
+      insert.reset();
+    }
+    transaction.commit();
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_BulkInsert_Wrapper)->Arg(1000)->Arg(100000);
+
+static void BM_BulkInsert_Raw(benchmark::State& state) {
+  SQLite::Database db(SQLite::MEMORY);
+  sqlite3* handle = db.getHandle();
+  const int count = static_cast<int>(state.range(0));
+  const std::string name = "some name";
+  for (auto _ : state) {
+    state.PauseTiming();
+    createBenchTable(db, 0);
+    state.ResumeTiming();
+
+    sqlite3_exec(handle, "BEGIN", nullptr, nullptr, nullptr);
+    sqlite3_stmt* stmt = nullptr;
+    sqlite3_prepare_v2(handle, "INSERT INTO bench VALUES (?, ?, ?, ?)", -1, &stmt, nullptr);
+    for (int i = 1; i <= count; ++i) {
+      sqlite3_bind_int(stmt, 1, i);
+      sqlite3_bind_text(stmt, 2, name.c_str(), static_cast<int>(name.size()), SQLITE_TRANSIENT);
+      sqlite3_bind_double(stmt, 3, i * 0.5);
+      sqlite3_bind_int(stmt, 4, i % 100);
+      sqlite3_step(stmt);
+      sqlite3_reset(stmt);
+    }
+    sqlite3_finalize(stmt);
+    sqlite3_exec(handle, "COMMIT", nullptr, nullptr, nullptr);
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_BulkInsert_Raw)->Arg(1000)->Arg(100000);
+
+// Begin and commit an empty transaction
+static void BM_Transaction_Wrapper(benchmark::State& state) {
+  SQLite::Database db(SQLite::MEMORY);
+  for (auto _ : state) {
+    SQLite::Transaction transaction(db);
+    transaction.commit();
+  }
+}
+BENCHMARK(BM_Transaction_Wrapper);
+
+static void BM_Transaction_Raw(benchmark::State& state) {
+  SQLite::Database db(SQLite::MEMORY);
+  sqlite3* handle = db.getHandle();
+  for (auto _ : state) {
+    sqlite3_exec(handle, "BEGIN", nullptr, nullptr, nullptr);
+    sqlite3_exec(handle, "COMMIT", nullptr, nullptr, nullptr);
+  }
+}
+BENCHMARK(BM_Transaction_Raw);
@@ -0,0 +1,68 @@
+/**
+ * @file    Allocator.h
+ * @ingroup SQLiteCpp
+ * @brief   Process-wide SQLite memory allocator with size-class pools and per-thread caches.
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+namespace SQLite {
+
+/**
+ * @brief Counters of the pool allocator installed by configureAllocator(), accumulated since its first installation.
+ *
+ *  The counters of each thread are updated without contention, and summed by getAllocatorStats().
+ */
+struct AllocatorStats {
+  long long mallocCount   = 0;  ///< Number of allocations (xMalloc calls, and xRealloc calls needing a new block)
+  long long freeCount     = 0;  ///< Number of deallocations (xFree calls, and xRealloc calls releasing a block)
+  long long reallocCount  = 0;  ///< Number of xRealloc calls
+  long long cacheHits     = 0;  ///< Number of allocations served from the cache of the calling thread, without lock
+  long long largeCount    = 0;  ///< Number of allocations too large for a size class, served by the system malloc()
+  long long arenaBytes    = 0;  ///< Bytes reserved from the system for the size-class pools (never released)
+};
+
+/**
+ * @brief Install the pool allocator as the SQLite memory allocator, with sqlite3_config(SQLITE_CONFIG_MALLOC).
+ *
+ *  Small allocations (up to 4 KiB) are rounded up to a power of two size class and served from a free list
+ *  cached by the calling thread, refilled by batch from a shared pool carved in large arena blocks:
+ *  most allocations and deallocations neither lock nor call the system allocator.
+ *  Larger allocations (like the pages of the page cache) go to the system malloc().
+ *
+ * @note As any sqlite3_config() call, it must be called before SQLite is initialized (before opening any Database),
+ *       or after sqlite3_shutdown(). Calling it again while installed does nothing.
+ *
+ * @throw SQLite::Exception if SQLite is already initialized
+ */
+void configureAllocator();
+
+/**
+ * @brief Restore the SQLite memory allocator in place before configureAllocator().
+ *
+ * @note Same constraints as configureAllocator(): SQLite must not be initialized, so that no memory
+ *       allocated by the pools remains in use.
+ *
+ * @throw SQLite::Exception if SQLite is already initialized
+ */
+void restoreAllocator();
+
+/// true if the pool allocator is installed
+bool isAllocatorConfigured() noexcept;
+
+/// Return the counters of the pool allocator, all 0 if it was never installed
+AllocatorStats getAllocatorStats();
+
+/**
+ * @brief Limit the bytes reserved from the system for the size-class pools (see AllocatorStats::arenaBytes).
+ *
+ *  Once the limit is reached, the allocations of a size class whose pool is empty fail, as an out of memory
+ *  (SQLITE_NOMEM), instead of reserving a new arena block. The blocks already reserved are not released.
+ *
+ * @param[in] aBytes  Maximum bytes of the arenas, 0 (the default) for no limit
+ */
+void setAllocatorArenaLimit(long long aBytes) noexcept;
+
+} // SQLite
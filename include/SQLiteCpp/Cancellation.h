@@ -0,0 +1,62 @@
+/**
+ * @file    Cancellation.h
+ * @ingroup SQLiteCpp
+ * @brief   Cancellation token of the statements, and reasons of their interruption.
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+namespace SQLite {
+
+/// Reason why the last step of a Statement was interrupted (SQLITE_INTERRUPT), see Statement::getInterruption()
+enum class Interruption {
+  None,       ///< Not interrupted
+  Timeout,    ///< Its deadline passed, see Statement::setTimeout()
+  Cancelled   ///< Its CancellationToken was cancelled, or Database::interrupt() was called
+};
+
+/**
+ * @brief Thread-safe flag cancelling the statements it is given to, see Statement::setCancellationToken().
+ *
+ *  The copies of a token share the same flag: keep one copy in the thread running the query,
+ *  and call cancel() on another one from any thread, to stop the query at its next check.
+ *  A default-constructed token has no flag, and can never be cancelled.
+ */
+class CancellationToken {
+public:
+  /// Create a token that can never be cancelled
+  CancellationToken() noexcept = default;
+
+  /// Create a new token, not cancelled yet
+  static CancellationToken create() {
+    CancellationToken token;
+    token.mpCancelled = std::make_shared<std::atomic<bool>>(false);
+    return token;
+  }
+
+  /// Cancel the statements using this token (or a copy of it), from any thread
+  void cancel() noexcept {
+    if (mpCancelled)
+      mpCancelled->store(true, std::memory_order_relaxed);
+  }
+
+  /// true once cancel() was called on this token or a copy of it
+  bool isCancelled() const noexcept {
+    return mpCancelled && mpCancelled->load(std::memory_order_relaxed);
+  }
+
+  /// true if the token can be cancelled (not default-constructed)
+  explicit operator bool() const noexcept {
+    return static_cast<bool>(mpCancelled);
+  }
+
+private:
+  std::shared_ptr<std::atomic<bool>> mpCancelled; ///< Flag shared by the copies of the token
+};
+
+} // SQLite
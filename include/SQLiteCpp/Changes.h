@@ -0,0 +1,52 @@
+/**
+ * @file    Changes.h
+ * @ingroup SQLiteCpp
+ * @brief   Row-level change events of a Database connection, delivered by batch after each successful commit.
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <functional>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace SQLite {
+
+/// Kind of row change (NOTE: not upper case, as DELETE is a macro of the Windows headers)
+enum class ChangeType {
+  Insert,
+  Update,
+  Delete
+};
+
+/// Value of a column in a RowChange: NULL (std::monostate), INTEGER, REAL, TEXT or BLOB
+using ChangeValue = std::variant<std::monostate, long long, double, std::string, std::vector<unsigned char>>;
+
+/**
+ * @brief One row inserted, updated or deleted in a rowid table.
+ *
+ *  The values of the columns are only captured if requested (see Database::setChangeSink()),
+ *  with the preupdate hook of SQLite.
+ */
+struct RowChange {
+  ChangeType                type;       ///< Insert, Update or Delete
+  std::string               database;   ///< Name of the database ("main", "temp", or the name of an attached database)
+  std::string               table;      ///< Name of the table
+  long long                 rowid;      ///< rowid of the row (after the change for an Update)
+  long long                 oldRowid;   ///< rowid before the change for an Update (only differs if captured with values)
+  std::vector<ChangeValue>  oldValues;  ///< Values before an Update or a Delete, if captured
+  std::vector<ChangeValue>  newValues;  ///< Values after an Insert or an Update, if captured
+};
+
+/**
+ * @brief User callback receiving the row changes of each committed transaction, in order.
+ *
+ * @note Called after the commit, from the Statement or Database call that ended it; it may use the Database,
+ *       but not change its sink. Exceptions it throws are swallowed.
+ */
+using ChangeSink = std::function<void(const std::vector<RowChange>&)>;
+
+} // SQLite
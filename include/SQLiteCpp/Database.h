@@ -1,19 +1,25 @@
 #pragma once
 
+#include <atomic>
+#include <map>
+#include <memory>
 #include <string>
+#include <SQLiteCpp/Changes.h>
 #include <SQLiteCpp/Column.h>
+#include <SQLiteCpp/Function.h>
+#include <SQLiteCpp/MemoryGovernor.h>
+#include <SQLiteCpp/Pragma.h>
+#include <SQLiteCpp/QueryPlan.h>
+#include <SQLiteCpp/Result.h>
+#include <SQLiteCpp/ResultCache.h>
+#include <SQLiteCpp/Status.h>
+#include <SQLiteCpp/Trace.h>
 #include <SQLiteCpp/Utils.h>
+#include <SQLiteCpp/VirtualTable.h>
 
-// Forward declarations to avoid inclusion of <sqlite3.h> in a header
+// Forward declarations to avoid inclusion of <sqlite3.h> in a header (see also Function.h)
 struct sqlite3;
-struct sqlite3_context;
-
-#ifndef SQLITE_USE_LEGACY_STRUCT // Since SQLITE 3.19 (used by default since SQLiteCpp 2.1.0)
-typedef struct sqlite3_value sqlite3_value;
-#else // Before SQLite 3.19 (legacy struct forward declaration can be activated with CMake SQLITECPP_LEGACY_STRUCT var)
-struct Mem;
-typedef struct Mem sqlite3_value;
-#endif
+struct sqlite3_stmt;
 
 namespace SQLite {
 
@@ -59,6 +65,10 @@ int getLibVersionNumber() noexcept;
 class Database {
   // Give Statement constructor access to the mpSQLite Connection Handle
   friend class Statement;
+  // Give the memory governor access to the last use of the connection
+  friend struct detail::MemoryRegistry;
+  // Give Session access to the preupdate hook state of the connection
+  friend class Session;
 
 public:
   /**
@@ -85,6 +95,23 @@ public:
 
   Database(std::string const &fileName);
 
+  /**
+   * @brief Open the provided database UTF-8 filename, and apply the PRAGMAs of a connection profile.
+   *
+   * @param[in] aFilename         UTF-8 path/uri to the database file ("filename" sqlite3 parameter)
+   * @param[in] aFlags            SQLite::OPEN_READONLY/SQLite::OPEN_READWRITE/SQLite::OPEN_CREATE...
+   * @param[in] aProfile          PRAGMA values to apply, see ConnectionProfile presets
+   * @param[in] aBusyTimeoutMs    Amount of milliseconds to wait before returning SQLITE_BUSY (see setBusyTimeout())
+   * @param[in] aVfs              UTF-8 name of custom VFS to use, or empty string for sqlite3 default
+   *
+   * @throw SQLite::Exception in case of error
+   */
+  Database(const std::string&       aFilename,
+           const int                aFlags,
+           const ConnectionProfile& aProfile,
+           const int                aBusyTimeoutMs  = 0,
+           const std::string&       aVfs            = "");
+
   /**
    * @brief Close the SQLite database connection.
    *
@@ -110,6 +137,55 @@ public:
    */
   void setBusyTimeout(const int aBusyTimeoutMs);
 
+  /**
+   * @brief Apply the PRAGMA values set in a connection profile, see ConnectionProfile.
+   *
+   * @throw SQLite::Exception in case of error
+   */
+  void applyProfile(const ConnectionProfile& aProfile);
+
+  /**
+   * @brief Set the journal mode of the main database (PRAGMA journal_mode).
+   *
+   * @return The journal mode in effect, that can differ from the one requested: an in-memory database
+   *         only supports Memory and Off, and WAL needs a VFS with shared memory support.
+   *
+   * @throw SQLite::Exception in case of error
+   */
+  JournalMode setJournalMode(const JournalMode aMode);
+  /// Return the journal mode of the main database (PRAGMA journal_mode)
+  JournalMode getJournalMode() const;
+
+  /// Set the synchronization of writes to the disk (PRAGMA synchronous)
+  void setSynchronous(const Synchronous aSynchronous);
+  /// Return the synchronization of writes to the disk (PRAGMA synchronous)
+  Synchronous getSynchronous() const;
+
+  /// Set the maximum size of the page cache (PRAGMA cache_size): number of pages if positive, KiB if negative
+  void setCacheSize(const long long aCacheSize);
+  /// Return the maximum size of the page cache (PRAGMA cache_size): number of pages if positive, KiB if negative
+  long long getCacheSize() const;
+
+  /// Set the maximum number of bytes of the database file accessed with memory-mapped I/O (PRAGMA mmap_size)
+  void setMmapSize(const long long aMmapSize);
+  /// Return the maximum number of bytes of the database file accessed with memory-mapped I/O (PRAGMA mmap_size)
+  long long getMmapSize() const;
+
+  /// Set the storage of the temporary tables and indices (PRAGMA temp_store)
+  void setTempStore(const TempStore aTempStore);
+  /// Return the storage of the temporary tables and indices (PRAGMA temp_store)
+  TempStore getTempStore() const;
+
+  /// Set the page size of the database, effective only before its first table is created, or by a VACUUM (PRAGMA page_size)
+  void setPageSize(const int aPageSize);
+  /// Return the page size of the database, in bytes (PRAGMA page_size)
+  int getPageSize() const;
+
+  /// Set the number of pages of the WAL that triggers an automatic checkpoint, 0 to disable (PRAGMA wal_autocheckpoint)
+  void setWalAutoCheckpoint(const int aPages);
+  /// Return the number of pages of the WAL that triggers an automatic checkpoint (PRAGMA wal_autocheckpoint)
+  int getWalAutoCheckpoint() const;
+
   /**
    * @brief Shortcut to execute one or multiple statements without results.
    *
@@ -130,6 +206,18 @@ public:
    */
   int exec(std::string const &queries);
 
+  /**
+   * @brief Shortcut to execute one or multiple statements without results, returning the result code instead of throwing.
+   *
+   *  Same as exec(), but any error is returned as a SQLite::Result, without building an error message:
+   *  use it to retry on SQLITE_BUSY without the cost of a SQLite::Exception at each attempt.
+   *
+   * @param[in] aQueries  one or multiple UTF-8 encoded, semicolon-separate SQL statements
+   *
+   * @return number of rows modified by the *last* INSERT, UPDATE or DELETE statement on success, else the result code
+   */
+  Expected<int> tryExec(std::string const &aQueries) noexcept;
+
   /**
    * @brief Shortcut to execute a one step query and fetch the first column of the result.
    *
@@ -227,6 +315,166 @@ public:
                               void               (*apFinal)(sqlite3_context *), // NOLINT(readability/casting)
                               void               (*apDestroy)(void *));
 
+  /**
+   * @brief Create or redefine a scalar SQL function from any C++ callable (lambda, function object or function pointer).
+   *
+   *  The number and types of the arguments of the SQL function are deduced at compile time from the callable,
+   *  and each sqlite3_value argument is decoded directly into the C++ type, without copy for views:
+   *  - integral types (int, int64_t, bool...), float and double,
+   *  - std::string_view (UTF-8 text) and SQLite::Blob (bytes), valid only during the call,
+   *  - std::string (a copy of the text), std::optional<T> (std::nullopt for NULL), or the raw sqlite3_value*.
+   *
+   *  The result is set with the matching sqlite3_result_xxx() call: integral and floating point types,
+   *  text (std::string, std::string_view, const char*), SQLite::Blob, std::nullptr_t or void (NULL), std::optional<T>.
+   *  A std::exception thrown by the callable becomes a SQL error with the same message.
+   *
+   * @code{.cpp}
+   * db.createFunction("plus", [](long long a, long long b) { return a + b; });
+   * db.createFunction("upper_ascii", [](std::string_view s) {
+   *   std::string r(s);
+   *   for (char& c : r) c = static_cast<char>(std::toupper(c));
+   *   return r;
+   * });
+   * @endcode
+   *
+   * @param[in] aFuncName         Name of the SQL function to be created or redefined
+   * @param[in] aFunction         C++ callable, copied (or moved) and owned by the SQLite connection
+   * @param[in] abDeterministic   Optimize for deterministic functions (most are). A random number generator is not.
+   *
+   * @throw SQLite::Exception in case of error
+   */
+  template<typename F>
+  void createFunction(const std::string& aFuncName, F&& aFunction, bool abDeterministic = true);
+
+  /**
+   * @brief Create or redefine an aggregate SQL function from a C++ class.
+   *
+   *  The class Aggregate must be default constructible and provide:
+   *  - step(args...) called for each row, its parameters define the number and types of the SQL arguments
+   *    (same decoding as the scalar createFunction()),
+   *  - final() returning the result of the aggregate (same encoding as the scalar createFunction()).
+   *
+   *  One Aggregate object is constructed in place in the memory of sqlite3_aggregate_context() on the first row
+   *  of each group, and destroyed after final(): no other allocation is made by the wrapper.
+   *  For a group without any row, final() is called on a default constructed Aggregate.
+   *
+   * @code{.cpp}
+   * struct GeoMean {
+   *   double sumLog = 0.0;
+   *   long long count = 0;
+   *   void step(double x) { sumLog += std::log(x); ++count; }
+   *   std::optional<double> final() const { if (0 == count) return std::nullopt; return std::exp(sumLog / count); }
+   * };
+   * db.createAggregate<GeoMean>("geomean");
+   * @endcode
+   *
+   * @param[in] aFuncName         Name of the SQL aggregate function to be created or redefined
+   * @param[in] abDeterministic   Optimize for deterministic functions (most are).
+   *
+   * @throw SQLite::Exception in case of error
+   */
+  template<typename Aggregate>
+  void createAggregate(const std::string& aFuncName, bool abDeterministic = true);
+
+  /**
+   * @brief Create or redefine an aggregate window SQL function from a C++ class.
+   *
+   *  The class Window is an Aggregate (see createAggregate()) also providing:
+   *  - inverse(args...) removing a row leaving the window frame, with the same parameters as step(),
+   *  - value() returning the current result of the window, without modifying it.
+   *
+   *  The function can then be used with an OVER clause, like
+   *  "SELECT msum(value) OVER (ORDER BY id ROWS BETWEEN 2 PRECEDING AND CURRENT ROW) FROM t",
+   *  as well as a regular aggregate function.
+   *
+   * @param[in] aFuncName         Name of the SQL window function to be created or redefined
+   * @param[in] abDeterministic   Optimize for deterministic functions (most are).
+   *
+   * @throw SQLite::Exception in case of error, or if SQLite is older than 3.25.0
+   */
+  template<typename Window>
+  void createWindowFunction(const std::string& aFuncName, bool abDeterministic = true);
+
+  /**
+   * @brief Expose a random access container of structs (std::vector, std::deque...) as a read-only SQL table.
+   *
+   *  The rows of the container are read in place, without copy, by an eponymous-only virtual table
+   *  named aTableName: it can be used directly in any query, as in "SELECT ... FROM t JOIN aTableName ON ...".
+   *  Each column maps a data member of the struct (see tableColumn()), and the rowid of a row is its index.
+   *  If the container is sorted by one of the columns (see sortedKeyColumn()), equality and range constraints
+   *  on this column are resolved by a binary search.
+   *
+   * @code{.cpp}
+   * struct Price { long long id; std::string currency; double value; };
+   * std::vector<Price> prices = ...; // sorted by id
+   * db.createContainerTable("prices", prices,
+   *                         SQLite::sortedKeyColumn("id", &Price::id),
+   *                         SQLite::tableColumn("currency", &Price::currency),
+   *                         SQLite::tableColumn("value", &Price::value));
+   * SQLite::Statement query(db, "SELECT o.id, p.value FROM orders o JOIN prices p ON p.id = o.price_id");
+   * @endcode
+   *
+   * @warning The container is referenced, not copied: it must outlive the Database (or the redefinition of the table),
+   *          and must not be modified while a statement is reading the table.
+   *
+   * @param[in] aTableName    Name of the virtual table (and of its module) to be created or redefined
+   * @param[in] aContainer    Random access container of structs, providing size() and operator[]
+   * @param[in] aColumns      Columns of the table, mapped to data members of the structs
+   *
+   * @throw SQLite::Exception in case of error
+   */
+  template<typename Container, typename... Columns>
+  void createContainerTable(const std::string& aTableName, const Container& aContainer, Columns... aColumns);
+
+  /**
+   * @brief Create the table-valued function aFuncName reading an array bound with Statement::bindArray().
+   *
+   *  This replaces the generation of SQL with thousands of "?" for long IN lists:
+   *  a single prepared statement handles lists of any size, and the array is read in place, without copy.
+   *
+   * @code{.cpp}
+   * db.createArrayFunction();
+   * SQLite::Statement query(db, "SELECT name FROM tracks WHERE id IN carray(?)");
+   * const std::vector<long long> ids = {1, 5, 42};
+   * query.bindArray(1, ids);
+   * @endcode
+   *
+   * @param[in] aFuncName     Name of the table-valued function, "carray" by default
+   *
+   * @throw SQLite::Exception in case of error, or if SQLite is older than 3.20.0
+   */
+  void createArrayFunction(const std::string& aFuncName = "carray");
+
+  /**
+   * @brief Create or redefine an aggregate window SQL function in the sqlite database.
+   *
+   *  This is the equivalent of the sqlite3_create_window_function command (SQLite 3.25.0 or later).
+   * @see http://www.sqlite.org/c3ref/create_function.html
+   *
+   * @note UTF-8 text encoding assumed.
+   *
+   * @param[in] aFuncName     Name of the SQL function to be created or redefined
+   * @param[in] aNbArg        Number of arguments in the function
+   * @param[in] abDeterministic Optimize for deterministic functions (most are).
+   * @param[in] apApp         Arbitrary pointer of user data, accessible with sqlite3_user_data().
+   * @param[in] apStep        Pointer to a C-function adding a row to the window
+   * @param[in] apFinal       Pointer to a C-function returning the final result
+   * @param[in] apValue       Pointer to a C-function returning the current result of the window
+   * @param[in] apInverse     Pointer to a C-function removing a row from the window
+   * @param[in] apDestroy     If not nullptr, then it is the destructor for the application data pointer.
+   *
+   * @throw SQLite::Exception in case of error, or if SQLite is older than 3.25.0
+   */
+  void createWindowFunction(const std::string&   aFuncName,
+                            int                  aNbArg,
+                            bool                 abDeterministic,
+                            void*                apApp,
+                            void               (*apStep)(sqlite3_context *, int, sqlite3_value **),
+                            void               (*apFinal)(sqlite3_context *), // NOLINT(readability/casting)
+                            void               (*apValue)(sqlite3_context *), // NOLINT(readability/casting)
+                            void               (*apInverse)(sqlite3_context *, int, sqlite3_value **),
+                            void               (*apDestroy)(void *));
+
   /**
    * @brief Load a module into the current sqlite database instance.
    *
@@ -289,6 +537,188 @@ public:
   */
   static bool isUnencrypted(const std::string& aFilename);
 
+  /**
+   * @brief Install a sink called with the SQL text, elapsed time and row count of each statement run on this connection.
+   *
+   *  This is built on sqlite3_trace_v2() with the SQLITE_TRACE_STMT, SQLITE_TRACE_ROW and SQLITE_TRACE_PROFILE events;
+   *  the sink is called once a statement has finished running (when it is done, reset or finalized),
+   *  including statements run by exec().
+   * @see http://www.sqlite.org/c3ref/trace_v2.html
+   *
+   * @see SlowQueryLogger for a ready-made sink
+   *
+   * @param[in] aSink         Callback receiving a TraceEvent for each statement, or nullptr to stop tracing
+   * @param[in] abExpandSql   Report the SQL text with bound parameters expanded (sqlite3_expanded_sql), at some extra cost
+   *
+   * @throw SQLite::Exception in case of error
+   */
+  void setTraceSink(TraceSink aSink, bool abExpandSql = false);
+
+  /**
+   * @brief Return the runtime counters of all the live prepared statements of this connection, summed per SQL text.
+   *
+   *  Iterates over the statements with sqlite3_next_stmt(), so this includes statements
+   *  prepared outside of SQLiteCpp on the same connection handle.
+   *
+   * @see Statement::getStatus()
+   *
+   * @param[in] abReset   Reset the counters of each statement to zero after reading them
+   *
+   * @return map of summed runtime counters indexed by UTF-8 SQL text
+   */
+  std::map<std::string, StatementStatus> getStatementStatus(bool abReset = false) const;
+
+  /**
+   * @brief Return a snapshot of the page cache and memory statistics of this connection.
+   *
+   *  Use it to size the "PRAGMA cache_size" from the cache hit rate; subtract two snapshots
+   *  to get the statistics over a period of time.
+   * @see http://www.sqlite.org/c3ref/db_status.html
+   *
+   * @see SQLite::getMemoryStatus() for process-wide statistics
+   *
+   * @param[in] abReset   Reset the counters (cache hit/miss/write/spill, lookaside) after reading them
+   *
+   * @throw SQLite::Exception in case of error
+   */
+  DatabaseStatus getStatus(bool abReset = false) const;
+
+  /**
+   * @brief Opt-in debug mode checking the query plan of each Statement newly prepared on this connection.
+   *
+   *  Each new Statement is explained (see Statement::explainPlan()) right after being prepared,
+   *  and the callback is called for each full scan ("SCAN") of a table having at least aMinTableRows rows,
+   *  and for each temporary b-tree ("USE TEMP B-TREE"), typically a sort that no index can provide.
+   *  The number of rows of each scanned table is counted once with "SELECT count(*)" and then cached;
+   *  an alias named by the plan ("SCAN x") is resolved to its table from the FROM clause of the query.
+   *  A scan whose number of rows cannot be counted (subquery, view...) is always reported, with a tableRows of -1.
+   *
+   *  This does not check the queries run by exec(), and it slows down the preparation of statements:
+   *  it is meant for tests and debug builds, to catch a query falling back to a full table scan after a schema change.
+   *
+   * @param[in] aCallback       Called for each problem found, or nullptr to stop checking plans.
+   *                            Exceptions thrown by the callback propagate out of the Statement constructor.
+   * @param[in] aMinTableRows   Minimum number of rows of a table for its full scans to be reported (0 reports them all, without counting rows)
+   */
+  void setPlanCheck(QueryPlanCallback aCallback, long long aMinTableRows = 0);
+
+  /**
+   * @brief Install a sink receiving the rows changed by each transaction, in one batch after its successful commit.
+   *
+   *  This is built on sqlite3_update_hook() (or sqlite3_preupdate_hook() to capture the values),
+   *  sqlite3_commit_hook() and sqlite3_rollback_hook(): the changes are buffered during the transaction,
+   *  discarded on rollback, and delivered once the statement committing the transaction has returned
+   *  (explicit COMMIT, or a statement run outside of any transaction). If the commit fails with SQLITE_BUSY,
+   *  the transaction remains open and its changes are delivered by the commit retried.
+   *  The changes undone without ending the transaction are discarded too: the ones of a statement failing
+   *  inside the transaction (except the rows kept by the FAIL conflict resolution), and the ones rolled back
+   *  by ROLLBACK TO a savepoint; for this, exec() runs its statements one by one while capturing.
+   *
+   *  Only rowid tables are reported (not WITHOUT ROWID tables), and not the changes made by
+   *  the truncate optimization (DELETE without WHERE clause), nor by the REPLACE conflict resolution.
+   * @see http://www.sqlite.org/c3ref/update_hook.html
+   *
+   * @param[in] aSink     Callback receiving the changes of each transaction, or nullptr to stop capturing
+   * @param[in] abValues  Also capture the values of the columns before and after each change,
+   *                      requires SQLITE_ENABLE_PREUPDATE_HOOK (see hasPreupdateHook())
+   *
+   * @throw SQLite::Exception if abValues is requested without the preupdate hook, or while a Session uses it
+   */
+  void setChangeSink(ChangeSink aSink, bool abValues = false);
+
+  /// true if SQLiteCpp was built with SQLITE_ENABLE_PREUPDATE_HOOK, to capture the values of the changes
+  static bool hasPreupdateHook() noexcept;
+
+  /**
+   * @brief Interrupt the statements running on this connection, as soon as possible (sqlite3_interrupt()).
+   *
+   *  Thread-safe: it is meant to be called from another thread than the one running the statements.
+   *  They fail with SQLITE_INTERRUPT, thrown as a SQLite::CancelledException (by Statement and exec()); an interrupted write
+   *  rolls back its transaction. The statements started after all of them have returned are not affected.
+   */
+  void interrupt() noexcept;
+
+  /**
+   * @brief Set the number of virtual machine instructions run between two checks of the deadline
+   *        and cancellation token of a Statement (1000 by default), see Statement::setTimeout().
+   *
+   *  Lower values stop a statement sooner after its deadline, at the cost of more checks.
+   */
+  void setCancellationCheckInterval(const int aInstructions) noexcept {
+    mCancellationCheckInterval = (aInstructions > 0) ? aInstructions : 1;
+  }
+
+  /**
+   * @brief Make the Statements blocked by a table lock of a shared cache wait for it, instead of failing.
+   *
+   *  With a shared cache (see MemoryDatabasePool), a Statement needing a table locked by the transaction
+   *  of another connection fails with SQLITE_LOCKED_SHAREDCACHE. Once enabled, its preparation or its first step
+   *  blocks instead until that transaction ends (sqlite3_unlock_notify()), and is retried.
+   *  A wait that would deadlock fails immediately with SQLITE_LOCKED. Database::exec() does not wait.
+   * @see http://www.sqlite.org/unlock_notify.html
+   *
+   * @throw SQLite::Exception if enabled without SQLITE_ENABLE_UNLOCK_NOTIFY (see hasUnlockNotify())
+   */
+  void setWaitForUnlock(const bool abWait);
+
+  /// true if the Statements wait for the table locks of a shared cache, see setWaitForUnlock()
+  bool getWaitForUnlock() const noexcept {
+    return mbWaitForUnlock;
+  }
+
+  /// true if SQLiteCpp was built with SQLITE_ENABLE_UNLOCK_NOTIFY, to wait for the table locks of a shared cache
+  static bool hasUnlockNotify() noexcept;
+
+  /**
+   * @brief Enable the cache of the results of queryCached(), within a memory budget, or disable and empty it (0).
+   *
+   *  The tables read by each cached query are recorded when it is prepared (by the authorizer callback),
+   *  and its results are dropped as soon as one of them is modified on this connection (by the update hook),
+   *  or when a transaction is rolled back. Once over the budget, the least recently used results are evicted.
+   *
+   *  Changes not reported by the update hook are not detected: changes made by other connections,
+   *  and changes to WITHOUT ROWID and virtual tables. Schema changes empty the cache.
+   *  Only deterministic queries shall be cached (no random(), date('now')...).
+   *
+   * @param[in] aMaxBytes Approximate memory budget of the cached results, 0 to disable the cache
+   *
+   * @note Installs an authorizer, which disables the truncate optimization of "DELETE FROM table"
+   *       (the rows are deleted one by one, to be reported to the update hook).
+   */
+  void setResultCache(const std::size_t aMaxBytes);
+
+  /**
+   * @brief Run a read-only query with the values aArgs bound to its parameters, or return its cached results.
+   *
+   *  The key of the cache is the SQL text and the bound values (integers, reals, strings, blobs or nullptr),
+   *  compared exactly. Without the cache (see setResultCache()), or for a statement that is not read-only,
+   *  the query is just executed, like a Statement: its changes are reported to the change sink (see setChangeSink()).
+   *
+   * @code{.cpp}
+   * db.setResultCache(16 * 1024 * 1024);
+   * const auto rows = db.queryCached("SELECT kind, count(*) FROM events WHERE day = ? GROUP BY kind", day);
+   * for (std::size_t row = 0; row < rows->getRowCount(); ++row)
+   *   std::cout << rows->getText(row, 0) << ": " << rows->getInt64(row, 1) << "\n";
+   * @endcode
+   *
+   * @return all the rows of the query, immutable and shared with the cache
+   *
+   * @throw SQLite::Exception in case of error
+   */
+  template<typename... Args>
+  std::shared_ptr<const ResultSet> queryCached(const std::string& aQuery, const Args&... aArgs) {
+    return queryCached(aQuery, std::vector<ChangeValue>{detail::toCacheValue(aArgs)...});
+  }
+
+  /// Run a read-only query with the values bound to its parameters, or return its cached results, see above
+  std::shared_ptr<const ResultSet> queryCached(const std::string& aQuery, const std::vector<ChangeValue>& aValues);
+
+  /// Drop all the cached results (after changes not detected by the cache, for instance)
+  void clearResultCache() noexcept;
+
+  /// Return the counters of the result cache (all 0 if it is disabled)
+  ResultCacheStats getResultCacheStats() const noexcept;
+
 private:
   /// @{ Database must be non-copyable
   Database(Database const &db);
@@ -301,12 +731,108 @@ private:
   inline void check(const int aRet) const
   {
       if (SQLite::OK != aRet)
-          throw SQLite::Exception(mpSQLite);
+          throwError(aRet);
   }
 
+  /// Throw the last error of the connection: a SQLite::CancelledException for SQLITE_INTERRUPT, else a SQLite::Exception
+  [[noreturn]] void throwError(int aRet) const;
+
   int open(std::string const &fileName, int const flags, int const busyTimeoutMs, std::string const &vfs);
 
-  sqlite3*    mpSQLite;   ///< Pointer to a SQLite database connection handle
-  std::string mFilename;  ///< UTF-8 file name used to open the database
+  /// Return the first column of the first row returned by the PRAGMA apQuery
+  std::string queryPragma(const char* apQuery) const;
+
+  /// Return the first column of the first row returned by the PRAGMA apQuery, as an integer
+  long long queryPragmaInt64(const char* apQuery) const;
+
+  /// State of the sqlite3_trace_v2() callback (defined in the cpp)
+  struct Tracer;
+  /// State of the query plan check debug mode (defined in the cpp)
+  struct PlanChecker;
+
+  /// Check the query plan of a newly prepared statement, see setPlanCheck()
+  void checkPlan(const Statement& aStatement);
+
+  /// State of the change capture hooks (defined in the cpp)
+  struct ChangeCapture;
+
+  /// State of the result cache (defined in the cpp)
+  struct ResultCache;
+
+  /// (Un)register the update, preupdate, commit and rollback hooks shared by the change capture and the result cache
+  void installHooks() noexcept;
+
+  /// Deliver the buffered changes if the last statement committed a transaction, see setChangeSink()
+  void deliverChanges() noexcept;
+
+  /// Return the number of buffered changes before a statement starts, see onCapturedStatement()
+  std::size_t getChangesMark() const noexcept;
+
+  /// Discard the changes undone by a failed statement (back to aMark) or by a ROLLBACK TO, and track the savepoints
+  void onCapturedStatement(sqlite3_stmt* apStmt, int aRet, std::size_t aMark) noexcept;
+
+  /// Run SQL statements like sqlite3_exec(), one by one while capturing changes, and call onStatementEnd() after each one
+  int execQueries(const char* apQueries) noexcept;
+
+  /// Called at the end of each step, reset or exec, to record the use of the connection and deliver the changes after a commit
+  inline void onStatementEnd() noexcept {
+    mLastUse.store(detail::gMemoryEpoch.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    if (mpChangeCapture)
+      deliverChanges();
+  }
+
+  sqlite3*                mpSQLite;   ///< Pointer to a SQLite database connection handle
+  std::string             mFilename;  ///< UTF-8 file name used to open the database
+  std::unique_ptr<Tracer> mpTracer;   ///< Trace sink and per-statement row counters, nullptr when not tracing
+  std::unique_ptr<PlanChecker> mpPlanChecker; ///< Query plan check callback, nullptr when not checking
+  std::unique_ptr<ChangeCapture> mpChangeCapture; ///< Change sink and changes of the current transaction, nullptr when not capturing
+  std::unique_ptr<ResultCache> mpResultCache; ///< Cached results and their tables, nullptr when disabled
+  std::atomic<unsigned long long> mLastUse{0}; ///< Epoch of the last use, to release the least recently used caches first
+  int                     mCancellationCheckInterval = 1000; ///< Instructions between two checks of the deadline of a Statement
+  bool                    mbWaitForUnlock = false; ///< Statements wait for the table locks of a shared cache, see setWaitForUnlock()
+  bool                    mbPreupdateHook = false; ///< The preupdate hook is installed by this object (to capture the values of the changes)
+  int                     mSessionCount = 0; ///< Number of Session recording this connection, with their own preupdate hook
 };
+
+// Create or redefine a scalar SQL function from any C++ callable, see declaration above for full details
+template<typename F>
+void Database::createFunction(const std::string& aFuncName, F&& aFunction, bool abDeterministic /* = true */)
+{
+  using Function = std::decay_t<F>;
+  Function* pFunction = new Function(std::forward<F>(aFunction));
+  // On error, sqlite3_create_function_v2() calls the destructor of the user data
+  createFunction(aFuncName, detail::FunctionTraits<Function>::arity, abDeterministic, pFunction,
+                 &detail::scalarFunction<Function>, nullptr, nullptr, &detail::deleteUserData<Function>);
+}
+
+// Create or redefine an aggregate SQL function from a C++ class, see declaration above for full details
+template<typename Aggregate>
+void Database::createAggregate(const std::string& aFuncName, bool abDeterministic /* = true */)
+{
+  using Traits = detail::FunctionTraits<decltype(&Aggregate::step)>;
+  createFunction(aFuncName, Traits::arity, abDeterministic, nullptr, nullptr,
+                 &detail::aggregateStep<Aggregate, false>, &detail::aggregateFinal<Aggregate>, nullptr);
+}
+
+// Create or redefine an aggregate window SQL function from a C++ class, see declaration above for full details
+template<typename Window>
+void Database::createWindowFunction(const std::string& aFuncName, bool abDeterministic /* = true */)
+{
+  using Traits = detail::FunctionTraits<decltype(&Window::step)>;
+  static_assert(Traits::arity == detail::FunctionTraits<decltype(&Window::inverse)>::arity,
+                "step() and inverse() of a window function must take the same arguments");
+  createWindowFunction(aFuncName, Traits::arity, abDeterministic, nullptr,
+                       &detail::aggregateStep<Window, false>, &detail::aggregateFinal<Window>,
+                       &detail::aggregateValue<Window>, &detail::aggregateStep<Window, true>, nullptr);
+}
+
+// Expose a random access container of structs as a read-only SQL table, see declaration above for full details
+template<typename Container, typename... Columns>
+void Database::createContainerTable(const std::string& aTableName, const Container& aContainer, Columns... aColumns)
+{
+  static_assert(sizeof...(Columns) > 0, "A container table needs at least one column");
+  auto* pSource = new detail::ContainerTable<Container, Columns...>(aContainer, std::move(aColumns)...);
+  check(detail::createContainerModule(mpSQLite, aTableName.c_str(), pSource));
+}
+
 } // SQLite
@@ -27,6 +27,14 @@ public:
    */
   explicit Exception(sqlite3* sqlite);
 
+  /**
+   * @brief Encapsulation of the error message from SQLite3, based on std::runtime_error.
+   *
+   * @param[in] message The string message describing the SQLite error
+   * @param[in] ret     The SQLite result code (primary or extended)
+   */
+  Exception(std::string const &message, int ret);
+
   inline int code() const noexcept {
     return m_code;
   }
@@ -40,4 +48,20 @@ private:
   int m_extendedCode;
 };
 
+/**
+ * @brief Error of a statement interrupted because its deadline passed (SQLITE_INTERRUPT), see Statement::setTimeout().
+ */
+class TimeoutException : public Exception {
+public:
+  explicit TimeoutException(std::string const &message);
+};
+
+/**
+ * @brief Error of a statement interrupted by its CancellationToken or by Database::interrupt() (SQLITE_INTERRUPT).
+ */
+class CancelledException : public Exception {
+public:
+  explicit CancelledException(std::string const &message);
+};
+
 } // SQLite
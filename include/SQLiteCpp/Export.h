@@ -0,0 +1,72 @@
+/**
+ * @file    Export.h
+ * @ingroup SQLiteCpp
+ * @brief   Streaming export of query results as CSV or JSON Lines.
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <SQLiteCpp/Import.h>
+
+#include <iosfwd>
+
+namespace SQLite {
+
+// Forward declaration to avoid inclusion of <SQLiteCpp/Statement.h> in a header
+class Statement;
+
+/**
+ * @brief Execute the statement until its end, and write its rows as CSV to the output stream aOutput.
+ *
+ *  The values are written straight from the column buffers of SQLite into a reusable 1 MiB buffer,
+ *  written to the output each time it is full: no string is allocated per value.
+ *  Uses the CsvOptions::delimiter and CsvOptions::quote, and writes a header of the column names
+ *  if CsvOptions::bHeader. A value is quoted only if it contains the delimiter, a quote, CR or LF;
+ *  NULL is an empty field, and a BLOB is written as is. Records end with LF.
+ *
+ * @code{.cpp}
+ * SQLite::Statement query(db, "SELECT * FROM tracks");
+ * std::ofstream file("tracks.csv", std::ios::binary);
+ * SQLite::exportCsv(query, file);
+ * @endcode
+ *
+ * @param[in] aStatement  Statement to execute, from its current position
+ * @param[in] aOutput     Output stream
+ * @param[in] aOptions    Format of the output (the batching and threading options are not used)
+ *
+ * @return Number of rows written
+ *
+ * @throw SQLite::Exception on SQLite error, or if the output stream fails
+ */
+long long exportCsv(Statement& aStatement, std::ostream& aOutput, const CsvOptions& aOptions = CsvOptions());
+
+/**
+ * @brief Same as exportCsv(Statement&, std::ostream&, const CsvOptions&), written to the file descriptor aFd.
+ *
+ * @throw SQLite::Exception on SQLite error, or if write() fails
+ */
+long long exportCsv(Statement& aStatement, int aFd, const CsvOptions& aOptions = CsvOptions());
+
+/**
+ * @brief Execute the statement until its end, and write each row as a JSON object on its own line (JSON Lines).
+ *
+ *  Same buffering as exportCsv(). The keys are the column names; INTEGER and REAL values are JSON numbers
+ *  (null for an infinite REAL), TEXT is a JSON string with the quotes, backslashes and control characters escaped,
+ *  and BLOB is a string of hexadecimal digits.
+ *
+ * @return Number of rows written
+ *
+ * @throw SQLite::Exception on SQLite error, or if the output stream fails
+ */
+long long exportJsonLines(Statement& aStatement, std::ostream& aOutput);
+
+/**
+ * @brief Same as exportJsonLines(Statement&, std::ostream&), written to the file descriptor aFd.
+ *
+ * @throw SQLite::Exception on SQLite error, or if write() fails
+ */
+long long exportJsonLines(Statement& aStatement, int aFd);
+
+} // SQLite
@@ -0,0 +1,213 @@
+/**
+ * @file    Fields.h
+ * @ingroup SQLiteCpp
+ * @brief   Row-to-struct mapping with compile-time field descriptors: bindStruct(), readStruct() and readAll().
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <SQLiteCpp/Function.h>
+#include <SQLiteCpp/Statement.h>
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace SQLite {
+
+/**
+ * @brief Field descriptors of the struct T: the list of its data members mapped, in order, to SQL values.
+ *
+ *  Specialize it for each struct to map, with a static constexpr "fields" tuple of data member pointers
+ *  (see fields()). The i-th field is bound to the parameter i+1 by bindStruct(),
+ *  and read from the column i by readStruct() and readAll().
+ *
+ *  Supported field types: integral types (including bool), float and double, std::string (TEXT),
+ *  std::vector<unsigned char> (BLOB), and std::optional of these (NULL).
+ *
+ * @code{.cpp}
+ * struct Track { long long id; std::string name; std::optional<double> duration; };
+ *
+ * template<>
+ * struct SQLite::FieldsOf<Track> {
+ *   static constexpr auto fields = SQLite::fields(&Track::id, &Track::name, &Track::duration);
+ * };
+ *
+ * SQLite::Statement insert(db, "INSERT INTO tracks (id, name, duration) VALUES (?, ?, ?)");
+ * SQLite::bindStruct(insert, track);
+ *
+ * SQLite::Statement query(db, "SELECT id, name, duration FROM tracks");
+ * std::vector<Track> tracks;
+ * SQLite::readAll(query, tracks);
+ * @endcode
+ */
+template<typename T>
+struct FieldsOf;
+
+/// Tuple of data member pointers, to define FieldsOf<T>::fields
+template<typename... Members>
+constexpr std::tuple<Members...> fields(Members... aMembers) {
+  return std::tuple<Members...>(aMembers...);
+}
+
+/// @cond
+/// implementation detail of the row-to-struct mapping.
+namespace detail {
+
+/// Direct access to the columns of the current row of a Statement, without Column objects (friend of Statement)
+class StatementReader {
+public:
+  /// Check that the statement has a row with at least aCount columns, else throw a SQLite::Exception
+  static void checkRow(const Statement& aStatement, int aCount);
+
+  static bool              isNull(const Statement& aStatement, int aIndex) noexcept;
+  static int               getType(const Statement& aStatement, int aIndex) noexcept; ///< SQLITE_INTEGER, ... SQLITE_NULL
+  static long long         getInt64(const Statement& aStatement, int aIndex) noexcept;
+  static double            getDouble(const Statement& aStatement, int aIndex) noexcept;
+  static std::string_view  getText(const Statement& aStatement, int aIndex) noexcept;
+  static Blob              getBlob(const Statement& aStatement, int aIndex) noexcept;
+};
+
+template<typename T>
+struct IsByteVector : std::false_type {};
+template<>
+struct IsByteVector<std::vector<unsigned char>> : std::true_type {};
+
+/// Read the column aIndex of the current row into the field aValue, with the sqlite3_column_xxx() call matching its type
+template<typename T>
+void readField(const Statement& aStatement, int aIndex, T& aValue) {
+  if constexpr (IsOptional<T>::value) {
+    if (StatementReader::isNull(aStatement, aIndex)) {
+      aValue.reset();
+    } else {
+      readField(aStatement, aIndex, aValue.emplace());
+    }
+  } else if constexpr (std::is_same<T, bool>::value) {
+    aValue = (0 != StatementReader::getInt64(aStatement, aIndex));
+  } else if constexpr (std::is_integral<T>::value) {
+    aValue = static_cast<T>(StatementReader::getInt64(aStatement, aIndex));
+  } else if constexpr (std::is_floating_point<T>::value) {
+    aValue = static_cast<T>(StatementReader::getDouble(aStatement, aIndex));
+  } else if constexpr (std::is_same<T, std::string>::value) {
+    const std::string_view text = StatementReader::getText(aStatement, aIndex);
+    aValue.assign(text.data(), text.size());
+  } else if constexpr (IsByteVector<T>::value) {
+    const Blob blob = StatementReader::getBlob(aStatement, aIndex);
+    aValue.assign(blob.begin(), blob.end());
+  } else {
+    static_assert(sizeof(T) == 0, "Unsupported field type");
+  }
+}
+
+/// Bind the field aValue to the parameter aIndex, with the Statement::bind() overload matching its type
+template<typename T>
+void bindField(Statement& aStatement, int aIndex, const T& aValue) {
+  if constexpr (IsOptional<T>::value) {
+    if (aValue)
+      bindField(aStatement, aIndex, *aValue);
+    else
+      aStatement.bind(aIndex);
+  } else if constexpr (std::is_same<T, bool>::value) {
+    aStatement.bind(aIndex, aValue ? 1 : 0);
+  } else if constexpr (std::is_integral<T>::value && std::is_signed<T>::value && sizeof(T) <= sizeof(int)) {
+    aStatement.bind(aIndex, static_cast<int>(aValue));
+  } else if constexpr (std::is_integral<T>::value && sizeof(T) <= sizeof(unsigned)) {
+    aStatement.bind(aIndex, static_cast<unsigned>(aValue));
+  } else if constexpr (std::is_integral<T>::value) {
+    aStatement.bind(aIndex, static_cast<long long>(aValue));
+  } else if constexpr (std::is_floating_point<T>::value) {
+    aStatement.bind(aIndex, static_cast<double>(aValue));
+  } else if constexpr (std::is_same<T, std::string>::value) {
+    aStatement.bind(aIndex, aValue);
+  } else if constexpr (IsByteVector<T>::value) {
+    aStatement.bind(aIndex, aValue.data(), static_cast<int>(aValue.size()));
+  } else {
+    static_assert(sizeof(T) == 0, "Unsupported field type");
+  }
+}
+
+template<typename T, typename Fields, std::size_t... Is>
+void readFields(const Statement& aStatement, T& aObject, const Fields& aFields, std::index_sequence<Is...>) {
+  (readField(aStatement, static_cast<int>(Is), aObject.*(std::get<Is>(aFields))), ...);
+}
+
+template<typename T, typename Fields, std::size_t... Is>
+void bindFields(Statement& aStatement, const T& aObject, const Fields& aFields, std::index_sequence<Is...>) {
+  (bindField(aStatement, static_cast<int>(Is) + 1, aObject.*(std::get<Is>(aFields))), ...);
+}
+
+template<typename T>
+constexpr std::size_t fieldCount() {
+  return std::tuple_size<std::decay_t<decltype(FieldsOf<T>::fields)>>::value;
+}
+
+} // namespace detail
+/// @endcond
+
+/**
+ * @brief Bind the fields of aObject to the parameters 1 to N of the statement, see FieldsOf<T>.
+ *
+ * @throw SQLite::Exception in case of error
+ */
+template<typename T>
+void bindStruct(Statement& aStatement, const T& aObject) {
+  detail::bindFields(aStatement, aObject, FieldsOf<T>::fields, std::make_index_sequence<detail::fieldCount<T>()>{});
+}
+
+/**
+ * @brief Read the columns 0 to N-1 of the current row of the statement into the fields of aObject, see FieldsOf<T>.
+ *
+ * @throw SQLite::Exception if there is no row, or if the row has less than N columns
+ */
+template<typename T>
+void readStruct(const Statement& aStatement, T& aObject) {
+  constexpr std::size_t count = detail::fieldCount<T>();
+  detail::StatementReader::checkRow(aStatement, static_cast<int>(count));
+  detail::readFields(aStatement, aObject, FieldsOf<T>::fields, std::make_index_sequence<count>{});
+}
+
+/**
+ * @brief Return a T read from the current row of the statement, see readStruct(const Statement&, T&).
+ */
+template<typename T>
+T readStruct(const Statement& aStatement) {
+  T object{};
+  readStruct(aStatement, object);
+  return object;
+}
+
+/**
+ * @brief Execute the statement until its end, and append each row as a T to aObjects, see FieldsOf<T>.
+ *
+ *  Each row is read in place into a new element of the vector, without any intermediate object.
+ *
+ * @param[in]  aStatement     Statement to execute, from its current position
+ * @param[out] aObjects       Vector to which the rows are appended
+ * @param[in]  aExpectedRows  Number of rows to reserve in the vector beforehand, if known
+ *
+ * @return Number of rows appended
+ *
+ * @throw SQLite::Exception in case of error
+ */
+template<typename T>
+std::size_t readAll(Statement& aStatement, std::vector<T>& aObjects, std::size_t aExpectedRows = 0) {
+  constexpr std::size_t count = detail::fieldCount<T>();
+  aObjects.reserve(aObjects.size() + aExpectedRows);
+  std::size_t rows = 0;
+  while (aStatement.executeStep()) {
+    if (0 == rows)
+      detail::StatementReader::checkRow(aStatement, static_cast<int>(count));
+    detail::readFields(aStatement, aObjects.emplace_back(), FieldsOf<T>::fields, std::make_index_sequence<count>{});
+    ++rows;
+  }
+  return rows;
+}
+
+} // SQLite
@@ -0,0 +1,275 @@
+/**
+ * @file    Function.h
+ * @ingroup SQLiteCpp
+ * @brief   Type-safe SQL scalar, aggregate and window functions from C++ callables and classes,
+ *          see Database::createFunction(), createAggregate() and createWindowFunction().
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <cstddef>
+#include <exception>
+#include <new>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <SQLiteCpp/Span.h>
+
+// Forward declarations to avoid inclusion of <sqlite3.h> in a header
+struct sqlite3_context;
+
+#ifndef SQLITE_USE_LEGACY_STRUCT // Since SQLITE 3.19 (used by default since SQLiteCpp 2.1.0)
+typedef struct sqlite3_value sqlite3_value;
+#else // Before SQLite 3.19 (legacy struct forward declaration can be activated with CMake SQLITECPP_LEGACY_STRUCT var)
+struct Mem;
+typedef struct Mem sqlite3_value;
+#endif
+
+namespace SQLite {
+
+/// View over the bytes of a BLOB argument or result of a SQL function
+using Blob = Span<const unsigned char>;
+
+/// @cond
+/// implementation detail of type-safe SQL functions.
+namespace detail {
+
+// Thin wrappers of the sqlite3_value_xxx() and sqlite3_result_xxx() functions, to avoid including <sqlite3.h>
+bool              valueIsNull(sqlite3_value* apValue) noexcept;
+long long         valueInt64(sqlite3_value* apValue) noexcept;
+double            valueDouble(sqlite3_value* apValue) noexcept;
+std::string_view  valueText(sqlite3_value* apValue) noexcept;
+Blob              valueBlob(sqlite3_value* apValue) noexcept;
+
+void  resultNull(sqlite3_context* apContext) noexcept;
+void  resultInt64(sqlite3_context* apContext, long long aValue) noexcept;
+void  resultDouble(sqlite3_context* apContext, double aValue) noexcept;
+void  resultText(sqlite3_context* apContext, std::string_view aValue) noexcept;
+void  resultBlob(sqlite3_context* apContext, Blob aValue) noexcept;
+void  resultError(sqlite3_context* apContext, const char* apMessage) noexcept;
+void  resultErrorNoMem(sqlite3_context* apContext) noexcept;
+void* userData(sqlite3_context* apContext) noexcept;
+void* aggregateContext(sqlite3_context* apContext, int aBytes) noexcept;
+
+template<typename T>
+struct IsOptional : std::false_type {};
+template<typename T>
+struct IsOptional<std::optional<T>> : std::true_type {};
+
+/// Decode a sqlite3_value directly into a C++ argument of type T (text and blob views are not copied)
+template<typename T>
+T getValue(sqlite3_value* apValue) {
+  if constexpr (IsOptional<T>::value) {
+    if (valueIsNull(apValue))
+      return std::nullopt;
+    return getValue<typename T::value_type>(apValue);
+  } else if constexpr (std::is_same<T, bool>::value) {
+    return 0 != valueInt64(apValue);
+  } else if constexpr (std::is_integral<T>::value) {
+    return static_cast<T>(valueInt64(apValue));
+  } else if constexpr (std::is_floating_point<T>::value) {
+    return static_cast<T>(valueDouble(apValue));
+  } else if constexpr (std::is_same<T, std::string_view>::value) {
+    return valueText(apValue);
+  } else if constexpr (std::is_same<T, std::string>::value) {
+    return std::string(valueText(apValue));
+  } else if constexpr (std::is_same<T, Blob>::value) {
+    return valueBlob(apValue);
+  } else if constexpr (std::is_same<T, sqlite3_value*>::value) {
+    return apValue;
+  } else {
+    static_assert(sizeof(T) == 0, "Unsupported SQL function argument type");
+  }
+}
+
+/// Set the result of a SQL function with the sqlite3_result_xxx() call matching the C++ type T
+template<typename T>
+void setResult(sqlite3_context* apContext, const T& aValue) {
+  if constexpr (IsOptional<T>::value) {
+    if (aValue)
+      setResult(apContext, *aValue);
+    else
+      resultNull(apContext);
+  } else if constexpr (std::is_same<T, std::nullptr_t>::value) {
+    resultNull(apContext);
+  } else if constexpr (std::is_same<T, const char*>::value || std::is_same<T, char*>::value) {
+    if (nullptr != aValue)
+      resultText(apContext, std::string_view(aValue));
+    else
+      resultNull(apContext);
+  } else if constexpr (std::is_integral<T>::value) {
+    resultInt64(apContext, static_cast<long long>(aValue));
+  } else if constexpr (std::is_floating_point<T>::value) {
+    resultDouble(apContext, static_cast<double>(aValue));
+  } else if constexpr (std::is_convertible<const T&, std::string_view>::value) {
+    resultText(apContext, std::string_view(aValue));
+  } else if constexpr (std::is_convertible<const T&, Blob>::value) {
+    resultBlob(apContext, Blob(aValue));
+  } else {
+    static_assert(sizeof(T) == 0, "Unsupported SQL function result type");
+  }
+}
+
+/// Deduce the result and argument types of a function pointer, a lambda or a function object
+template<typename F>
+struct FunctionTraits : FunctionTraits<decltype(&F::operator())> {};
+
+template<typename R, typename... Args>
+struct FunctionTraits<R(*)(Args...)> {
+  using Result = R;
+  using Arguments = std::tuple<std::decay_t<Args>...>;
+  static constexpr int arity = sizeof...(Args);
+};
+template<typename R, typename... Args>
+struct FunctionTraits<R(Args...)> : FunctionTraits<R(*)(Args...)> {};
+template<typename C, typename R, typename... Args>
+struct FunctionTraits<R(C::*)(Args...)> : FunctionTraits<R(*)(Args...)> {};
+template<typename C, typename R, typename... Args>
+struct FunctionTraits<R(C::*)(Args...) const> : FunctionTraits<R(*)(Args...)> {};
+template<typename R, typename... Args>
+struct FunctionTraits<R(*)(Args...) noexcept> : FunctionTraits<R(*)(Args...)> {};
+template<typename R, typename... Args>
+struct FunctionTraits<R(Args...) noexcept> : FunctionTraits<R(*)(Args...)> {};
+template<typename C, typename R, typename... Args>
+struct FunctionTraits<R(C::*)(Args...) noexcept> : FunctionTraits<R(*)(Args...)> {};
+template<typename C, typename R, typename... Args>
+struct FunctionTraits<R(C::*)(Args...) const noexcept> : FunctionTraits<R(*)(Args...)> {};
+
+/// Decode the arguments described by Traits and call the function with them
+template<typename Traits, typename F, std::size_t... Is>
+decltype(auto) callWithValues(F&& aFunction, sqlite3_value** apArgs, std::index_sequence<Is...>) {
+  (void)apArgs; // unused for functions without arguments
+  return aFunction(getValue<std::tuple_element_t<Is, typename Traits::Arguments>>(apArgs[Is])...);
+}
+
+/// Call the function and set its result, NULL for a function returning void
+template<typename F>
+void callAndSetResult(sqlite3_context* apContext, F&& aFunction) {
+  if constexpr (std::is_void<decltype(aFunction())>::value) {
+    aFunction();
+    resultNull(apContext);
+  } else {
+    setResult(apContext, aFunction());
+  }
+}
+
+/// sqlite3 C callback of a scalar SQL function: the C++ callable is the user data of the function
+template<typename F>
+void scalarFunction(sqlite3_context* apContext, int, sqlite3_value** apArgs) {
+  using Traits = FunctionTraits<F>;
+  F& function = *static_cast<F*>(userData(apContext));
+  try {
+    callAndSetResult(apContext, [&]() -> decltype(auto) {
+      return callWithValues<Traits>(function, apArgs, std::make_index_sequence<Traits::arity>{});
+    });
+  } catch (std::exception& e) {
+    resultError(apContext, e.what());
+  } catch (...) {
+    resultError(apContext, "unknown exception in SQL function");
+  }
+}
+
+/**
+ * Memory allocated by sqlite3_aggregate_context() for the state object A of an aggregate function:
+ * zero-filled by SQLite on first use, the object is constructed in place on the first step.
+ */
+template<typename A>
+struct AggregateSlot {
+  alignas(A) unsigned char storage[sizeof(A)];  ///< Storage of the state object
+  bool bConstructed;                            ///< true once the state object has been constructed
+};
+
+/// Return the state object of the aggregate function, constructing it on first call if abCreate, or nullptr
+template<typename A>
+A* getAggregate(sqlite3_context* apContext, bool abCreate) {
+  static_assert(alignof(A) <= 8, "SQLite aggregate context memory is only 8-byte aligned");
+  AggregateSlot<A>* pSlot = static_cast<AggregateSlot<A>*>(
+      aggregateContext(apContext, abCreate ? static_cast<int>(sizeof(AggregateSlot<A>)) : 0));
+  if (nullptr == pSlot)
+    return nullptr; // Out of memory, or no row stepped
+  if (!pSlot->bConstructed) {
+    if (!abCreate)
+      return nullptr;
+    new (pSlot->storage) A();
+    pSlot->bConstructed = true;
+  }
+  return std::launder(reinterpret_cast<A*>(pSlot->storage));
+}
+
+/// sqlite3 C callback of the xStep (or xInverse if abInverse) method of an aggregate or window function
+template<typename A, bool abInverse>
+void aggregateStep(sqlite3_context* apContext, int, sqlite3_value** apArgs) {
+  try {
+    A* pAggregate = getAggregate<A>(apContext, true);
+    if (nullptr == pAggregate) {
+      resultErrorNoMem(apContext);
+      return;
+    }
+    if constexpr (abInverse) {
+      using Traits = FunctionTraits<decltype(&A::inverse)>;
+      callWithValues<Traits>([pAggregate](auto&&... aArgs) { pAggregate->inverse(std::forward<decltype(aArgs)>(aArgs)...); },
+                             apArgs, std::make_index_sequence<Traits::arity>{});
+    } else {
+      using Traits = FunctionTraits<decltype(&A::step)>;
+      callWithValues<Traits>([pAggregate](auto&&... aArgs) { pAggregate->step(std::forward<decltype(aArgs)>(aArgs)...); },
+                             apArgs, std::make_index_sequence<Traits::arity>{});
+    }
+  } catch (std::exception& e) {
+    resultError(apContext, e.what());
+  } catch (...) {
+    resultError(apContext, "unknown exception in SQL aggregate function");
+  }
+}
+
+/// sqlite3 C callback of the xValue method of a window function
+template<typename A>
+void aggregateValue(sqlite3_context* apContext) {
+  try {
+    A* pAggregate = getAggregate<A>(apContext, true);
+    if (nullptr == pAggregate) {
+      resultErrorNoMem(apContext);
+      return;
+    }
+    callAndSetResult(apContext, [pAggregate]() -> decltype(auto) { return pAggregate->value(); });
+  } catch (std::exception& e) {
+    resultError(apContext, e.what());
+  } catch (...) {
+    resultError(apContext, "unknown exception in SQL window function");
+  }
+}
+
+/// sqlite3 C callback of the xFinal method of an aggregate or window function: also destroys the state object
+template<typename A>
+void aggregateFinal(sqlite3_context* apContext) {
+  A* pAggregate = getAggregate<A>(apContext, false);
+  try {
+    if (nullptr != pAggregate) {
+      callAndSetResult(apContext, [pAggregate]() -> decltype(auto) { return pAggregate->final(); });
+    } else {
+      A empty; // No row: result of a default state object
+      callAndSetResult(apContext, [&empty]() -> decltype(auto) { return empty.final(); });
+    }
+  } catch (std::exception& e) {
+    resultError(apContext, e.what());
+  } catch (...) {
+    resultError(apContext, "unknown exception in SQL aggregate function");
+  }
+  if (nullptr != pAggregate)
+    pAggregate->~A();
+}
+
+/// sqlite3 C callback destroying the C++ callable of a SQL function
+template<typename T>
+void deleteUserData(void* apUserData) {
+  delete static_cast<T*>(apUserData);
+}
+
+} // namespace detail
+/// @endcond
+
+} // SQLite
@@ -0,0 +1,95 @@
+/**
+ * @file    Import.h
+ * @ingroup SQLiteCpp
+ * @brief   Streaming bulk import of CSV and TSV files into a table.
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+
+namespace SQLite {
+
+// Forward declaration to avoid inclusion of <SQLiteCpp/Database.h> in a header
+class Database;
+
+/**
+ * @brief Format of the input, and batching of the import, see importCsv().
+ *
+ *  The format is RFC 4180 CSV: records end with LF or CRLF, fields may be enclosed in quotes,
+ *  and a quote inside a quoted field is doubled. Use delimiter '\\t' for TSV.
+ */
+struct CsvOptions {
+  char          delimiter     = ',';    ///< Field separator: ',' for CSV, '\\t' for TSV
+  char          quote         = '"';    ///< Quote enclosing fields containing delimiters, quotes or newlines
+  bool          bHeader       = true;   ///< The first record holds the column names, used to name the INSERT columns
+  bool          bCreateTable  = false;  ///< Create the table from the header if it does not exist (columns without type)
+  std::size_t   batchSize     = 50000;  ///< Number of rows inserted per transaction (0 for a single transaction)
+  unsigned      parserThreads = 1;      ///< Number of threads parsing a memory-mapped file while the caller inserts
+};
+
+/**
+ * @brief Outcome of an import, see importCsv().
+ */
+struct ImportResult {
+  long long     rows    = 0;    ///< Number of rows inserted
+  long long     batches = 0;    ///< Number of transactions committed
+  long long     bytes   = 0;    ///< Number of bytes of input parsed
+  double        seconds = 0.0;  ///< Duration of the import
+
+  /// Number of rows inserted per second
+  double getRowsPerSecond() const noexcept {
+    return (seconds > 0.0) ? static_cast<double>(rows) / seconds : 0.0;
+  }
+};
+
+/**
+ * @brief Import the CSV or TSV file aPath into the table aTable.
+ *
+ *  The file is memory-mapped, and its fields are bound without copy (SQLITE_STATIC) to a single
+ *  "INSERT INTO aTable (header) VALUES (?, ...)" statement reused for every row;
+ *  only the quoted fields containing doubled quotes are unescaped into a scratch buffer.
+ *  Rows are inserted by batches of CsvOptions::batchSize rows, each in its own transaction:
+ *  the rows of the batches already committed remain if an error occurs.
+ *
+ *  With CsvOptions::parserThreads > 1, the file is split in chunks of whole records,
+ *  parsed by that many threads while the calling thread, the single writer, inserts the parsed chunks in order.
+ *
+ *  Values are bound as TEXT, converted by the affinity of the columns (the columns of a table created
+ *  from the header have no type, so their values stay TEXT). Missing trailing fields are bound as NULL.
+ *
+ * @code{.cpp}
+ * SQLite::CsvOptions options;
+ * options.bCreateTable = true;
+ * const SQLite::ImportResult result = SQLite::importCsv(db, "tracks", "tracks.csv", options);
+ * std::cout << result.rows << " rows, " << result.getRowsPerSecond() << " rows/s\n";
+ * @endcode
+ *
+ * @param[in] aDatabase Database connection to insert into
+ * @param[in] aTable    Name of the table
+ * @param[in] aPath     Path of the file to import
+ * @param[in] aOptions  Format of the file, and batching of the import
+ *
+ * @return Number of rows and batches, and duration of the import
+ *
+ * @throw SQLite::Exception if the file cannot be read, on malformed input (unterminated quote,
+ *        text after a closing quote, or record with more fields than columns), or on SQLite error
+ */
+ImportResult importCsv(Database& aDatabase, const std::string& aTable, const std::string& aPath,
+                       const CsvOptions& aOptions = CsvOptions());
+
+/**
+ * @brief Import CSV or TSV read from the input stream aInput into the table aTable.
+ *
+ *  Same as the file variant, but the stream is read by large blocks and parsed by the calling thread:
+ *  CsvOptions::parserThreads is ignored. The fields of a block are bound without copy,
+ *  and the partial record at its end is carried over to the next block.
+ */
+ImportResult importCsv(Database& aDatabase, const std::string& aTable, std::istream& aInput,
+                       const CsvOptions& aOptions = CsvOptions());
+
+} // SQLite
@@ -0,0 +1,153 @@
+/**
+ * @file    MemoryDatabasePool.h
+ * @ingroup SQLiteCpp
+ * @brief   Named in-memory database shared by a pool of connections: one writer and concurrent readers.
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <SQLiteCpp/Database.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace SQLite {
+
+/**
+ * @brief Named in-memory database, shared by a pool of connections to read it from multiple threads.
+ *
+ *  A Database(":memory:") is private to its connection. This pool opens a named in-memory database
+ *  with a shared cache ("file:name?mode=memory&cache=shared"): one writer connection, and a fixed number
+ *  of read-only connections, leased to one thread at a time. The database lives as long as the pool.
+ *
+ *  With a shared cache, the connections lock the tables instead of the file: by default, the readers
+ *  read uncommitted data (PRAGMA read_uncommitted), so they are never blocked by the writer, nor block it.
+ *  The table locks that remain (schema changes, or readers without read_uncommitted) are waited for
+ *  with sqlite3_unlock_notify() instead of failing with SQLITE_LOCKED, see Database::setWaitForUnlock().
+ *
+ * @code{.cpp}
+ * SQLite::MemoryDatabasePool reference("reference", 4);
+ * {
+ *   auto writer = reference.acquireWriter();
+ *   writer->exec("CREATE TABLE rates (currency TEXT PRIMARY KEY, rate REAL)");
+ * }
+ * // from any thread:
+ * auto reader = reference.acquireReader();
+ * SQLite::Statement query(*reader, "SELECT rate FROM rates WHERE currency = ?");
+ * @endcode
+ *
+ *  Two pools of the same name, in the same process, share the same database.
+ */
+class MemoryDatabasePool {
+public:
+  /**
+   * @brief Connection leased from the pool to the current thread, given back on destruction.
+   *
+   *  Movable, not copyable. Any Statement on the connection shall be destroyed before giving it back.
+   */
+  class Connection {
+  public:
+    /// Empty connection (see MemoryDatabasePool::tryAcquireReader())
+    Connection() noexcept = default;
+
+    Connection(Connection&& aOther) noexcept;
+    Connection& operator=(Connection&& aOther) noexcept;
+
+    Connection(const Connection&) = delete;
+    Connection& operator=(const Connection&) = delete;
+
+    /// Give the connection back to the pool
+    ~Connection() {
+      release();
+    }
+
+    /// Give the connection back to the pool before the end of the scope
+    void release() noexcept;
+
+    /// true if a connection is leased
+    explicit operator bool() const noexcept {
+      return mpDatabase != nullptr;
+    }
+
+    Database& operator*() const noexcept {
+      return *mpDatabase;
+    }
+
+    Database* operator->() const noexcept {
+      return mpDatabase;
+    }
+
+  private:
+    friend class MemoryDatabasePool;
+
+    Connection(MemoryDatabasePool& aPool, Database& aDatabase) noexcept :
+      mpPool(&aPool),
+      mpDatabase(&aDatabase) {
+    }
+
+    MemoryDatabasePool* mpPool = nullptr;     ///< Pool owning the connection
+    Database*           mpDatabase = nullptr; ///< Connection leased, nullptr if empty
+  };
+
+  /**
+   * @brief Create (or join) the in-memory database aName, and open its writer and reader connections.
+   *
+   * @param[in] aName             Name of the database, shared by all the pools of the process using this name
+   * @param[in] aReaders          Number of read-only connections, 0 for one per core
+   * @param[in] abReadUncommitted The readers read uncommitted data instead of waiting for the writer to commit
+   *
+   * @throw SQLite::Exception if the name is empty, or if a connection cannot be opened
+   */
+  explicit MemoryDatabasePool(const std::string& aName, const unsigned aReaders = 0, const bool abReadUncommitted = true);
+
+  /// Close the connections: the database is destroyed once no other connection uses it. No Connection shall remain leased.
+  ~MemoryDatabasePool();
+
+  MemoryDatabasePool(const MemoryDatabasePool&) = delete;
+  MemoryDatabasePool& operator=(const MemoryDatabasePool&) = delete;
+
+  /// Return the name of the database
+  const std::string& getName() const noexcept {
+    return mName;
+  }
+
+  /// Return the URI of the database, to open more connections to it (with SQLite::OPEN_URI)
+  const std::string& getUri() const noexcept {
+    return mUri;
+  }
+
+  /// Return the number of read-only connections
+  std::size_t getReaderCount() const noexcept {
+    return mReaders.size();
+  }
+
+  /// Lease a read-only connection, waiting for one to be given back if all are in use
+  Connection acquireReader();
+
+  /// Lease a read-only connection if one is free, else return an empty Connection
+  Connection tryAcquireReader();
+
+  /// Lease the writer connection, waiting for it to be given back if in use
+  Connection acquireWriter();
+
+private:
+  /// Give a leased connection back, and wake up a thread waiting for it
+  void release(Database& aDatabase) noexcept;
+
+  std::string                             mName;        ///< Name of the database
+  std::string                             mUri;         ///< URI of the shared in-memory database
+  std::unique_ptr<Database>               mpWriter;     ///< Read-write connection (opened first, keeping the database alive)
+  std::vector<std::unique_ptr<Database>>  mReaders;     ///< Read-only connections
+  std::mutex                              mMutex;       ///< Guards the free connections below
+  std::condition_variable                 mReleased;    ///< Signaled when a connection is given back
+  std::vector<Database*>                  mFreeReaders; ///< Read-only connections not leased
+  bool                                    mbWriterFree = true; ///< false while the writer is leased
+};
+
+} // SQLite
@@ -0,0 +1,90 @@
+/**
+ * @file    MemoryGovernor.h
+ * @ingroup SQLiteCpp
+ * @brief   Process-wide memory budget of SQLite: heap limits, and release of the caches of the idle connections.
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+
+namespace SQLite {
+
+class Database;
+
+/**
+ * @brief Memory budget of all the SQLite connections of the process, see setMemoryBudget().
+ */
+struct MemoryBudget {
+  long long softLimit = 0;  ///< Advisory heap limit, sqlite3_soft_heap_limit64(); 0 for none
+  long long hardLimit = 0;  ///< Heap limit failing the allocations with SQLITE_NOMEM, sqlite3_hard_heap_limit64(); 0 for none
+  long long target    = 0;  ///< Memory used above which the idle connections release their caches; 0 for softLimit
+  std::chrono::milliseconds checkInterval{0}; ///< Period of the background check of the memory used; 0 for no thread
+};
+
+/**
+ * @brief Counters of the memory governor, accumulated since the process started.
+ */
+struct MemoryGovernorStats {
+  long long reclaims            = 0;  ///< Passes releasing the idle connections (memory used over the target, or forced)
+  long long connectionsReleased = 0;  ///< Calls to sqlite3_db_release_memory() on idle connections
+  long long connectionsSkipped  = 0;  ///< Connections skipped because they were in use (or without a mutex)
+  long long bytesReclaimed      = 0;  ///< Bytes of page cache released by the idle connections
+  long long memoryUsed          = 0;  ///< Memory currently used by SQLite, sqlite3_memory_used()
+  long long connections         = 0;  ///< Number of open Database connections
+};
+
+/**
+ * @brief Set the process-wide memory budget of SQLite.
+ *
+ *  Sets the soft and hard heap limits of SQLite, and the target of the governor: once sqlite3_memory_used()
+ *  exceeds it, the idle Database connections release the unused pages of their caches with
+ *  sqlite3_db_release_memory(), least recently used first, until the memory used is back under the target.
+ *  The check runs when a connection is opened, when reclaimMemory() is called, and every checkInterval
+ *  on a background thread (if not 0).
+ *
+ *  A connection is idle if none of its statements is running, and if its mutex is free:
+ *  the connections opened without a mutex (SQLITE_OPEN_NOMUTEX, or a library not in serialized mode)
+ *  cannot be released from another thread, and are skipped.
+ *
+ * @throw SQLite::Exception if the target is negative
+ */
+void setMemoryBudget(const MemoryBudget& aBudget);
+
+/// Return the current memory budget
+MemoryBudget getMemoryBudget();
+
+/**
+ * @brief Release the caches of the idle connections, least recently used first, if the memory used exceeds the target.
+ *
+ * @param[in] abForce Release the caches of all the idle connections, even under the target (or without a budget)
+ *
+ * @return number of bytes of page cache released
+ */
+long long reclaimMemory(bool abForce = false);
+
+/// Return a snapshot of the counters of the memory governor
+MemoryGovernorStats getMemoryGovernorStats();
+
+/// @cond
+namespace detail {
+
+/// Clock of the use of the connections, advanced by each check of the governor (to order them by last use)
+extern std::atomic<unsigned long long> gMemoryEpoch;
+
+/// Register an open connection to the memory governor (done by Database)
+void registerDatabase(Database& aDatabase);
+
+/// Unregister a connection before closing it (done by Database)
+void unregisterDatabase(Database& aDatabase) noexcept;
+
+/// Pass of the memory governor (friend of Database)
+struct MemoryRegistry;
+
+} // namespace detail
+/// @endcond
+
+} // SQLite
@@ -0,0 +1,91 @@
+/**
+ * @file    Pragma.h
+ * @ingroup SQLiteCpp
+ * @brief   Typed values of the performance related PRAGMAs, and connection profiles applying them at open.
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <optional>
+
+namespace SQLite {
+
+// NOTE: enumerators are not upper case, as DELETE is a macro of the Windows headers
+
+/// Journal mode of a database (PRAGMA journal_mode), see http://www.sqlite.org/pragma.html#pragma_journal_mode
+enum class JournalMode {
+  Delete,     ///< Rollback journal deleted at the end of each transaction (default)
+  Truncate,   ///< Rollback journal truncated to zero length at the end of each transaction
+  Persist,    ///< Rollback journal header overwritten with zeros at the end of each transaction
+  Memory,     ///< Rollback journal kept in memory: a crash in the middle of a transaction may corrupt the database
+  Wal,        ///< Write-Ahead Log: readers do not block the writer, and the writer does not block readers
+  Off         ///< No rollback journal: no ROLLBACK, and a crash in the middle of a transaction may corrupt the database
+};
+
+/// Synchronization of writes to the disk (PRAGMA synchronous), see http://www.sqlite.org/pragma.html#pragma_synchronous
+enum class Synchronous {
+  Off,        ///< No sync: fastest, but the database may be corrupted by a power loss or an OS crash
+  Normal,     ///< Sync at the most critical moments: safe in WAL mode, a power loss may roll back the last commits
+  Full,       ///< Sync at each commit (default)
+  Extra       ///< Full, and also sync the directory of the rollback journal
+};
+
+/// Storage of the temporary tables and indices (PRAGMA temp_store), see http://www.sqlite.org/pragma.html#pragma_temp_store
+enum class TempStore {
+  Default,    ///< As chosen at compile time by SQLITE_TEMP_STORE (usually files)
+  File,       ///< Temporary files
+  Memory      ///< Memory
+};
+
+/**
+ * @brief Set of PRAGMA values applied to a connection, at open or with Database::applyProfile().
+ *
+ *  Only the values set are applied, in an order that works for a new database:
+ *  page_size first (before any table is created), then journal_mode, then the others.
+ *  Use one of the presets, adjusted if needed:
+ *
+ * @code{.cpp}
+ * SQLite::ConnectionProfile profile = SQLite::ConnectionProfile::readHeavy();
+ * profile.mmapSize = 1024LL * 1024 * 1024;
+ * SQLite::Database db("service.db3", SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE, profile);
+ * @endcode
+ */
+struct ConnectionProfile {
+  std::optional<int>          pageSize;           ///< PRAGMA page_size, in bytes (power of two from 512 to 65536)
+  std::optional<JournalMode>  journalMode;        ///< PRAGMA journal_mode
+  std::optional<Synchronous>  synchronous;        ///< PRAGMA synchronous
+  std::optional<long long>    cacheSize;          ///< PRAGMA cache_size: number of pages if positive, KiB if negative
+  std::optional<long long>    mmapSize;           ///< PRAGMA mmap_size, maximum number of bytes of memory-mapped I/O
+  std::optional<TempStore>    tempStore;          ///< PRAGMA temp_store
+  std::optional<int>          walAutoCheckpoint;  ///< PRAGMA wal_autocheckpoint, in pages (0 to disable)
+
+  /**
+   * @brief Mostly concurrent reads: WAL, synchronous NORMAL, 64 MiB page cache, 256 MiB memory-mapped I/O,
+   *        and temporary tables in memory.
+   */
+  static ConnectionProfile readHeavy();
+
+  /**
+   * @brief Frequent small write transactions: WAL, synchronous NORMAL, 32 MiB page cache,
+   *        checkpoints every 4000 pages instead of 1000, and temporary tables in memory.
+   */
+  static ConnectionProfile writeHeavy();
+
+  /**
+   * @brief One-off bulk load of a new database: no journal, no sync, 256 MiB page cache, 64 KiB pages,
+   *        and temporary tables in memory.
+   *
+   * @warning A crash during the load may corrupt the database: the load must be restarted from scratch.
+   */
+  static ConnectionProfile bulkLoad();
+
+  /**
+   * @brief Temporary database that does not need to survive a crash (in-memory or scratch file):
+   *        journal in memory, no sync, and temporary tables in memory.
+   */
+  static ConnectionProfile inMemoryEphemeral();
+};
+
+} // SQLite
@@ -0,0 +1,63 @@
+/**
+ * @file    QueryPlan.h
+ * @ingroup SQLiteCpp
+ * @brief   Structured result of EXPLAIN QUERY PLAN, and warnings of the Database query plan check.
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace SQLite {
+
+/**
+ * @brief One node of the tree returned by EXPLAIN QUERY PLAN.
+ *
+ * @see Statement::explainPlan()
+ * @see http://www.sqlite.org/eqp.html
+ */
+struct QueryPlanNode {
+  int                         id;       ///< Identifier of the node, unique in the plan
+  int                         parent;   ///< Identifier of the parent node, 0 for a root node
+  std::string                 detail;   ///< Human readable description, like "SCAN t" or "SEARCH t USING INTEGER PRIMARY KEY (rowid=?)"
+  std::vector<QueryPlanNode>  children; ///< Child nodes, in plan order
+
+  /// true for a full scan of a table or of an index ("SCAN t", "SCAN t USING COVERING INDEX i"...)
+  bool isScan() const;
+
+  /// true for a temporary b-tree, used for a sort ("USE TEMP B-TREE FOR ORDER BY") or a DISTINCT/GROUP BY
+  bool isTempBTree() const;
+
+  /// Return the name of the table (or alias) scanned or searched by this node, or an empty string
+  std::string getTable() const;
+};
+
+/// Tree returned by EXPLAIN QUERY PLAN: the list of root nodes, in plan order.
+using QueryPlan = std::vector<QueryPlanNode>;
+
+/**
+ * @brief Potential performance problem found in the plan of a newly prepared Statement.
+ *
+ * @see Database::setPlanCheck()
+ */
+struct QueryPlanWarning {
+  enum Kind {
+    FULL_SCAN,  ///< Full scan of a table (or of an index) having at least the configured number of rows
+    TEMP_BTREE  ///< Temporary b-tree, typically a sort that no index can provide
+  };
+
+  Kind        kind;       ///< Kind of problem
+  std::string sql;        ///< UTF-8 SQL text of the statement
+  std::string detail;     ///< Detail of the query plan node
+  std::string table;      ///< Name of the table (or alias) scanned, empty for a TEMP_BTREE
+  long long   tableRows;  ///< Number of rows of the table scanned, -1 if unknown or not counted
+};
+
+/// User callback receiving the QueryPlanWarning found by the Database query plan check.
+using QueryPlanCallback = std::function<void(const QueryPlanWarning&)>;
+
+} // SQLite
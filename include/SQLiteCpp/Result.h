@@ -0,0 +1,118 @@
+/**
+ * @file    Result.h
+ * @ingroup SQLiteCpp
+ * @brief   Lightweight result codes of the non-throwing API (tryExec, tryBind, tryPrepare, tryCommit...).
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <utility>
+
+// Forward declaration to avoid inclusion of <sqlite3.h> in a header
+struct sqlite3;
+
+namespace SQLite {
+
+/**
+ * @brief Result code of a non-throwing call, with the error message only built on demand.
+ *
+ *  Unlike a SQLite::Exception, it holds only the result code and the connection:
+ *  no message is copied, and nothing is allocated. Use it in loops retrying on SQLITE_BUSY,
+ *  where exceptions would be thrown and caught at each attempt:
+ *
+ * @code{.cpp}
+ * SQLite::Result result = insert.tryExec();
+ * while (result.isBusy()) {
+ *   insert.tryReset();
+ *   result = insert.tryExec();
+ * }
+ * result.check(); // throw the SQLite::Exception on any other error
+ * @endcode
+ */
+class Result {
+public:
+  /// Result code aCode of a call on the connection apSQLite (if any), to obtain the error message from
+  explicit Result(int aCode = 0, sqlite3* apSQLite = nullptr) noexcept :
+    mCode(aCode),
+    mpSQLite(apSQLite)
+  {
+  }
+
+  /// true on success (SQLITE_OK, SQLITE_ROW or SQLITE_DONE)
+  bool isOk() const noexcept;
+
+  /// true on success, see isOk()
+  explicit operator bool() const noexcept {
+    return isOk();
+  }
+
+  /// true if the database was locked (SQLITE_BUSY or SQLITE_LOCKED): the call may succeed if retried
+  bool isBusy() const noexcept;
+
+  /// Return the SQLite result code (extended if enabled on the connection)
+  int getErrorCode() const noexcept {
+    return mCode;
+  }
+
+  /**
+   * @brief Return the error message: the one of the connection if it still reports this error,
+   *        else the generic description of the result code (sqlite3_errstr).
+   *
+   * @note The message of the connection is only valid until its next call: read it right away.
+   */
+  const char* getErrorMsg() const noexcept;
+
+  /// Throw a SQLite::Exception with the error message if not isOk()
+  void check() const {
+    if (!isOk())
+      throwException();
+  }
+
+private:
+  [[noreturn]] void throwException() const;
+
+  int       mCode;      ///< SQLite result code
+  sqlite3*  mpSQLite;   ///< Connection reporting the error message, or nullptr
+};
+
+/**
+ * @brief Result of a non-throwing call returning a value on success (like Statement::tryPrepare()).
+ *
+ *  The value is only valid if isOk(): value() throws the SQLite::Exception otherwise.
+ */
+template<typename T>
+class Expected : public Result {
+public:
+  /// Error result, without value
+  explicit Expected(const Result& aError) :
+    Result(aError),
+    mValue()
+  {
+  }
+
+  /// Successful result holding aValue
+  Expected(T&& aValue, const Result& aResult) :
+    Result(aResult),
+    mValue(std::move(aValue))
+  {
+  }
+
+  /// Return the value, or throw the SQLite::Exception of the error
+  T& value() {
+    check();
+    return mValue;
+  }
+
+  /// Return the value, or throw the SQLite::Exception of the error
+  const T& value() const {
+    check();
+    return mValue;
+  }
+
+private:
+  T mValue;
+};
+
+} // SQLite
@@ -0,0 +1,133 @@
+/**
+ * @file    ResultCache.h
+ * @ingroup SQLiteCpp
+ * @brief   Materialized query results of the result cache of a Database, see Database::queryCached().
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <SQLiteCpp/Changes.h>
+#include <SQLiteCpp/Span.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace SQLite {
+
+/**
+ * @brief All the rows of a query, read at once into a compact immutable buffer.
+ *
+ *  The values are stored in a single array of cells (16 bytes each), with the TEXT and BLOB
+ *  values concatenated in a single buffer. Shared by the result cache and its users:
+ *  it remains valid after being evicted or invalidated from the cache.
+ */
+class ResultSet {
+public:
+  /// Return the number of columns
+  int getColumnCount() const noexcept {
+    return static_cast<int>(mColumnNames.size());
+  }
+
+  /// Return the number of rows
+  std::size_t getRowCount() const noexcept {
+    return mColumnNames.empty() ? 0 : mCells.size() / mColumnNames.size();
+  }
+
+  /// Return the name of the column aColumn (in [0, getColumnCount()))
+  const std::string& getColumnName(const int aColumn) const {
+    return mColumnNames.at(static_cast<std::size_t>(aColumn));
+  }
+
+  /// Return the type of a value: SQLite::INTEGER, FLOAT, TEXT, BLOB or Null
+  int getType(const std::size_t aRow, const int aColumn) const {
+    return cell(aRow, aColumn).type;
+  }
+
+  /// true if the value is NULL
+  bool isNull(std::size_t aRow, int aColumn) const;
+
+  /// Return the value as an integer (0 for NULL, TEXT and BLOB; REAL values are truncated)
+  long long getInt64(std::size_t aRow, int aColumn) const;
+
+  /// Return the value as a real (0.0 for NULL, TEXT and BLOB)
+  double getDouble(std::size_t aRow, int aColumn) const;
+
+  /// Return a TEXT or BLOB value as a view of the buffer (empty for the other types)
+  std::string_view getText(std::size_t aRow, int aColumn) const;
+
+  /// Return a BLOB or TEXT value as a view of the buffer (empty for the other types)
+  Span<const unsigned char> getBlob(std::size_t aRow, int aColumn) const;
+
+  /// Return the approximate number of bytes of memory used, counted against the cache budget
+  std::size_t getMemoryUsed() const noexcept;
+
+private:
+  friend class Database;
+
+  /// One value: inline for INTEGER and REAL, an offset in mData for TEXT and BLOB
+  struct Cell {
+    union {
+      long long     integer;
+      double        real;
+      std::uint32_t offset;
+    };
+    std::uint32_t   size; ///< Bytes of TEXT or BLOB
+    int             type; ///< SQLITE_INTEGER, SQLITE_FLOAT, SQLITE_TEXT, SQLITE_BLOB or SQLITE_NULL
+  };
+
+  const Cell& cell(const std::size_t aRow, const int aColumn) const {
+    return mCells.at(aRow * mColumnNames.size() + static_cast<std::size_t>(aColumn));
+  }
+
+  std::vector<std::string>  mColumnNames; ///< Name of each column
+  std::vector<Cell>         mCells;       ///< Values, row by row
+  std::string               mData;        ///< TEXT and BLOB values
+};
+
+/// Counters of the result cache of a Database, see Database::getResultCacheStats()
+struct ResultCacheStats {
+  long long   hits          = 0;  ///< Queries answered from the cache
+  long long   misses        = 0;  ///< Queries executed, and their results cached if possible
+  long long   invalidations = 0;  ///< Results dropped because a table they read was modified
+  long long   evictions     = 0;  ///< Results dropped, least recently used first, to fit in the budget
+  std::size_t entries       = 0;  ///< Number of results cached
+  std::size_t bytes         = 0;  ///< Approximate memory used by the cached results
+};
+
+/// @cond
+namespace detail {
+
+/// Convert a value bound to a cached query into the value used in its key, and bound to the statement
+inline ChangeValue toCacheValue(std::nullptr_t) {
+  return std::monostate();
+}
+inline ChangeValue toCacheValue(const std::string& aValue) {
+  return aValue;
+}
+inline ChangeValue toCacheValue(std::string_view aValue) {
+  return std::string(aValue);
+}
+inline ChangeValue toCacheValue(const char* apValue) {
+  return apValue ? ChangeValue(std::string(apValue)) : ChangeValue(std::monostate());
+}
+inline ChangeValue toCacheValue(const std::vector<unsigned char>& aBlob) {
+  return aBlob;
+}
+template<typename T, typename = std::enable_if_t<std::is_arithmetic<T>::value>>
+ChangeValue toCacheValue(const T aValue) {
+  if constexpr (std::is_floating_point<T>::value)
+    return static_cast<double>(aValue);
+  else
+    return static_cast<long long>(aValue);
+}
+
+} // namespace detail
+/// @endcond
+
+} // SQLite
@@ -0,0 +1,253 @@
+/**
+ * @file    RoutingDatabase.h
+ * @ingroup SQLiteCpp
+ * @brief   Facade routing the read-only statements to a pool of reader connections, and the others to a single writer.
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <SQLiteCpp/Database.h>
+#include <SQLiteCpp/Fields.h>
+#include <SQLiteCpp/Statement.h>
+#include <SQLiteCpp/VariadicBind.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace SQLite {
+
+/// Connection on which a statement runs, see RoutingDatabase::getRoute()
+enum class Route {
+  Reader, ///< Read-only statement, run by any reader connection
+  Writer  ///< Statement modifying the database (or the state of the connection), run by the writer connection
+};
+
+/// Counters of a RoutingDatabase, see RoutingDatabase::getStats()
+struct RoutingStats {
+  long long   reads       = 0;  ///< Statements run on a reader
+  long long   writes      = 0;  ///< Statements run on the writer
+  long long   routeHits   = 0;  ///< Routes found in the cache
+  long long   routeMisses = 0;  ///< Routes decided by preparing the statement
+  std::size_t routes      = 0;  ///< Number of SQL texts in the cache
+};
+
+/**
+ * @brief Facade over one database: a writer connection and a pool of reader connections, shared by threads.
+ *
+ *  Each statement is routed to the right connection, without the caller having to decide:
+ *  the first time a SQL text is seen, it is prepared on a reader, and if sqlite3_stmt_readonly() says it
+ *  makes no change to the database, it runs there; else it is prepared and run on the writer.
+ *  The decision is cached per SQL text, so later executions go straight to their connection:
+ *  bind the values as parameters, instead of building a new SQL text for each of them.
+ *
+ *  The statements changing the state of a connection instead of the database (BEGIN, COMMIT, ROLLBACK,
+ *  SAVEPOINT, RELEASE, ATTACH, DETACH and PRAGMA) are read-only for SQLite, but are routed to the writer:
+ *  run the transactions with withWriter(), and the settings of all the connections with forEachConnection().
+ *
+ * @code{.cpp}
+ * SQLite::RoutingDatabase db("events.db3", 4);
+ * db.exec("INSERT INTO events (kind, value) VALUES (?, ?)", "click", 1.5);                  // on the writer
+ * const auto clicks = db.queryAll<Event>("SELECT id, kind, value FROM events WHERE kind = ?", "click"); // on a reader
+ * @endcode
+ *
+ *  The readers only see the committed changes of the writer: use WAL mode ("PRAGMA journal_mode = WAL",
+ *  persistent in the file) for the readers and the writer not to block each other, and a busy timeout.
+ *  A private ":memory:" database cannot be shared: use a file, or the URI of a MemoryDatabasePool
+ *  (the connections then wait for the table locks of the shared cache, see Database::setWaitForUnlock()).
+ */
+class RoutingDatabase {
+public:
+  /**
+   * @brief Open the writer connection, then the reader connections to the same database.
+   *
+   * @param[in] aFilename       UTF-8 path (or URI, with SQLite::OPEN_URI) of the database
+   * @param[in] aReaders        Number of reader connections, 0 for one per core
+   * @param[in] aFlags          Flags of the writer, see Database; the readers are opened with OPEN_READONLY instead
+   * @param[in] aBusyTimeoutMs  Busy timeout of all the connections, see Database::setBusyTimeout()
+   *
+   * @throw SQLite::Exception if a connection cannot be opened
+   */
+  explicit RoutingDatabase(const std::string& aFilename,
+                           const unsigned aReaders = 0,
+                           const int aFlags = SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE,
+                           const int aBusyTimeoutMs = 0);
+
+  /// Close the connections; no call shall be running
+  ~RoutingDatabase();
+
+  RoutingDatabase(const RoutingDatabase&) = delete;
+  RoutingDatabase& operator=(const RoutingDatabase&) = delete;
+
+  /// Return the number of reader connections
+  std::size_t getReaderCount() const noexcept {
+    return mReaders.size();
+  }
+
+  /**
+   * @brief Return the route of a SQL text, preparing it on a reader if it is not in the cache yet.
+   *
+   * @throw SQLite::Exception if the query cannot be prepared
+   */
+  Route getRoute(const std::string& aQuery);
+
+  /**
+   * @brief Prepare the query on the connection of its route, and run aTask(statement) while holding this connection.
+   *
+   *  Waits for a free reader, or for the writer. The statement shall not outlive aTask.
+   *
+   * @throw SQLite::Exception if the query cannot be prepared, or the exceptions of aTask
+   */
+  void run(const std::string& aQuery, const std::function<void(Statement& aStatement)>& aTask);
+
+  /**
+   * @brief Execute a statement without results, with aArgs bound to its parameters, on the connection of its route.
+   *
+   * @return number of rows modified by the statement
+   */
+  template<typename... Args>
+  int exec(const std::string& aQuery, const Args&... aArgs) {
+    int changes = 0;
+    run(aQuery, [&](Statement& aStatement) {
+      bindAll(aStatement, aArgs...);
+      changes = aStatement.exec();
+    });
+    return changes;
+  }
+
+  /**
+   * @brief Run a query, with aArgs bound to its parameters, on the connection of its route,
+   *        and read all its rows into structs T with the field descriptors FieldsOf<T> (see Fields.h).
+   */
+  template<typename T, typename... Args>
+  std::vector<T> queryAll(const std::string& aQuery, const Args&... aArgs) {
+    std::vector<T> rows;
+    run(aQuery, [&](Statement& aStatement) {
+      bindAll(aStatement, aArgs...);
+      readAll(aStatement, rows);
+    });
+    return rows;
+  }
+
+  /**
+   * @brief Run aTask(writer) while holding the writer connection, to run a transaction for instance.
+   *
+   *  Use the connection given to aTask: calling the writes of this RoutingDatabase from aTask would deadlock.
+   */
+  void withWriter(const std::function<void(Database& aWriter)>& aTask);
+
+  /**
+   * @brief Run aTask(connection) on the writer, then on each reader, waiting for each of them to be free.
+   *
+   *  To apply the settings of the connections (PRAGMA, ATTACH, functions, busy timeout...).
+   */
+  void forEachConnection(const std::function<void(Database& aConnection)>& aTask);
+
+  /**
+   * @brief Scan a table in parallel: split its rowid range into partitions, each one read by its own reader and thread.
+   *
+   *  The read transactions of the readers are all started on the same database state: at the same WAL snapshot
+   *  when available (see Snapshot), and in any case while holding the writer, so that no write of this
+   *  RoutingDatabase commits in between. The rowid range [min(rowid), max(rowid)] of this state is split
+   *  into aPartitions ranges of the same width, and aTask(query, partition) is run for each one in parallel,
+   *  with the query "SELECT aColumns FROM aTable WHERE rowid BETWEEN ? AND ?" bound to the range of the partition.
+   *  The partitions are balanced as long as the rowids are dense (no large gaps).
+   *
+   * @param[in] aTable      Name of a rowid table
+   * @param[in] aColumns    Columns (or expressions) to read, "*" for all the columns
+   * @param[in] aPartitions Number of partitions, 0 (or more than getReaderCount()) for one per reader
+   * @param[in] aTask       Called on its own thread for each partition, to step through the rows of its query;
+   *                        it shall only use this query (all the readers may be held by the scan)
+   *
+   * @throw SQLite::Exception in case of error (for instance WITHOUT ROWID table), or the first exception of aTask
+   */
+  void scanPartitions(const std::string& aTable, const std::string& aColumns, unsigned aPartitions,
+                      const std::function<void(Statement& aQuery, std::size_t aPartition)>& aTask);
+
+  /**
+   * @brief Aggregate a table in parallel, see scanPartitions(): fold the rows of each partition into a partial result,
+   *        then merge the partial results in the order of the partitions.
+   *
+   * @code{.cpp}
+   * const double total = db.parallelScan("events", "value", 0.0,
+   *     [](double& aPartial, SQLite::Statement& aRow) { aPartial += aRow.getColumn(0).getDouble(); },
+   *     [](double aLeft, double aRight) { return aLeft + aRight; });
+   * @endcode
+   *
+   * @param[in] aTable    Name of a rowid table
+   * @param[in] aColumns  Columns (or expressions) to read
+   * @param[in] aInit     Initial value of each partial result: the identity of aReduce (0 for a sum)
+   * @param[in] aRow      Fold each row of a partition into its partial result: aRow(T& partial, Statement& row)
+   * @param[in] aReduce   Merge two partial results: T aReduce(T left, T right)
+   * @param[in] aPartitions Number of partitions, 0 for one per reader
+   */
+  template<typename T, typename RowFunction, typename Reducer>
+  T parallelScan(const std::string& aTable, const std::string& aColumns, const T& aInit,
+                 RowFunction aRow, Reducer aReduce, const unsigned aPartitions = 0) {
+    std::vector<T> partials(getPartitionCount(aPartitions), aInit);
+    scanPartitions(aTable, aColumns, aPartitions, [&](Statement& aQuery, std::size_t aPartition) {
+      T& partial = partials[aPartition];
+      while (aQuery.executeStep())
+        aRow(partial, aQuery);
+    });
+    T result = std::move(partials[0]);
+    for (std::size_t partition = 1; partition < partials.size(); ++partition)
+      result = aReduce(std::move(result), std::move(partials[partition]));
+    return result;
+  }
+
+  /// Return the number of partitions of a parallel scan: aPartitions, up to the number of readers (0 for all of them)
+  std::size_t getPartitionCount(const unsigned aPartitions) const noexcept {
+    return ((aPartitions > 0) && (aPartitions < mReaders.size())) ? aPartitions : mReaders.size();
+  }
+
+  /// Forget the routes of the SQL texts (after a schema change turning a view into a table, for instance)
+  void clearRoutes();
+
+  /// Return a snapshot of the counters
+  RoutingStats getStats() const;
+
+private:
+  template<typename... Args>
+  static void bindAll(Statement& aStatement, const Args&... aArgs) {
+    if constexpr (sizeof...(Args) > 0)
+      SQLite::bind(aStatement, aArgs...);
+  }
+
+  /// Connection leased to the current thread, given back on destruction (defined in the cpp)
+  class Lease;
+
+  /// Lease a free reader, or the writer, waiting for it if needed
+  Database& acquire(Route aRoute);
+
+  /// Give a leased connection back, and wake up a thread waiting for it
+  void release(Database& aDatabase) noexcept;
+
+  /// Set aRoute to the cached route of a SQL text, and return true if found
+  bool findRoute(const std::string& aQuery, Route& aRoute) const;
+
+  /// Decide the route of a new SQL text from its statement prepared on a reader, and cache it
+  Route addRoute(const Statement& aStatement);
+
+  /// Count a statement run on aRoute, and if its route was cached
+  void count(Route aRoute, bool abKnown) noexcept;
+
+  std::unique_ptr<Database>               mpWriter;     ///< Read-write connection
+  std::vector<std::unique_ptr<Database>>  mReaders;     ///< Read-only connections
+  mutable std::mutex                      mMutex;       ///< Guards the members below
+  std::condition_variable                 mReleased;    ///< Signaled when a connection is given back
+  std::vector<Database*>                  mFreeReaders; ///< Readers not leased
+  bool                                    mbWriterFree = true; ///< false while the writer is leased
+  std::unordered_map<std::string, Route>  mRoutes;      ///< Cached route of each SQL text
+  RoutingStats                            mStats;       ///< Counters (routes computed on demand)
+};
+
+} // SQLite
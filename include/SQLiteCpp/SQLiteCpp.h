@@ -4,12 +4,32 @@
  */
 #pragma once
 
+#include <SQLiteCpp/Allocator.h>
 #include <SQLiteCpp/Assertion.h>
+#include <SQLiteCpp/Cancellation.h>
+#include <SQLiteCpp/Changes.h>
 #include <SQLiteCpp/Column.h>
 #include <SQLiteCpp/Database.h>
 #include <SQLiteCpp/Exception.h>
+#include <SQLiteCpp/Export.h>
+#include <SQLiteCpp/Fields.h>
+#include <SQLiteCpp/Function.h>
+#include <SQLiteCpp/Import.h>
+#include <SQLiteCpp/MemoryDatabasePool.h>
+#include <SQLiteCpp/MemoryGovernor.h>
+#include <SQLiteCpp/Pragma.h>
+#include <SQLiteCpp/QueryPlan.h>
+#include <SQLiteCpp/Result.h>
+#include <SQLiteCpp/ResultCache.h>
+#include <SQLiteCpp/RoutingDatabase.h>
+#include <SQLiteCpp/Session.h>
+#include <SQLiteCpp/ShardedDatabase.h>
+#include <SQLiteCpp/Snapshot.h>
 #include <SQLiteCpp/Statement.h>
+#include <SQLiteCpp/Status.h>
+#include <SQLiteCpp/Trace.h>
 #include <SQLiteCpp/Transaction.h>
+#include <SQLiteCpp/VirtualTable.h>
 
 /**
  * @brief Version numbers for SQLiteC++ are provided in the same way as sqlite3.h
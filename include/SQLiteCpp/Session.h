@@ -0,0 +1,178 @@
+/**
+ * @file    Session.h
+ * @ingroup SQLiteCpp
+ * @brief   RAII wrapper of the SQLite session extension: capture of changesets, and their application on another database.
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <SQLiteCpp/Database.h>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+// Forward declaration to avoid inclusion of <sqlite3.h> in a header
+struct sqlite3_session;
+
+namespace SQLite {
+
+/// Binary changeset (or patchset) produced by a Session, to transfer and apply with applyChangeset()
+using Changeset = std::vector<unsigned char>;
+
+/// Reason of a conflict met while applying a changeset
+enum class ConflictType {
+  Data,       ///< The row to update or delete exists, but with other values than the ones expected
+  NotFound,   ///< The row to update or delete does not exist
+  Conflict,   ///< The row to insert already exists (same primary key)
+  Constraint, ///< A change violates a constraint (NOT NULL, UNIQUE, CHECK...)
+  ForeignKey  ///< The changeset leaves foreign key violations
+};
+
+/// Resolution of a conflict met while applying a changeset
+enum class ConflictAction {
+  Omit,     ///< Skip the conflicting change, and go on with the next one
+  Replace,  ///< Overwrite the existing row with the change (Data and Conflict only, otherwise Omit)
+  Abort     ///< Stop, and roll back all the changes of the changeset (throws a SQLite::Exception)
+};
+
+/// User callback choosing the resolution of each conflict, given its type and the name of the table
+using ConflictHandler = std::function<ConflictAction(ConflictType aType, const std::string& aTable)>;
+
+/**
+ * @brief RAII wrapper of a sqlite3_session, recording the changes made to the tables of a Database.
+ *
+ *  The session records the rows inserted, updated and deleted from the tables it is attached to,
+ *  then returns them as a compact changeset: only the primary key and changed values of each row,
+ *  one change per row whatever the number of statements. Applied with applyChangeset() on a follower
+ *  database with the same schema, it brings it in sync by transferring only the changed rows:
+ *
+ * @code{.cpp}
+ * SQLite::Session session(primary);
+ * session.attach();
+ * {
+ *   SQLite::Transaction transaction(primary);
+ *   ...
+ *   transaction.commit();
+ * }
+ * const SQLite::Changeset changeset = session.changeset();
+ * session.clear(); // start capturing the next transaction
+ *
+ * SQLite::applyChangeset(replica, changeset, SQLite::ConflictAction::Replace);
+ * @endcode
+ *
+ *  Only the tables with a declared PRIMARY KEY are recorded. The session extension must be compiled
+ *  in the sqlite3 library, and SQLiteCpp built with SQLITE_ENABLE_SESSION (see isAvailable()).
+ *
+ * @note The session uses the preupdate hook of the connection: it cannot be created while a
+ *       Database::setChangeSink() captures the values, and the values cannot be captured while a session exists
+ *       (both throw a SQLite::Exception). The change sink without the values and the result cache
+ *       do not use the preupdate hook, and work along with the sessions.
+ */
+class Session {
+public:
+  /**
+   * @brief Create a session recording the changes of the database aDbName of the connection.
+   *
+   * @param[in] aDatabase Connection to record the changes of; it must outlive the session
+   * @param[in] aDbName   Name of the database: "main", "temp", or the name of an attached database
+   *
+   * @throw SQLite::Exception if the session extension is not available, or in case of error
+   */
+  explicit Session(Database& aDatabase, const std::string& aDbName = "main");
+
+  /// Delete the session (the changes recorded and not retrieved are lost)
+  ~Session();
+
+  Session(const Session&) = delete;
+  Session& operator=(const Session&) = delete;
+
+  /// true if SQLiteCpp was built with SQLITE_ENABLE_SESSION, to create sessions
+  static bool isAvailable() noexcept;
+
+  /**
+   * @brief Record the changes of the table aTable, or of all the tables if empty (including the ones created later).
+   *
+   * @throw SQLite::Exception in case of error
+   */
+  void attach(const std::string& aTable = std::string());
+
+  /// Pause (false) or resume (true) the recording of the changes
+  void setEnabled(bool abEnabled) noexcept;
+
+  /// true if no change was recorded
+  bool isEmpty() const noexcept;
+
+  /**
+   * @brief Return the changeset of all the changes recorded: with the old values, to detect conflicts when applied.
+   *
+   * @throw SQLite::Exception in case of error
+   */
+  Changeset changeset() const;
+
+  /**
+   * @brief Return the patchset of all the changes recorded: smaller than a changeset, without the old values.
+   *
+   *  Applying a patchset cannot detect Data conflicts: the new values always replace the existing ones.
+   *
+   * @throw SQLite::Exception in case of error
+   */
+  Changeset patchset() const;
+
+  /**
+   * @brief Forget the changes recorded so far, to record the next transaction in its own changeset.
+   *
+   *  The session is deleted and created again, attached to the same tables, as SQLite cannot reset a session.
+   *
+   * @throw SQLite::Exception in case of error
+   */
+  void clear();
+
+  /// Return the sqlite3_session handle
+  sqlite3_session* getHandle() const noexcept {
+    return mpSession;
+  }
+
+private:
+  /// Create the sqlite3_session, and attach it to the tables
+  void create();
+
+  Database&                 mDatabase;  ///< Connection recorded
+  std::string               mDbName;    ///< Name of the database recorded ("main"...)
+  std::vector<std::string>  mTables;    ///< Tables attached, an empty name for all the tables
+  bool                      mbEnabled;  ///< Recording enabled
+  sqlite3_session*          mpSession;  ///< Session handle
+};
+
+/**
+ * @brief Apply a changeset or patchset to the database, in a single transaction, resolving all the conflicts the same way.
+ *
+ *  With ConflictAction::Replace, the conflicts other than Data and Conflict are omitted.
+ *
+ * @param[in] aDatabase   Connection to apply the changes to, with the same schema as the source of the changeset
+ * @param[in] aChangeset  Changeset or patchset produced by a Session
+ * @param[in] aPolicy     Resolution of every conflict
+ *
+ * @throw SQLite::Exception if aborted on a conflict (nothing is applied), or in case of error
+ */
+void applyChangeset(Database& aDatabase, const Changeset& aChangeset, ConflictAction aPolicy = ConflictAction::Abort);
+
+/**
+ * @brief Apply a changeset or patchset to the database, in a single transaction, resolving each conflict with aHandler.
+ *
+ *  An exception thrown by aHandler aborts the application, and is rethrown.
+ *
+ * @throw SQLite::Exception if aborted on a conflict (nothing is applied), or in case of error
+ */
+void applyChangeset(Database& aDatabase, const Changeset& aChangeset, const ConflictHandler& aHandler);
+
+/**
+ * @brief Return the inverse of the changeset: applied after it, it undoes its changes (not valid for a patchset).
+ *
+ * @throw SQLite::Exception in case of error
+ */
+Changeset invertChangeset(const Changeset& aChangeset);
+
+} // SQLite
@@ -0,0 +1,245 @@
+/**
+ * @file    ShardedDatabase.h
+ * @ingroup SQLiteCpp
+ * @brief   Facade over N database files: keyed routing of writes, and parallel fan-out of reads with merged results.
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <SQLiteCpp/Database.h>
+#include <SQLiteCpp/Fields.h>
+#include <SQLiteCpp/Statement.h>
+#include <SQLiteCpp/VariadicBind.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <queue>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace SQLite {
+
+/// Combination of the per-shard results of a simple aggregate query, see ShardedDatabase::queryAggregate()
+enum class Aggregate {
+  Count,  ///< Sum of the per-shard COUNT(...)
+  Sum,    ///< Sum of the per-shard SUM(...) or TOTAL(...)
+  Min,    ///< Minimum of the per-shard MIN(...)
+  Max     ///< Maximum of the per-shard MAX(...)
+};
+
+/**
+ * @brief Facade over N Database files (shards) holding the partitions of the same tables.
+ *
+ *  Each row belongs to the shard chosen by the hash of its key: getShard(aKey) routes the writes of a key
+ *  to its owning shard. The read queries are run on every shard in parallel, by a pool of threads,
+ *  and their results merged: concatenated (queryAll()), merged in order of a key (queryOrdered()),
+ *  or combined for simple aggregates (queryAggregate()).
+ *
+ * @code{.cpp}
+ * SQLite::ShardedDatabase shards({"events_0.db3", "events_1.db3", "events_2.db3", "events_3.db3"},
+ *                                SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE);
+ * shards.exec("CREATE TABLE IF NOT EXISTS events (id INTEGER PRIMARY KEY, kind TEXT, value REAL)");
+ *
+ * SQLite::Statement insert(shards.getShard(id), "INSERT INTO events VALUES (?, ?, ?)");
+ *
+ * const auto total = shards.queryAggregate<double>(SQLite::Aggregate::Sum, "SELECT total(value) FROM events");
+ * const auto latest = shards.queryOrdered<Event>("SELECT id, kind, value FROM events WHERE kind = ? ORDER BY id DESC LIMIT 100",
+ *                                                [](const Event& a, const Event& b) { return a.id > b.id; }, 100, "click");
+ * @endcode
+ *
+ *  Like a Database, a ShardedDatabase shall not be used by multiple threads at once:
+ *  during a fan-out, each shard connection is used by exactly one thread of the pool.
+ */
+class ShardedDatabase {
+public:
+  /// Hash of a key, mapped to the shard (hash % getShardCount())
+  using HashFunction = std::function<std::size_t(long long aKey)>;
+
+  /**
+   * @brief Open one database connection per file, with the same flags, and start the pool of threads.
+   *
+   * @param[in] aFilenames  UTF-8 paths of the shards, in order: the shard of a key depends on this order
+   * @param[in] aFlags      Flags of the connections, see Database
+   * @param[in] aHash       Hash of the keys; the default mixes the bits of the key, to spread sequential keys
+   * @param[in] aThreads    Number of threads of the pool, 0 for one per shard (up to the number of cores)
+   *
+   * @throw SQLite::Exception if no file is given, or if a file cannot be opened
+   */
+  explicit ShardedDatabase(const std::vector<std::string>& aFilenames,
+                           const int aFlags = SQLite::OPEN_READONLY,
+                           HashFunction aHash = HashFunction(),
+                           const unsigned aThreads = 0);
+
+  /// Stop the pool of threads, and close the database connections
+  ~ShardedDatabase();
+
+  ShardedDatabase(const ShardedDatabase&) = delete;
+  ShardedDatabase& operator=(const ShardedDatabase&) = delete;
+
+  /// Return the number of shards
+  std::size_t getShardCount() const noexcept {
+    return mShards.size();
+  }
+
+  /// Return the index of the shard owning aKey
+  std::size_t getShardIndex(const long long aKey) const;
+
+  /// Return the shard owning aKey, to write the rows of this key
+  Database& getShard(const long long aKey) {
+    return *mShards[getShardIndex(aKey)];
+  }
+
+  /// Return the shard at index aIndex in [0, getShardCount())
+  Database& getShardAt(const std::size_t aIndex) {
+    return *mShards.at(aIndex);
+  }
+
+  /**
+   * @brief Run aTask(shard, index) for each shard in parallel on the pool, and wait for all of them.
+   *
+   *  The first exception thrown by a task is rethrown, once all the tasks are finished.
+   */
+  void forEachShard(const std::function<void(Database& aShard, std::size_t aIndex)>& aTask);
+
+  /**
+   * @brief Execute the statements without results on every shard, in parallel (to create the schema, for instance)
+   *
+   * @return total number of rows modified by the *last* statement on each shard
+   */
+  int exec(const std::string& aQueries);
+
+  /**
+   * @brief Run the query on every shard in parallel, and concatenate the rows in shard order.
+   *
+   *  The rows are read into structs T with the field descriptors FieldsOf<T> (see Fields.h),
+   *  and aArgs are bound to the parameters of the query on each shard.
+   */
+  template<typename T, typename... Args>
+  std::vector<T> queryAll(const std::string& aQuery, const Args&... aArgs) {
+    std::vector<std::vector<T>> parts = queryShards<T>(aQuery, aArgs...);
+    std::size_t total = 0;
+    for (const std::vector<T>& part : parts)
+      total += part.size();
+    std::vector<T> rows;
+    rows.reserve(total);
+    for (std::vector<T>& part : parts)
+      std::move(part.begin(), part.end(), std::back_inserter(rows));
+    return rows;
+  }
+
+  /**
+   * @brief Run the query on every shard in parallel, and merge the rows in the order of aLess.
+   *
+   *  The query must return the rows of each shard sorted in the same order (ORDER BY):
+   *  the per-shard results are merged without sorting them again. Add a LIMIT to the query
+   *  and aLimit for a global top-N, without reading more than N rows of each shard.
+   *
+   * @param[in] aQuery  Query returning the rows of each shard in the order of aLess
+   * @param[in] aLess   Strict weak ordering of the rows
+   * @param[in] aLimit  Maximum number of rows to return, 0 for all
+   * @param[in] aArgs   Values bound to the parameters of the query on each shard
+   */
+  template<typename T, typename Less, typename... Args>
+  std::vector<T> queryOrdered(const std::string& aQuery, Less aLess, const std::size_t aLimit, const Args&... aArgs) {
+    std::vector<std::vector<T>> parts = queryShards<T>(aQuery, aArgs...);
+
+    // k-way merge: heap of the next row of each shard, smallest on top
+    using Cursor = std::pair<std::size_t, std::size_t>; // (shard, row)
+    const auto greater = [&](const Cursor& a, const Cursor& b) {
+      return aLess(parts[b.first][b.second], parts[a.first][a.second]);
+    };
+    std::priority_queue<Cursor, std::vector<Cursor>, decltype(greater)> heap(greater);
+    std::size_t total = 0;
+    for (std::size_t shard = 0; shard < parts.size(); ++shard) {
+      total += parts[shard].size();
+      if (!parts[shard].empty())
+        heap.emplace(shard, 0);
+    }
+    if ((aLimit > 0) && (aLimit < total))
+      total = aLimit;
+
+    std::vector<T> rows;
+    rows.reserve(total);
+    while (!heap.empty() && (rows.size() < total)) {
+      const Cursor cursor = heap.top();
+      heap.pop();
+      rows.push_back(std::move(parts[cursor.first][cursor.second]));
+      if (cursor.second + 1 < parts[cursor.first].size())
+        heap.emplace(cursor.first, cursor.second + 1);
+    }
+    return rows;
+  }
+
+  /**
+   * @brief Run the aggregate query on every shard in parallel, and combine the per-shard values.
+   *
+   *  The query returns a single value per shard (like "SELECT max(value) FROM events"), as a T (long long or double).
+   *  NULL values (MIN or MAX of an empty shard) are ignored. AVG cannot be combined this way:
+   *  query the SUM and the COUNT instead.
+   *
+   * @return the combined value, or nothing if all the shards returned NULL
+   */
+  template<typename T, typename... Args>
+  std::optional<T> queryAggregate(const Aggregate aAggregate, const std::string& aQuery, const Args&... aArgs) {
+    static_assert(std::is_same<T, long long>::value || std::is_same<T, double>::value,
+                  "Aggregates are long long or double");
+    std::vector<std::optional<T>> values(mShards.size());
+    forEachShard([&](Database& aShard, std::size_t aIndex) {
+      Statement query(aShard, aQuery);
+      bindAll(query, aArgs...);
+      if (query.executeStep() && !query.isColumnNull(0))
+        detail::readField(query, 0, values[aIndex]);
+    });
+
+    std::optional<T> result;
+    for (const std::optional<T>& value : values) {
+      if (!value)
+        continue;
+      if (!result)
+        result = value;
+      else if ((Aggregate::Count == aAggregate) || (Aggregate::Sum == aAggregate))
+        *result += *value;
+      else if (Aggregate::Min == aAggregate)
+        *result = std::min(*result, *value);
+      else
+        *result = std::max(*result, *value);
+    }
+    return result;
+  }
+
+private:
+  template<typename... Args>
+  static void bindAll(Statement& aStatement, const Args&... aArgs) {
+    if constexpr (sizeof...(Args) > 0)
+      SQLite::bind(aStatement, aArgs...);
+  }
+
+  /// Rows of the query on each shard, read in parallel
+  template<typename T, typename... Args>
+  std::vector<std::vector<T>> queryShards(const std::string& aQuery, const Args&... aArgs) {
+    std::vector<std::vector<T>> parts(mShards.size());
+    forEachShard([&](Database& aShard, std::size_t aIndex) {
+      Statement query(aShard, aQuery);
+      bindAll(query, aArgs...);
+      readAll(query, parts[aIndex]);
+    });
+    return parts;
+  }
+
+  /// Pool of threads running the fan-out tasks (defined in the cpp)
+  class Pool;
+
+  std::vector<std::unique_ptr<Database>>  mShards;  ///< Connection to each shard
+  HashFunction                            mHash;    ///< Hash of the keys
+  std::unique_ptr<Pool>                   mpPool;   ///< Threads running the per-shard tasks
+};
+
+} // SQLite
@@ -0,0 +1,134 @@
+/**
+ * @file    Snapshot.h
+ * @ingroup SQLiteCpp
+ * @brief   WAL snapshots and read transactions, to read the same database state from multiple connections.
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <SQLiteCpp/Database.h>
+
+#include <string>
+
+// Forward declaration to avoid inclusion of <sqlite3.h> in a header
+struct sqlite3_snapshot;
+
+namespace SQLite {
+
+/**
+ * @brief RAII wrapper of a sqlite3_snapshot: the state of a WAL database seen by a read transaction.
+ *
+ *  Captured by the read transaction of a connection (see ReadTransaction::getSnapshot()), a snapshot lets
+ *  other connections to the same database open read transactions on exactly the same state, whatever was
+ *  committed since: for consistent parallel scans, split between multiple connections.
+ *
+ * @code{.cpp}
+ * SQLite::ReadTransaction first(reader1);
+ * const SQLite::Snapshot snapshot = first.getSnapshot();
+ * SQLite::ReadTransaction second(reader2, snapshot); // sees the same state as first
+ * @endcode
+ *
+ *  The database must be in WAL mode. A snapshot can be opened as long as the WAL file has not been
+ *  checkpointed past it: keep the read transaction that captured it open until the others have started.
+ *  The snapshot support must be compiled in the sqlite3 library, and SQLiteCpp built
+ *  with SQLITE_ENABLE_SNAPSHOT (see isAvailable()).
+ */
+class Snapshot {
+public:
+  /**
+   * @brief Capture the snapshot of the read transaction open on the database aDbName of the connection.
+   *
+   * @param[in] aDatabase Connection with an open read transaction (and no write transaction), see ReadTransaction
+   * @param[in] aDbName   Name of the database: "main", or the name of an attached database
+   *
+   * @throw SQLite::Exception if snapshots are not available, if the database is not in WAL mode,
+   *                          or if the connection has no read transaction open
+   */
+  explicit Snapshot(Database& aDatabase, const std::string& aDbName = "main");
+
+  /// Free the snapshot
+  ~Snapshot();
+
+  Snapshot(Snapshot&& aOther) noexcept;
+  Snapshot& operator=(Snapshot&& aOther) noexcept;
+
+  Snapshot(const Snapshot&) = delete;
+  Snapshot& operator=(const Snapshot&) = delete;
+
+  /// true if SQLiteCpp was built with SQLITE_ENABLE_SNAPSHOT, to capture and open snapshots
+  static bool isAvailable() noexcept;
+
+  /// Return the name of the database of the snapshot
+  const std::string& getDbName() const noexcept {
+    return mDbName;
+  }
+
+  /**
+   * @brief Compare the age of two snapshots of the same database file (sqlite3_snapshot_cmp()).
+   *
+   * @return negative if this snapshot is older than aOther, 0 if they are the same state, positive if newer
+   */
+  int compare(const Snapshot& aOther) const noexcept;
+
+  /// Return the underlying sqlite3_snapshot
+  sqlite3_snapshot* getHandle() const noexcept {
+    return mpSnapshot;
+  }
+
+private:
+  std::string       mDbName;              ///< Name of the database: "main" or an attached database
+  sqlite3_snapshot* mpSnapshot = nullptr; ///< Snapshot, nullptr once moved
+};
+
+/**
+ * @brief RAII read transaction: all the reads of the connection see the same database state until it ends.
+ *
+ *  Begins a transaction and starts reading right away (unlike a deferred BEGIN, which only starts at the first read),
+ *  either at the latest state of the database, or at the state of a Snapshot. Ended in the destructor.
+ */
+class ReadTransaction {
+public:
+  /**
+   * @brief Begin a read transaction at the latest state of the database aDbName.
+   *
+   * @throw SQLite::Exception in case of error (for instance if a transaction is already open)
+   */
+  explicit ReadTransaction(Database& aDatabase, const std::string& aDbName = "main");
+
+  /**
+   * @brief Begin a read transaction at the state of a snapshot of the same database (sqlite3_snapshot_open()).
+   *
+   * @throw SQLite::Exception if snapshots are not available, or if the snapshot cannot be opened anymore
+   *                          (SQLITE_ERROR_SNAPSHOT once the WAL file is checkpointed past it)
+   */
+  ReadTransaction(Database& aDatabase, const Snapshot& aSnapshot);
+
+  /// End the read transaction, if not ended yet
+  ~ReadTransaction();
+
+  ReadTransaction(const ReadTransaction&) = delete;
+  ReadTransaction& operator=(const ReadTransaction&) = delete;
+
+  /**
+   * @brief Capture the snapshot of this read transaction, to open other read transactions on the same state.
+   *
+   * @throw SQLite::Exception if snapshots are not available, or if the database is not in WAL mode
+   */
+  Snapshot getSnapshot() const;
+
+  /**
+   * @brief End the read transaction before the destructor.
+   *
+   * @throw SQLite::Exception in case of error, or if already ended
+   */
+  void end();
+
+private:
+  Database&   mDatabase;  ///< Connection of the transaction
+  std::string mDbName;    ///< Name of the database read
+  bool        mbEnded;    ///< true once ended
+};
+
+} // SQLite
@@ -0,0 +1,52 @@
+/**
+ * @file    Span.h
+ * @ingroup SQLiteCpp
+ * @brief   Non-owning view over a contiguous sequence of objects (a minimal C++17 stand-in for C++20 std::span).
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace SQLite {
+
+/**
+ * @brief Non-owning view over a contiguous sequence of objects of type T.
+ *
+ *  Used to pass arrays and binary blobs to and from SQLite without copying them.
+ *  The viewed memory must outlive the Span.
+ */
+template<typename T>
+class Span {
+public:
+  /// Empty view
+  constexpr Span() noexcept : mpData{nullptr}, mSize{0} {
+  }
+
+  /// View over aSize objects starting at apData
+  constexpr Span(T* apData, std::size_t aSize) noexcept : mpData{apData}, mSize{aSize} {
+  }
+
+  /// View over the content of a contiguous container (std::vector, std::array, std::string...)
+  template<typename Container,
+           typename = std::enable_if_t<std::is_convertible<decltype(std::declval<Container&>().data()), T*>::value>>
+  constexpr Span(Container& aContainer) noexcept : mpData{aContainer.data()}, mSize{aContainer.size()} {
+  }
+
+  constexpr T*          data() const noexcept   { return mpData; }
+  constexpr std::size_t size() const noexcept   { return mSize; }
+  constexpr bool        empty() const noexcept  { return 0 == mSize; }
+  constexpr T*          begin() const noexcept  { return mpData; }
+  constexpr T*          end() const noexcept    { return mpData + mSize; }
+  constexpr T&          operator[](std::size_t aIndex) const noexcept { return mpData[aIndex]; }
+
+private:
+  T*          mpData; ///< Pointer to the first object
+  std::size_t mSize;  ///< Number of objects
+};
+
+} // SQLite
@@ -1,9 +1,18 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <map>
+#include <memory>
+#include <chrono>
 #include <climits>
+#include <cstdint>
+#include <type_traits>
+#include <SQLiteCpp/Cancellation.h>
 #include <SQLiteCpp/Exception.h>
+#include <SQLiteCpp/QueryPlan.h>
+#include <SQLiteCpp/Result.h>
+#include <SQLiteCpp/Span.h>
 
 // Forward declarations to avoid inclusion of <sqlite3.h> in a header
 struct sqlite3;
@@ -14,9 +23,45 @@ namespace SQLite {
 // Forward declaration
 class Database;
 class Column;
+/// @cond
+namespace detail {
+class StatementReader;
+/// Type of no array, replacing DistinctInt64 where std::int64_t is long long
+struct NoInt64 {};
+/// std::int64_t when it is not the same type as long long (long on LP64 platforms), for the bindArray() overloads
+using DistinctInt64 = std::conditional_t<std::is_same<std::int64_t, long long>::value, NoInt64, std::int64_t>;
+} // namespace detail
+/// @endcond
 
 extern const int OK; ///< SQLITE_OK
 
+/**
+ * @brief Runtime counters of a prepared statement, from sqlite3_stmt_status().
+ *
+ * @see Statement::getStatus() and Database::getStatementStatus()
+ */
+struct StatementStatus {
+  int fullscanSteps = 0;  ///< Number of forward steps in a table as part of a full table scan (SQLITE_STMTSTATUS_FULLSCAN_STEP)
+  int sorts         = 0;  ///< Number of sort operations (SQLITE_STMTSTATUS_SORT)
+  int autoIndexes   = 0;  ///< Number of rows inserted into transient automatic indexes (SQLITE_STMTSTATUS_AUTOINDEX)
+  int vmSteps       = 0;  ///< Number of virtual machine operations executed (SQLITE_STMTSTATUS_VM_STEP)
+  int reprepares    = 0;  ///< Number of automatic regenerations of the statement after a schema change (SQLITE_STMTSTATUS_REPREPARE)
+  int runs          = 0;  ///< Number of times the statement has been run (SQLITE_STMTSTATUS_RUN)
+  int memUsed       = 0;  ///< Approximate number of bytes of heap memory used to store the statement (SQLITE_STMTSTATUS_MEMUSED)
+
+  /// Accumulate the counters of another statement
+  StatementStatus& operator+=(const StatementStatus& aOther) noexcept {
+    fullscanSteps += aOther.fullscanSteps;
+    sorts         += aOther.sorts;
+    autoIndexes   += aOther.autoIndexes;
+    vmSteps       += aOther.vmSteps;
+    reprepares    += aOther.reprepares;
+    runs          += aOther.runs;
+    memUsed       += aOther.memUsed;
+    return *this;
+  }
+};
+
 /**
  * @brief RAII encapsulation of a prepared SQLite Statement.
  *
@@ -36,6 +81,7 @@ extern const int OK; ///< SQLITE_OK
  */
 class Statement {
   friend class Column; // For access to Statement::Ptr inner class
+  friend class detail::StatementReader; // For direct access to the columns of the current row, see Fields.h
 
 public:
   /**
@@ -150,6 +196,37 @@ public:
    */
   void bind(const int aIndex);
 
+  /**
+   * @brief Bind an array of integers to a parameter "?", "?NNN", ":VVV", "@VVV" or "$VVV" in the SQL prepared statement (aIndex >= 1),
+   *        as the argument of the table-valued function created by Database::createArrayFunction().
+   *
+   * @code{.cpp}
+   * SQLite::Statement query(db, "SELECT name FROM tracks WHERE id IN carray(?)");
+   * query.bindArray(1, ids); // std::vector<long long>
+   * @endcode
+   *
+   * @warning The array is not copied, only a pointer to it is bound: it must remains unchanged while executing the statement.
+   */
+  void bindArray(const int aIndex, Span<const long long> aValues);
+  /**
+   * @brief Bind an array of std::int64_t, when it is not long long (std::vector<std::int64_t> on LP64 platforms), see above.
+   */
+  void bindArray(const int aIndex, Span<const detail::DistinctInt64> aValues);
+  /**
+   * @brief Bind an array of floating point values to a parameter "?", "?NNN", ":VVV", "@VVV" or "$VVV" in the SQL prepared statement (aIndex >= 1),
+   *        as the argument of the table-valued function created by Database::createArrayFunction().
+   *
+   * @warning The array is not copied, only a pointer to it is bound: it must remains unchanged while executing the statement.
+   */
+  void bindArray(const int aIndex, Span<const double> aValues);
+  /**
+   * @brief Bind an array of UTF-8 strings to a parameter "?", "?NNN", ":VVV", "@VVV" or "$VVV" in the SQL prepared statement (aIndex >= 1),
+   *        as the argument of the table-valued function created by Database::createArrayFunction().
+   *
+   * @warning Neither the array nor the strings are copied: they must remains unchanged while executing the statement.
+   */
+  void bindArray(const int aIndex, Span<const std::string_view> aValues);
+
   /**
    * @brief Bind an int value to a named parameter "?NNN", ":VVV", "@VVV" or "$VVV" in the SQL prepared statement (aIndex >= 1)
    */
@@ -211,6 +288,31 @@ public:
    * @warning Uses the SQLITE_STATIC flag, avoiding a copy of the data. The string must remains unchanged while executing the statement.
    */
   void bindNoCopy(std::string const &apName, const void* apValue, const int aSize);
+  /**
+   * @brief Bind an array of integers to a named parameter "?NNN", ":VVV", "@VVV" or "$VVV" in the SQL prepared statement,
+   *        as the argument of the table-valued function created by Database::createArrayFunction().
+   *
+   * @warning The array is not copied, only a pointer to it is bound: it must remains unchanged while executing the statement.
+   */
+  void bindArray(std::string const &apName, Span<const long long> aValues);
+  /**
+   * @brief Bind an array of std::int64_t, when it is not long long (std::vector<std::int64_t> on LP64 platforms), see above.
+   */
+  void bindArray(std::string const &apName, Span<const detail::DistinctInt64> aValues);
+  /**
+   * @brief Bind an array of floating point values to a named parameter "?NNN", ":VVV", "@VVV" or "$VVV" in the SQL prepared statement,
+   *        as the argument of the table-valued function created by Database::createArrayFunction().
+   *
+   * @warning The array is not copied, only a pointer to it is bound: it must remains unchanged while executing the statement.
+   */
+  void bindArray(std::string const &apName, Span<const double> aValues);
+  /**
+   * @brief Bind an array of UTF-8 strings to a named parameter "?NNN", ":VVV", "@VVV" or "$VVV" in the SQL prepared statement,
+   *        as the argument of the table-valued function created by Database::createArrayFunction().
+   *
+   * @warning Neither the array nor the strings are copied: they must remains unchanged while executing the statement.
+   */
+  void bindArray(std::string const &apName, Span<const std::string_view> aValues);
   /**
    * @brief Bind a NULL value to a named parameter "?NNN", ":VVV", "@VVV" or "$VVV" in the SQL prepared statement (aIndex >= 1)
    *
@@ -230,6 +332,67 @@ public:
 
 #endif
 
+  ////////////////////////////////////////////////////////////////////////////
+  // Non-throwing variants of bind(), returning the result code instead of throwing a SQLite::Exception,
+  // see SQLite::Result. Text and blob values are copied (SQLITE_TRANSIENT), as with bind().
+  ////////////////////////////////////////////////////////////////////////////
+
+  /// Bind an int value to a parameter (aIndex >= 1), returning the result code instead of throwing
+  Result tryBind(const int aIndex, const int aValue) noexcept;
+  /// Bind a 64bits int value to a parameter (aIndex >= 1), returning the result code instead of throwing
+  Result tryBind(const int aIndex, const long long aValue) noexcept;
+  /// Bind a 32bits unsigned int value to a parameter (aIndex >= 1), returning the result code instead of throwing
+  Result tryBind(const int aIndex, const unsigned aValue) noexcept {
+    return tryBind(aIndex, static_cast<long long>(aValue));
+  }
+  /// Bind a long value to a parameter (aIndex >= 1), returning the result code instead of throwing
+  Result tryBind(const int aIndex, const long aValue) noexcept {
+    return tryBind(aIndex, static_cast<long long>(aValue));
+  }
+  /// Bind a double value to a parameter (aIndex >= 1), returning the result code instead of throwing
+  Result tryBind(const int aIndex, const double aValue) noexcept;
+  /// Bind a text value to a parameter (aIndex >= 1), returning the result code instead of throwing
+  Result tryBind(const int aIndex, const std::string& aValue) noexcept;
+  /// Bind a text value to a parameter (aIndex >= 1), returning the result code instead of throwing
+  Result tryBind(const int aIndex, const char* apValue) noexcept;
+  /// Bind a binary blob value to a parameter (aIndex >= 1), returning the result code instead of throwing
+  Result tryBind(const int aIndex, const void* apValue, const int aSize) noexcept;
+  /// Bind a NULL value to a parameter (aIndex >= 1), returning the result code instead of throwing
+  Result tryBind(const int aIndex) noexcept;
+
+  /**
+   * @brief Set the maximum duration of each execution of the statement, 0 (the default) for none.
+   *
+   *  The deadline starts at the first step after a reset (or the first one ever), and is checked
+   *  every few virtual machine instructions (see Database::setCancellationCheckInterval()):
+   *  past it, the step fails with SQLITE_INTERRUPT, thrown as a SQLite::TimeoutException.
+   *  The statement must then be reset, and an interrupted write rolls back its transaction.
+   *
+   * @warning The deadline and the cancellation token are checked by the progress handler of the connection,
+   *          installed for each step of the statement and removed after it: SQLite cannot restore the previous one,
+   *          so a handler installed directly with sqlite3_progress_handler() cannot be combined with them.
+   */
+  void setTimeout(const std::chrono::milliseconds aTimeout) noexcept {
+    mTimeout = aTimeout;
+  }
+
+  /**
+   * @brief Set the token cancelling the executions of the statement, from another thread.
+   *
+   *  Checked before each step and every few virtual machine instructions: once cancelled, the steps fail
+   *  with SQLITE_INTERRUPT, thrown as a SQLite::CancelledException. Pass a default token to remove it.
+   *
+   * @warning Checked by a progress handler, which cannot be combined with sqlite3_progress_handler(), see setTimeout().
+   */
+  void setCancellationToken(const CancellationToken& aToken) noexcept {
+    mCancellationToken = aToken;
+  }
+
+  /// Return why the last step was interrupted (SQLITE_INTERRUPT), for tryExecuteStep() and tryExec()
+  Interruption getInterruption() const noexcept {
+    return mInterruption;
+  }
+
   /**
    * @brief Execute a step of the prepared query to fetch one row of results.
    *
@@ -246,6 +409,7 @@ public:
    *                               (case of a query with no result, or after N rows fetched successfully)
    *
    * @throw SQLite::Exception in case of error
+   * @throw SQLite::TimeoutException or SQLite::CancelledException if interrupted, see setTimeout()
    */
   bool executeStep();
 
@@ -281,9 +445,34 @@ public:
    * @return number of row modified by this SQL statement (INSERT, UPDATE or DELETE)
    *
    * @throw SQLite::Exception in case of error, or if row of results are returned !
+   * @throw SQLite::TimeoutException or SQLite::CancelledException if interrupted, see setTimeout()
    */
   int exec();
 
+  /**
+   * @brief Execute a one-step query with no expected result, returning the result code instead of throwing.
+   *
+   *  Same as exec(), but any error is returned as a SQLite::Result (SQLITE_MISUSE if a row of results is returned).
+   *
+   * @return number of rows modified by this SQL statement on success (SQLITE_DONE), else the result code
+   */
+  Expected<int> tryExec() noexcept;
+
+  /**
+   * @brief Compile the SQL query, returning the result code instead of throwing.
+   *
+   *  Useful to retry the preparation while the schema is locked (SQLITE_BUSY, SQLITE_LOCKED),
+   *  without the cost of a SQLite::Exception at each attempt.
+   *
+   * @param[in] aDatabase the SQLite Database Connection
+   * @param[in] aQuery    an UTF-8 encoded query string
+   *
+   * @return the new Statement on success, else the result code of sqlite3_prepare_v2()
+   *
+   * @throw std::bad_alloc if memory allocation fails (not a SQLite::Exception)
+   */
+  static Expected<std::unique_ptr<Statement>> tryPrepare(Database& aDatabase, const std::string& aQuery);
+
   /**
    * @brief Return a copy of the column data specified by its index
    *
@@ -449,6 +638,8 @@ public:
   inline bool isDone() const {
     return mbDone;
   }
+  /// true if the statement makes no direct change to the database files, see sqlite3_stmt_readonly()
+  bool isReadOnly() const noexcept;
 
   /// Return the numeric result code for the most recent failed API call (if any).
   int getErrorCode() const noexcept; // nothrow
@@ -457,6 +648,29 @@ public:
   /// Return UTF-8 encoded English language explanation of the most recent failed API call (if any).
   std::string getErrorMsg() const noexcept; // nothrow
 
+  /**
+   * @brief Return the runtime counters of the statement, to spot full table scans, sorts and automatic indexes.
+   *
+   * @see http://www.sqlite.org/c3ref/stmt_status.html
+   *
+   * @param[in] abReset   Reset the counters to zero after reading them (memUsed is not a counter and is never reset)
+   */
+  StatementStatus getStatus(bool abReset = false) noexcept;
+
+  /// Read the runtime counters of any SQLite prepared statement, see getStatus().
+  static StatementStatus getStatus(sqlite3_stmt* apStmt, bool abReset) noexcept;
+
+  /**
+   * @brief Run EXPLAIN QUERY PLAN for the SQL query of this statement and return the plan as a tree.
+   *
+   *  Useful to check that a query uses the expected indexes, see QueryPlanNode::isScan() and isTempBTree().
+   *  The statement itself is not executed, and its bindings are not used.
+   * @see http://www.sqlite.org/eqp.html
+   *
+   * @throw SQLite::Exception in case of error (for instance if the query is itself an EXPLAIN)
+   */
+  QueryPlan explainPlan() const;
+
 private:
   /**
    * @brief Shared pointer to the sqlite3_stmt SQLite Statement Object.
@@ -468,7 +682,9 @@ private:
   class Ptr {
   public:
     // Prepare the statement and initialize its reference counter
-    Ptr(sqlite3* apSQLite, std::string& aQuery);
+    Ptr(sqlite3* apSQLite, std::string& aQuery, bool abWaitForUnlock = false);
+    // Take ownership of a statement already prepared (setting apStmt to NULL), and initialize its reference counter
+    Ptr(sqlite3* apSQLite, sqlite3_stmt*& apStmt);
     // Copy constructor increments the ref counter
     Ptr(const Ptr& aPtr);
     // Decrement the ref counter and finalize the sqlite3_stmt when it reaches 0
@@ -496,6 +712,9 @@ private:
   };
 
 private:
+  /// Take ownership of the statement apStmt (set to NULL once owned), already prepared from aQuery (see tryPrepare())
+  Statement(Database& aDatabase, const std::string& aQuery, sqlite3_stmt*& apStmt);
+
   /// @{ Statement must be non-copyable
   Statement(const Statement &);
   Statement& operator =(const Statement &);
@@ -511,6 +730,12 @@ private:
       throw SQLite::Exception(mStmtPtr);
   }
 
+  /// Step with the deadline and cancellation token checked by a progress handler
+  int watchedStep() noexcept;
+
+  /// Throw the SQLite::Exception of a failed step (TimeoutException or CancelledException if interrupted)
+  [[noreturn]] void throwStepError() const;
+
   /**
    * @brief Check if there is a row of result returned by executeStep(), else throw a SQLite::Exception.
    */
@@ -532,12 +757,18 @@ private:
   typedef std::map<std::string, int> TColumnNames;
 
 private:
+  Database&               mDatabase;      //!< Database connection of the statement (to deliver its changes, see Database::setChangeSink())
   std::string             mQuery;         //!< UTF-8 SQL Query
   Ptr                     mStmtPtr;       //!< Shared Pointer to the prepared SQLite Statement Object
   int                     mColumnCount;   //!< Number of columns in the result of the prepared statement
   mutable TColumnNames    mColumnNames;   //!< Map of columns index by name (mutable so getColumnIndex can be const)
   bool                    mbHasRow;           //!< true when a row has been fetched with executeStep()
   bool                    mbDone;         //!< true when the last executeStep() had no more row to fetch
+  bool                    mbStarted = false;  //!< true once the current execution made its first step (deadline set)
+  std::chrono::milliseconds mTimeout{0};  //!< Maximum duration of an execution, 0 for none
+  std::chrono::steady_clock::time_point mDeadline; //!< Deadline of the current execution
+  CancellationToken       mCancellationToken; //!< Token cancelling the executions, if any
+  Interruption            mInterruption = Interruption::None; //!< Reason why the last step was interrupted
 };
 
 } // SQLite
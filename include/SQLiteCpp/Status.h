@@ -0,0 +1,78 @@
+/**
+ * @file    Status.h
+ * @ingroup SQLiteCpp
+ * @brief   Snapshots of the connection (sqlite3_db_status) and process (sqlite3_status64) memory and cache statistics.
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+namespace SQLite {
+
+/**
+ * @brief Snapshot of the statistics of one database connection, from sqlite3_db_status().
+ *
+ *  Counters (cache hits, misses...) accumulate since the connection was opened or since the last reset,
+ * while gauges (memory used) give the current value: subtracting two snapshots gives
+ * the counts over the period in between, and the change of the gauges.
+ *
+ * @see Database::getStatus()
+ * @see http://www.sqlite.org/c3ref/c_dbstatus_options.html
+ */
+struct DatabaseStatus {
+  long long cacheHit          = 0;  ///< Number of page cache hits (SQLITE_DBSTATUS_CACHE_HIT)
+  long long cacheMiss         = 0;  ///< Number of page cache misses (SQLITE_DBSTATUS_CACHE_MISS)
+  long long cacheWrite        = 0;  ///< Number of dirty cache pages written to disk (SQLITE_DBSTATUS_CACHE_WRITE)
+  long long cacheSpill        = 0;  ///< Number of dirty cache pages written to disk in the middle of a transaction (SQLITE_DBSTATUS_CACHE_SPILL)
+  long long cacheUsed         = 0;  ///< Bytes of heap memory used by the page cache (SQLITE_DBSTATUS_CACHE_USED)
+  long long lookasideUsed     = 0;  ///< Number of lookaside memory slots currently checked out (SQLITE_DBSTATUS_LOOKASIDE_USED)
+  long long lookasideHit      = 0;  ///< Number of allocations satisfied using lookaside memory (SQLITE_DBSTATUS_LOOKASIDE_HIT)
+  long long lookasideMissSize = 0;  ///< Number of allocations too large for lookaside memory (SQLITE_DBSTATUS_LOOKASIDE_MISS_SIZE)
+  long long lookasideMissFull = 0;  ///< Number of allocations missed because all lookaside memory was in use (SQLITE_DBSTATUS_LOOKASIDE_MISS_FULL)
+  long long schemaUsed        = 0;  ///< Bytes of heap memory used to store the schemas (SQLITE_DBSTATUS_SCHEMA_USED)
+  long long stmtUsed          = 0;  ///< Bytes of heap memory used by all the prepared statements (SQLITE_DBSTATUS_STMT_USED)
+
+  /// Return the page cache hit rate in the [0, 1] range, or 0 without any cache access
+  double getCacheHitRate() const noexcept {
+    const long long accesses = cacheHit + cacheMiss;
+    return (accesses > 0) ? static_cast<double>(cacheHit) / static_cast<double>(accesses) : 0.0;
+  }
+};
+
+/// Return the difference between two snapshots of connection statistics (aAfter - aBefore)
+DatabaseStatus operator-(const DatabaseStatus& aAfter, const DatabaseStatus& aBefore) noexcept;
+
+/**
+ * @brief Snapshot of the process-wide statistics of the SQLite library, from sqlite3_status64().
+ *
+ *  Highwater marks are the maximum values since the process started or since the last reset;
+ * subtracting two snapshots gives the change of each value.
+ *
+ * @see getMemoryStatus()
+ * @see http://www.sqlite.org/c3ref/c_status_malloc_count.html
+ */
+struct MemoryStatus {
+  long long memoryUsed                 = 0; ///< Bytes of memory currently allocated by SQLite (SQLITE_STATUS_MEMORY_USED)
+  long long memoryUsedHighwater        = 0; ///< Highwater mark of memoryUsed
+  long long mallocCount                = 0; ///< Number of separate memory allocations currently checked out (SQLITE_STATUS_MALLOC_COUNT)
+  long long mallocCountHighwater       = 0; ///< Highwater mark of mallocCount
+  long long mallocSizeHighwater        = 0; ///< Size of the largest memory allocation request (SQLITE_STATUS_MALLOC_SIZE)
+  long long pagecacheUsed              = 0; ///< Number of pages used out of the SQLITE_CONFIG_PAGECACHE memory (SQLITE_STATUS_PAGECACHE_USED)
+  long long pagecacheOverflow          = 0; ///< Bytes of page cache allocations that overflowed to the general-purpose allocator (SQLITE_STATUS_PAGECACHE_OVERFLOW)
+  long long pagecacheOverflowHighwater = 0; ///< Highwater mark of pagecacheOverflow
+};
+
+/// Return the difference between two snapshots of process-wide statistics (aAfter - aBefore)
+MemoryStatus operator-(const MemoryStatus& aAfter, const MemoryStatus& aBefore) noexcept;
+
+/**
+ * @brief Return a snapshot of the process-wide memory statistics of the SQLite library.
+ *
+ * @param[in] abReset   Reset the highwater marks to the current values after reading them
+ *
+ * @throw SQLite::Exception in case of error
+ */
+MemoryStatus getMemoryStatus(bool abReset = false);
+
+} // SQLite
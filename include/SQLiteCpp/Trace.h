@@ -0,0 +1,68 @@
+/**
+ * @file    Trace.h
+ * @ingroup SQLiteCpp
+ * @brief   Per-statement tracing of a Database connection, and a ready-made slow-query logger.
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <iosfwd>
+#include <string>
+
+namespace SQLite {
+
+/**
+ * @brief Execution profile of one SQL statement, reported once the statement has finished running.
+ *
+ * @see Database::setTraceSink()
+ */
+struct TraceEvent {
+  std::string sql;        ///< UTF-8 SQL text, with bound parameters expanded if requested
+  long long   elapsedNs;  ///< Approximate wall-clock time spent running the statement, in nanoseconds
+  long long   rows;       ///< Number of result rows returned by the statement
+};
+
+/**
+ * @brief User callback receiving a TraceEvent for each statement run on a traced Database.
+ *
+ * @warning Called from within the SQLite library: the sink must not use the traced Database connection,
+ *          and exceptions it throws are swallowed.
+ */
+using TraceSink = std::function<void(const TraceEvent&)>;
+
+/**
+ * @brief Ready-made TraceSink writing one line for each statement slower than a threshold.
+ *
+ * @code{.cpp}
+ * SQLite::Database db("example.db3", SQLite::OPEN_READWRITE);
+ * db.setTraceSink(SQLite::SlowQueryLogger(std::cerr, std::chrono::milliseconds(50)), true);
+ * @endcode
+ *
+ * Output format: "slow query (12.345 ms, 10 rows): SELECT ..."
+ */
+class SlowQueryLogger {
+public:
+  /**
+   * @param[in] aStream     Output stream, must outlive the logger (and any copy of it)
+   * @param[in] aThreshold  Statements running for at least this duration are logged
+   */
+  SlowQueryLogger(std::ostream& aStream, std::chrono::nanoseconds aThreshold);
+
+  /// Log the statement if it ran for at least the threshold duration
+  void operator()(const TraceEvent& aEvent) const;
+
+  /// Return the threshold duration
+  inline std::chrono::nanoseconds getThreshold() const noexcept {
+    return mThreshold;
+  }
+
+private:
+  std::ostream*             mpStream;     ///< Output stream (pointer to keep the logger copyable)
+  std::chrono::nanoseconds  mThreshold;   ///< Statements running for at least this duration are logged
+};
+
+} // SQLite
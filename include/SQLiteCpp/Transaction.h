@@ -11,6 +11,7 @@
 #pragma once
 
 #include <SQLiteCpp/Exception.h>
+#include <SQLiteCpp/Result.h>
 
 
 namespace SQLite
@@ -62,6 +63,14 @@ public:
      */
     void commit();
 
+    /**
+     * @brief Commit the transaction, returning the result code instead of throwing.
+     *
+     *  On SQLITE_BUSY the transaction is still active: the commit can be retried.
+     *  Returns SQLITE_MISUSE if the transaction was already committed.
+     */
+    Result tryCommit() noexcept;
+
 private:
     // Transaction must be non-copyable
     Transaction(const Transaction&);
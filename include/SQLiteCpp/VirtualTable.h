@@ -0,0 +1,251 @@
+/**
+ * @file    VirtualTable.h
+ * @ingroup SQLiteCpp
+ * @brief   Read-only virtual table exposing a C++ container of structs, see Database::createContainerTable(),
+ *          and table-valued function reading an array bound to a statement, see Database::createArrayFunction().
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <SQLiteCpp/Function.h>
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+// Forward declarations to avoid inclusion of <sqlite3.h> in a header
+struct sqlite3;
+struct sqlite3_stmt;
+
+namespace SQLite {
+
+/**
+ * @brief Column of a container table, mapped to a data member of the structs of the container.
+ *
+ * @see tableColumn(), sortedKeyColumn() and Database::createContainerTable()
+ */
+template<typename Row, typename T>
+struct TableColumn {
+  std::string name;       ///< Name of the SQL column
+  T Row::*    member;     ///< Data member of the struct read by the column
+  bool        bSortedKey; ///< true if the container is sorted in ascending order of this column
+};
+
+/// Column named aName reading the data member apMember of each struct of the container
+template<typename Row, typename T>
+TableColumn<Row, T> tableColumn(std::string aName, T Row::* apMember) {
+  return TableColumn<Row, T>{std::move(aName), apMember, false};
+}
+
+/**
+ * @brief Column named aName reading the data member apMember, by which the container is sorted in ascending order.
+ *
+ *  Equality and range constraints on this column (=, <, <=, >, >=) are then resolved by a binary search
+ *  instead of a full scan, and an ORDER BY on this column needs no sort. At most one column can be the sorted key.
+ */
+template<typename Row, typename T>
+TableColumn<Row, T> sortedKeyColumn(std::string aName, T Row::* apMember) {
+  return TableColumn<Row, T>{std::move(aName), apMember, true};
+}
+
+/// @cond
+/// implementation detail of container virtual tables.
+namespace detail {
+
+/// Kind of the values of a column, to check if a constraint value can be compared to the sorted key
+enum class ValueKind {
+  NUMERIC,
+  TEXT,
+  BLOB,
+  OTHER
+};
+
+template<typename T>
+constexpr ValueKind valueKind() {
+  if constexpr (IsOptional<T>::value) {
+    return valueKind<typename T::value_type>();
+  } else if constexpr (std::is_arithmetic<T>::value) {
+    return ValueKind::NUMERIC;
+  } else if constexpr (std::is_convertible<const T&, std::string_view>::value) {
+    return ValueKind::TEXT;
+  } else if constexpr (std::is_convertible<const T&, Blob>::value) {
+    return ValueKind::BLOB;
+  } else {
+    return ValueKind::OTHER;
+  }
+}
+
+/// Declared type of a column in the CREATE TABLE statement of the virtual table
+template<typename T>
+const char* declaredType() {
+  if constexpr (IsOptional<T>::value)
+    return declaredType<typename T::value_type>();
+  switch (valueKind<T>()) {
+  case ValueKind::NUMERIC:  return std::is_floating_point<T>::value ? " REAL" : " INTEGER";
+  case ValueKind::TEXT:     return " TEXT";
+  case ValueKind::BLOB:     return " BLOB";
+  default:                  return "";
+  }
+}
+
+/// Compare a C++ value of the sorted key to a sqlite3_value of the same ValueKind (NULL values sort first)
+template<typename T>
+int compareValue(const T& aKey, sqlite3_value* apValue) {
+  if constexpr (IsOptional<T>::value) {
+    return aKey ? compareValue(*aKey, apValue) : -1;
+  } else if constexpr (std::is_integral<T>::value) {
+    const long long integer = valueInt64(apValue);
+    const double real = valueDouble(apValue);
+    if (static_cast<double>(integer) != real) {
+      // Non integral constraint value (1.5): compare as floating point
+      const double key = static_cast<double>(aKey);
+      return (key < real) ? -1 : (key > real) ? 1 : 0;
+    }
+    const long long key = static_cast<long long>(aKey);
+    return (key < integer) ? -1 : (key > integer) ? 1 : 0;
+  } else if constexpr (std::is_floating_point<T>::value) {
+    const double real = valueDouble(apValue);
+    return (aKey < real) ? -1 : (aKey > real) ? 1 : 0;
+  } else if constexpr (std::is_convertible<const T&, std::string_view>::value) {
+    const int cmp = std::string_view(aKey).compare(valueText(apValue));
+    return (cmp < 0) ? -1 : (cmp > 0) ? 1 : 0;
+  } else if constexpr (std::is_convertible<const T&, Blob>::value) {
+    const Blob key(aKey);
+    const Blob blob = valueBlob(apValue);
+    const std::size_t size = (key.size() < blob.size()) ? key.size() : blob.size();
+    const int cmp = (size > 0) ? std::memcmp(key.data(), blob.data(), size) : 0;
+    if (0 != cmp)
+      return (cmp < 0) ? -1 : 1;
+    return (key.size() < blob.size()) ? -1 : (key.size() > blob.size()) ? 1 : 0;
+  } else {
+    static_assert(sizeof(T) == 0, "Unsupported sorted key column type");
+  }
+}
+
+class ContainerSource;
+
+/**
+ * Register the eponymous-only virtual table module aName reading apSource,
+ * owned by the connection from now on (deleted on error too).
+ * @return SQLite result code
+ */
+int createContainerModule(sqlite3* apSQLite, const char* apName, ContainerSource* apSource) noexcept;
+
+/**
+ * Type-erased access to the rows of a container, used by the sqlite3_module implemented in VirtualTable.cpp
+ */
+class ContainerSource {
+public:
+  virtual ~ContainerSource() = default;
+
+  /// Number of rows of the container
+  virtual std::size_t size() const = 0;
+  /// Set the value of column aColumn of row aRow as the result of apContext
+  virtual void result(sqlite3_context* apContext, std::size_t aRow, int aColumn) const = 0;
+  /// Compare the sorted key of row aRow to apValue (of the ValueKind of the key): <0, 0 or >0
+  virtual int compareKey(std::size_t aRow, sqlite3_value* apValue) const = 0;
+
+  std::string mSchema;                         ///< CREATE TABLE statement declaring the columns
+  int         mKeyColumn = -1;                 ///< Index of the sorted key column, -1 if none
+  ValueKind   mKeyKind = ValueKind::OTHER;     ///< Kind of the values of the sorted key column
+};
+
+/// ContainerSource reading the columns of a random access container of structs through data member pointers
+template<typename Container, typename... Columns>
+class ContainerTable final : public ContainerSource {
+public:
+  ContainerTable(const Container& aContainer, Columns... aColumns) :
+    mContainer(aContainer),
+    mColumns(std::move(aColumns)...)
+  {
+    mSchema = "CREATE TABLE x(";
+    declareColumns(std::index_sequence_for<Columns...>{});
+    mSchema += ")";
+  }
+
+  std::size_t size() const override {
+    return mContainer.size();
+  }
+
+  void result(sqlite3_context* apContext, std::size_t aRow, int aColumn) const override {
+    resultColumn(apContext, mContainer[aRow], aColumn, std::index_sequence_for<Columns...>{});
+  }
+
+  int compareKey(std::size_t aRow, sqlite3_value* apValue) const override {
+    return compareColumn(mContainer[aRow], apValue, std::index_sequence_for<Columns...>{});
+  }
+
+private:
+  template<std::size_t... Is>
+  void declareColumns(std::index_sequence<Is...>) {
+    (declareColumn(static_cast<int>(Is), std::get<Is>(mColumns)), ...);
+  }
+
+  template<typename Row, typename T>
+  void declareColumn(int aIndex, const TableColumn<Row, T>& aColumn) {
+    if (0 != aIndex)
+      mSchema += ", ";
+    mSchema += '"';
+    for (const char c : aColumn.name) {
+      mSchema += c;
+      if ('"' == c)
+        mSchema += '"';
+    }
+    mSchema += '"';
+    mSchema += declaredType<T>();
+    if (aColumn.bSortedKey && -1 == mKeyColumn && valueKind<T>() != ValueKind::OTHER) {
+      mKeyColumn = aIndex;
+      mKeyKind = valueKind<T>();
+    }
+  }
+
+  template<typename Row, std::size_t... Is>
+  void resultColumn(sqlite3_context* apContext, const Row& aRow, int aColumn, std::index_sequence<Is...>) const {
+    (void)((static_cast<int>(Is) == aColumn ? (setResult(apContext, aRow.*(std::get<Is>(mColumns).member)), true)
+                                            : false) || ...);
+  }
+
+  template<typename Row, std::size_t... Is>
+  int compareColumn(const Row& aRow, sqlite3_value* apValue, std::index_sequence<Is...>) const {
+    int cmp = 0;
+    (void)((static_cast<int>(Is) == mKeyColumn ? (cmp = compareKeyColumn(aRow, std::get<Is>(mColumns), apValue), true)
+                                               : false) || ...);
+    return cmp;
+  }
+
+  template<typename Row, typename T>
+  static int compareKeyColumn(const Row& aRow, const TableColumn<Row, T>& aColumn, sqlite3_value* apValue) {
+    if constexpr (valueKind<T>() != ValueKind::OTHER) {
+      return compareValue(aRow.*(aColumn.member), apValue);
+    } else {
+      return 0; // never the sorted key, see mKeyKind
+    }
+  }
+
+  const Container&        mContainer; ///< Container of structs, not copied
+  std::tuple<Columns...>  mColumns;   ///< Columns mapped to data members of the structs
+};
+
+/// Type of the elements of an array bound by Statement::bindArray()
+enum class ArrayType {
+  INT64,
+  DOUBLE,
+  TEXT
+};
+
+/// Register the eponymous-only table-valued function aName reading the arrays bound by bindArray()
+int createArrayModule(sqlite3* apSQLite, const char* apName) noexcept;
+
+/// Bind a pointer to the array of aSize elements at apData (not copied) to the parameter aIndex of apStmt
+int bindArray(sqlite3_stmt* apStmt, int aIndex, ArrayType aType, const void* apData, std::size_t aSize) noexcept;
+
+} // namespace detail
+/// @endcond
+
+} // SQLite
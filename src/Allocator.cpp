@@ -0,0 +1,356 @@
+#include <sqlite3.h>
+#include <SQLiteCpp/Allocator.h>
+#include <SQLiteCpp/Exception.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace SQLite {
+
+namespace {
+
+// Size classes are the powers of two from 16 to 4096 bytes: larger allocations go to the system malloc()
+const int           CLASS_COUNT     = 9;
+const std::size_t   MIN_CLASS_SIZE  = 16;
+const std::size_t   MAX_CLASS_SIZE  = MIN_CLASS_SIZE << (CLASS_COUNT - 1);
+// Each block starts with its usable size, keeping the 8-byte alignment required by SQLite
+const std::size_t   HEADER_SIZE     = sizeof(std::uint64_t);
+// Number of blocks of a class a thread keeps in its cache before giving half of them back to the shared pool
+const int           CACHE_MAX       = 128;
+// Number of blocks moved at once from the shared pool to a thread cache
+const int           BATCH_SIZE      = 32;
+// Size of the arena blocks reserved from the system and carved into blocks of a class
+const std::size_t   ARENA_SIZE      = 64 * 1024;
+
+struct FreeBlock {
+  FreeBlock* pNext;
+};
+
+struct FreeList {
+  FreeBlock*  pHead = nullptr;
+  int         count = 0;
+
+  void push(FreeBlock* apBlock) {
+    apBlock->pNext = pHead;
+    pHead = apBlock;
+    ++count;
+  }
+
+  FreeBlock* pop() {
+    FreeBlock* pBlock = pHead;
+    pHead = pBlock->pNext;
+    --count;
+    return pBlock;
+  }
+};
+
+int getClassIndex(std::size_t aSize) {
+  int index = 0;
+  for (std::size_t classSize = MIN_CLASS_SIZE; classSize < aSize; classSize <<= 1)
+    ++index;
+  return index;
+}
+
+std::size_t getClassSize(int aIndex) {
+  return MIN_CLASS_SIZE << aIndex;
+}
+
+std::uint64_t& getHeader(void* apUser) {
+  return *(static_cast<std::uint64_t*>(apUser) - 1);
+}
+
+/// Free lists and counters of one thread: only this thread writes them
+struct ThreadCache {
+  FreeList                lists[CLASS_COUNT];
+  std::atomic<long long>  mallocCount{0};
+  std::atomic<long long>  freeCount{0};
+  std::atomic<long long>  reallocCount{0};
+  std::atomic<long long>  cacheHits{0};
+  std::atomic<long long>  largeCount{0};
+};
+
+/// Increment a counter written by a single thread, without a locked instruction
+void increment(std::atomic<long long>& aCounter) {
+  aCounter.store(aCounter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+/// Pool shared by all the threads, refilling their caches
+struct SharedPool {
+  std::mutex                mutex;
+  FreeList                  lists[CLASS_COUNT];
+  long long                 arenaBytes = 0;
+  long long                 arenaLimit = 0; ///< Maximum of arenaBytes, 0 for no limit
+  AllocatorStats            retired;    ///< Counters of the threads that exited, and of the allocations without cache
+  std::vector<ThreadCache*> caches;     ///< Caches of the running threads
+};
+
+// Never destroyed: SQLite may free memory until the very end of the process
+SharedPool& getPool() {
+  static SharedPool* spPool = new SharedPool();
+  return *spPool;
+}
+
+// Move aCount blocks from aFrom to aTo
+void moveBlocks(FreeList& aFrom, FreeList& aTo, int aCount) {
+  for (int i = 0; (i < aCount) && (nullptr != aFrom.pHead); ++i)
+    aTo.push(aFrom.pop());
+}
+
+// Carve a new arena block into blocks of the class aIndex, with the pool mutex locked
+bool growPool(SharedPool& aPool, int aIndex) {
+  const std::size_t blockSize = HEADER_SIZE + getClassSize(aIndex);
+  const std::size_t count = std::max<std::size_t>(ARENA_SIZE / blockSize, BATCH_SIZE);
+  if ((aPool.arenaLimit > 0) && (aPool.arenaBytes + static_cast<long long>(count * blockSize) > aPool.arenaLimit))
+    return false;
+  unsigned char* pArena = static_cast<unsigned char*>(std::malloc(count * blockSize));
+  if (nullptr == pArena)
+    return false;
+  aPool.arenaBytes += static_cast<long long>(count * blockSize);
+  for (std::size_t i = 0; i < count; ++i) {
+    void* pUser = pArena + i * blockSize + HEADER_SIZE;
+    getHeader(pUser) = getClassSize(aIndex);
+    aPool.lists[aIndex].push(static_cast<FreeBlock*>(pUser));
+  }
+  return true;
+}
+
+/// Owner of the cache of a thread: gives back its blocks and counters to the shared pool when the thread exits
+struct ThreadCacheOwner {
+  ThreadCache cache;
+
+  ThreadCacheOwner() {
+    SharedPool& pool = getPool();
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    pool.caches.push_back(&cache);
+  }
+  ~ThreadCacheOwner();
+};
+
+// Trivially destructible, so still usable by the deallocations made after the destruction of the thread cache
+thread_local ThreadCache*  tpCache = nullptr;
+thread_local bool          tbCacheDestroyed = false;
+
+ThreadCacheOwner::~ThreadCacheOwner() {
+  tpCache = nullptr;
+  tbCacheDestroyed = true;
+  SharedPool& pool = getPool();
+  std::lock_guard<std::mutex> lock(pool.mutex);
+  for (int i = 0; i < CLASS_COUNT; ++i)
+    moveBlocks(cache.lists[i], pool.lists[i], cache.lists[i].count);
+  pool.retired.mallocCount += cache.mallocCount.load(std::memory_order_relaxed);
+  pool.retired.freeCount += cache.freeCount.load(std::memory_order_relaxed);
+  pool.retired.reallocCount += cache.reallocCount.load(std::memory_order_relaxed);
+  pool.retired.cacheHits += cache.cacheHits.load(std::memory_order_relaxed);
+  pool.retired.largeCount += cache.largeCount.load(std::memory_order_relaxed);
+  pool.caches.erase(std::find(pool.caches.begin(), pool.caches.end(), &cache));
+}
+
+// Return the cache of the calling thread, or nullptr if the thread is exiting
+ThreadCache* getThreadCache() {
+  if (nullptr != tpCache)
+    return tpCache;
+  if (tbCacheDestroyed)
+    return nullptr;
+  thread_local ThreadCacheOwner owner;
+  tpCache = &owner.cache;
+  return tpCache;
+}
+
+void* poolMalloc(int aSize) {
+  if (aSize <= 0)
+    return nullptr;
+  const std::size_t size = static_cast<std::size_t>(aSize);
+  ThreadCache* pCache = getThreadCache();
+
+  if (size > MAX_CLASS_SIZE) {
+    void* pRaw = std::malloc(HEADER_SIZE + size);
+    if (nullptr == pRaw)
+      return nullptr;
+    void* pUser = static_cast<unsigned char*>(pRaw) + HEADER_SIZE;
+    getHeader(pUser) = size;
+    if (nullptr != pCache) {
+      increment(pCache->mallocCount);
+      increment(pCache->largeCount);
+    } else {
+      SharedPool& pool = getPool();
+      std::lock_guard<std::mutex> lock(pool.mutex);
+      ++pool.retired.mallocCount;
+      ++pool.retired.largeCount;
+    }
+    return pUser;
+  }
+
+  const int index = getClassIndex(size);
+  if ((nullptr != pCache) && (nullptr != pCache->lists[index].pHead)) {
+    increment(pCache->mallocCount);
+    increment(pCache->cacheHits);
+    return pCache->lists[index].pop();
+  }
+
+  SharedPool& pool = getPool();
+  std::lock_guard<std::mutex> lock(pool.mutex);
+  if ((pool.lists[index].count < BATCH_SIZE) && !growPool(pool, index) && (nullptr == pool.lists[index].pHead))
+    return nullptr;
+  if (nullptr != pCache) {
+    increment(pCache->mallocCount);
+    // Keep at least the block to return, when the pool could not grow
+    moveBlocks(pool.lists[index], pCache->lists[index], std::min(BATCH_SIZE, pool.lists[index].count) - 1);
+  } else {
+    ++pool.retired.mallocCount;
+  }
+  return pool.lists[index].pop();
+}
+
+void poolFree(void* apUser) {
+  if (nullptr == apUser)
+    return;
+  const std::size_t size = static_cast<std::size_t>(getHeader(apUser));
+  ThreadCache* pCache = getThreadCache();
+  if (nullptr != pCache)
+    increment(pCache->freeCount);
+
+  if (size > MAX_CLASS_SIZE) {
+    std::free(static_cast<unsigned char*>(apUser) - HEADER_SIZE);
+    if (nullptr == pCache) {
+      SharedPool& pool = getPool();
+      std::lock_guard<std::mutex> lock(pool.mutex);
+      ++pool.retired.freeCount;
+    }
+    return;
+  }
+
+  const int index = getClassIndex(size);
+  if (nullptr != pCache) {
+    FreeList& list = pCache->lists[index];
+    list.push(static_cast<FreeBlock*>(apUser));
+    if (list.count > CACHE_MAX) {
+      SharedPool& pool = getPool();
+      std::lock_guard<std::mutex> lock(pool.mutex);
+      moveBlocks(list, pool.lists[index], CACHE_MAX / 2);
+    }
+  } else {
+    SharedPool& pool = getPool();
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    ++pool.retired.freeCount;
+    pool.lists[index].push(static_cast<FreeBlock*>(apUser));
+  }
+}
+
+int poolSize(void* apUser) {
+  return (nullptr != apUser) ? static_cast<int>(getHeader(apUser)) : 0;
+}
+
+int poolRoundup(int aSize) {
+  const std::size_t size = static_cast<std::size_t>(aSize);
+  if (size <= MAX_CLASS_SIZE)
+    return static_cast<int>(getClassSize(getClassIndex(size)));
+  return static_cast<int>((size + 7) & ~static_cast<std::size_t>(7));
+}
+
+void* poolRealloc(void* apUser, int aSize) {
+  ThreadCache* pCache = getThreadCache();
+  if (nullptr != pCache)
+    increment(pCache->reallocCount);
+  const std::size_t size = static_cast<std::size_t>(getHeader(apUser));
+  const std::size_t newSize = static_cast<std::size_t>(aSize);
+  // Keep the block if the new size rounds up to the same class, or for a large block shrinking by less than half
+  if ((size <= MAX_CLASS_SIZE) ? (newSize <= MAX_CLASS_SIZE && getClassIndex(newSize) == getClassIndex(size))
+                               : (newSize <= size && newSize > size / 2)) {
+    return apUser;
+  }
+  void* pNew = poolMalloc(aSize);
+  if (nullptr == pNew)
+    return nullptr;
+  std::memcpy(pNew, apUser, std::min(size, newSize));
+  poolFree(apUser);
+  return pNew;
+}
+
+int poolInit(void*) {
+  return SQLITE_OK;
+}
+
+void poolShutdown(void*) {
+}
+
+const sqlite3_mem_methods sPoolMethods = {
+  poolMalloc,
+  poolFree,
+  poolRealloc,
+  poolSize,
+  poolRoundup,
+  poolInit,
+  poolShutdown,
+  nullptr
+};
+
+std::mutex            sConfigMutex;
+bool                  sbConfigured = false;
+sqlite3_mem_methods   sPreviousMethods;
+
+} // namespace
+
+// Install the pool allocator as the SQLite memory allocator.
+void configureAllocator() {
+  std::lock_guard<std::mutex> lock(sConfigMutex);
+  if (sbConfigured)
+    return;
+  sqlite3_mem_methods previous;
+  std::memset(&previous, 0, sizeof(previous));
+  int ret = sqlite3_config(SQLITE_CONFIG_GETMALLOC, &previous);
+  if (SQLITE_OK == ret)
+    ret = sqlite3_config(SQLITE_CONFIG_MALLOC, &sPoolMethods);
+  if (SQLITE_OK != ret)
+    throw SQLite::Exception(std::string("configureAllocator() must be called before SQLite is initialized: ") +
+                            sqlite3_errstr(ret));
+  sPreviousMethods = previous;
+  sbConfigured = true;
+}
+
+// Restore the SQLite memory allocator in place before configureAllocator().
+void restoreAllocator() {
+  std::lock_guard<std::mutex> lock(sConfigMutex);
+  if (!sbConfigured)
+    return;
+  const int ret = sqlite3_config(SQLITE_CONFIG_MALLOC, &sPreviousMethods);
+  if (SQLITE_OK != ret)
+    throw SQLite::Exception(std::string("restoreAllocator() must be called before SQLite is initialized: ") +
+                            sqlite3_errstr(ret));
+  sbConfigured = false;
+}
+
+bool isAllocatorConfigured() noexcept {
+  std::lock_guard<std::mutex> lock(sConfigMutex);
+  return sbConfigured;
+}
+
+// Return the counters of the pool allocator.
+AllocatorStats getAllocatorStats() {
+  SharedPool& pool = getPool();
+  std::lock_guard<std::mutex> lock(pool.mutex);
+  AllocatorStats stats = pool.retired;
+  for (const ThreadCache* pCache : pool.caches) {
+    stats.mallocCount += pCache->mallocCount.load(std::memory_order_relaxed);
+    stats.freeCount += pCache->freeCount.load(std::memory_order_relaxed);
+    stats.reallocCount += pCache->reallocCount.load(std::memory_order_relaxed);
+    stats.cacheHits += pCache->cacheHits.load(std::memory_order_relaxed);
+    stats.largeCount += pCache->largeCount.load(std::memory_order_relaxed);
+  }
+  stats.arenaBytes = pool.arenaBytes;
+  return stats;
+}
+
+// Limit the bytes reserved from the system for the size-class pools.
+void setAllocatorArenaLimit(long long aBytes) noexcept {
+  SharedPool& pool = getPool();
+  std::lock_guard<std::mutex> lock(pool.mutex);
+  pool.arenaLimit = (aBytes > 0) ? aBytes : 0;
+}
+
+} // SQLite
@@ -1,10 +1,21 @@
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
+#include <functional>
+#include <list>
+#include <map>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <sqlite3.h>
 #include <SQLiteCpp/Database.h>
 #include <SQLiteCpp/Statement.h>
 #include <SQLiteCpp/Assertion.h>
 #include <SQLiteCpp/Exception.h>
+#include "Identifier.h"
 
 #ifndef SQLITE_DETERMINISTIC
 #define SQLITE_DETERMINISTIC 0x800
@@ -14,6 +25,103 @@ using namespace std;
 
 namespace SQLite {
 
+// State of the sqlite3_trace_v2() callback
+struct Database::Tracer {
+  TraceSink sink;         ///< User callback
+  bool      bExpandSql;   ///< Report SQL text with bound parameters expanded
+  unordered_map<sqlite3_stmt*, long long> rows; ///< Number of rows returned so far by each running statement
+};
+
+// State of the query plan check debug mode
+struct Database::PlanChecker {
+  QueryPlanCallback   callback;     ///< User callback
+  long long           minTableRows; ///< Minimum number of rows of a table for its full scans to be reported
+  map<string, long long> tableRows; ///< Cache of the number of rows of each scanned (quoted) table, -1 if unknown
+};
+
+// State of the change capture hooks
+struct Database::ChangeCapture {
+  ChangeSink          sink;               ///< User callback
+  vector<RowChange>   changes;            ///< Changes of the current transaction
+  bool                bValues = false;    ///< Capture the values with the preupdate hook
+  bool                bCommitting = false; ///< The commit hook was called by the current statement
+  vector<pair<string, size_t>> savepoints; ///< Open savepoints, with the number of changes buffered when they started
+};
+
+// State of the result cache
+struct Database::ResultCache {
+  struct Entry {
+    string                      key;      ///< SQL text and bound values
+    shared_ptr<const ResultSet> result;   ///< Rows of the query
+    vector<string>              tables;   ///< Tables read by the query
+    size_t                      bytes;    ///< Memory counted against the budget
+  };
+  using Position = list<Entry>::iterator;
+
+  size_t                      maxBytes;             ///< Memory budget
+  list<Entry>                 entries;              ///< Cached results, most recently used first
+  unordered_map<string, Position> index;            ///< Cached results by key
+  unordered_map<string, unordered_set<const Entry*>> entriesByTable; ///< Cached results reading each table
+  ResultCacheStats            stats;                ///< Counters
+  vector<string>*             pTablesRead = nullptr; ///< Tables read by the statement being prepared, if recorded
+  int                         lastAction = 0;       ///< Previous action code seen by the authorizer
+
+  void erase(const Position aPosition) {
+    for (const string& table : aPosition->tables) {
+      const auto found = entriesByTable.find(table);
+      found->second.erase(&*aPosition);
+      if (found->second.empty())
+        entriesByTable.erase(found);
+    }
+    stats.bytes -= aPosition->bytes;
+    index.erase(aPosition->key);
+    entries.erase(aPosition);
+  }
+
+  /// Drop the results reading the table apTable
+  void invalidate(const char* apTable) {
+    const auto found = entriesByTable.find(apTable);
+    if (found == entriesByTable.end())
+      return;
+    const vector<const Entry*> stale(found->second.begin(), found->second.end());
+    for (const Entry* pEntry : stale) {
+      erase(index.find(pEntry->key)->second);
+      ++stats.invalidations;
+    }
+  }
+
+  /// Drop all the results, counted as invalidations if abInvalidated
+  void clear(const bool abInvalidated) noexcept {
+    if (abInvalidated)
+      stats.invalidations += static_cast<long long>(entries.size());
+    entries.clear();
+    index.clear();
+    entriesByTable.clear();
+    stats.bytes = 0;
+  }
+
+  /// Evict the least recently used results, until aBytes more fit in the budget
+  void evict(const size_t aBytes) {
+    while (!entries.empty() && (stats.bytes + aBytes > maxBytes)) {
+      erase(std::prev(entries.end()));
+      ++stats.evictions;
+    }
+  }
+
+  /// Cache the result, evicting the least recently used ones over the budget
+  void insert(string&& aKey, shared_ptr<const ResultSet>&& aResult, vector<string>&& aTables) {
+    const size_t bytes = aResult->getMemoryUsed() + aKey.size() * 2 + sizeof(Entry);
+    if (bytes > maxBytes)
+      return;
+    evict(bytes);
+    entries.push_front(Entry{std::move(aKey), std::move(aResult), std::move(aTables), bytes});
+    index.emplace(entries.front().key, entries.begin());
+    for (const string& table : entries.front().tables)
+      entriesByTable[table].insert(&entries.front());
+    stats.bytes += bytes;
+  }
+};
+
 const int   OPEN_READONLY   = SQLITE_OPEN_READONLY;
 const int   OPEN_READWRITE  = SQLITE_OPEN_READWRITE;
 const int   OPEN_CREATE     = SQLITE_OPEN_CREATE;
@@ -43,6 +151,26 @@ Database::Database(const string& aFilename,
   open(aFilename, aFlags, aBusyTimeoutMs, aVfs);
 }
 
+// Open the provided database UTF-8 filename, and apply the PRAGMAs of a connection profile.
+Database::Database(const string&            aFilename,
+                   const int                aFlags,
+                   const ConnectionProfile& aProfile,
+                   const int                aBusyTimeoutMs /* = 0 */,
+                   const string&            aVfs           /* = "" */) :
+    mpSQLite{nullptr},
+    mFilename{aFilename}
+{
+  open(aFilename, aFlags, aBusyTimeoutMs, aVfs);
+  try {
+    applyProfile(aProfile);
+  } catch (...) {
+    // The destructor is not called when the constructor throws
+    detail::unregisterDatabase(*this);
+    sqlite3_close_v2(mpSQLite);
+    throw;
+  }
+}
+
 // Open a temporary in-memory database by default, use SQLite::TEMPORARY to open a temporary on-disk database.
 Database::Database(string const &fileName) : mpSQLite(nullptr), mFilename(fileName) {
   SQLITECPP_ASSERT(MEMORY == fileName || TEMPORARY == fileName, "Default access mode OPEN_READWRITE | OPEN_CREATE is only used for temporary databases");
@@ -51,6 +179,17 @@ Database::Database(string const &fileName) : mpSQLite(nullptr), mFilename(fileNa
 
 // Close the SQLite database connection.
 Database::~Database() {
+  detail::unregisterDatabase(*this);
+  if (mpTracer)
+    sqlite3_trace_v2(mpSQLite, 0, nullptr, nullptr);
+  if (mpChangeCapture || mpResultCache) {
+    if (mpResultCache)
+      sqlite3_set_authorizer(mpSQLite, nullptr, nullptr);
+    mpChangeCapture.reset();
+    mpResultCache.reset();
+    installHooks();
+  }
+
   int result = sqlite3_close_v2(mpSQLite);
   SQLITECPP_ASSERT(SQLITE_OK == result, sqlite3_errmsg(mpSQLite));
 }
@@ -73,15 +212,150 @@ void Database::setBusyTimeout(const int aBusyTimeoutMs) {
   check(ret);
 }
 
+namespace {
+
+// Names of the JournalMode values, in order
+const char* const JOURNAL_MODES[] = {"delete", "truncate", "persist", "memory", "wal", "off"};
+
+JournalMode toJournalMode(const string& aMode) {
+  for (int i = 0; i < static_cast<int>(sizeof(JOURNAL_MODES) / sizeof(JOURNAL_MODES[0])); ++i) {
+    if (0 == sqlite3_stricmp(aMode.c_str(), JOURNAL_MODES[i]))
+      return static_cast<JournalMode>(i);
+  }
+  throw SQLite::Exception("unknown journal mode: " + aMode);
+}
+
+} // namespace
+
+// Apply the PRAGMA values set in a connection profile.
+void Database::applyProfile(const ConnectionProfile& aProfile) {
+  // page_size first, as journal_mode=WAL creates the database file and freezes its page size
+  if (aProfile.pageSize)
+    setPageSize(*aProfile.pageSize);
+  if (aProfile.journalMode)
+    setJournalMode(*aProfile.journalMode);
+  if (aProfile.synchronous)
+    setSynchronous(*aProfile.synchronous);
+  if (aProfile.cacheSize)
+    setCacheSize(*aProfile.cacheSize);
+  if (aProfile.mmapSize)
+    setMmapSize(*aProfile.mmapSize);
+  if (aProfile.tempStore)
+    setTempStore(*aProfile.tempStore);
+  if (aProfile.walAutoCheckpoint)
+    setWalAutoCheckpoint(*aProfile.walAutoCheckpoint);
+}
+
+// Set the journal mode of the main database, returning the journal mode in effect.
+JournalMode Database::setJournalMode(const JournalMode aMode) {
+  const int index = static_cast<int>(aMode);
+  if ((index < 0) || (index >= static_cast<int>(sizeof(JOURNAL_MODES) / sizeof(JOURNAL_MODES[0]))))
+    throw SQLite::Exception("invalid journal mode: " + std::to_string(index));
+  const string query = string("PRAGMA journal_mode = ") + JOURNAL_MODES[index];
+  return toJournalMode(queryPragma(query.c_str()));
+}
+
+JournalMode Database::getJournalMode() const {
+  return toJournalMode(queryPragma("PRAGMA journal_mode"));
+}
+
+void Database::setSynchronous(const Synchronous aSynchronous) {
+  exec("PRAGMA synchronous = " + std::to_string(static_cast<int>(aSynchronous)));
+}
+
+Synchronous Database::getSynchronous() const {
+  return static_cast<Synchronous>(queryPragmaInt64("PRAGMA synchronous"));
+}
+
+void Database::setCacheSize(const long long aCacheSize) {
+  exec("PRAGMA cache_size = " + std::to_string(aCacheSize));
+}
+
+long long Database::getCacheSize() const {
+  return queryPragmaInt64("PRAGMA cache_size");
+}
+
+void Database::setMmapSize(const long long aMmapSize) {
+  exec("PRAGMA mmap_size = " + std::to_string(aMmapSize));
+}
+
+long long Database::getMmapSize() const {
+  return queryPragmaInt64("PRAGMA mmap_size");
+}
+
+void Database::setTempStore(const TempStore aTempStore) {
+  exec("PRAGMA temp_store = " + std::to_string(static_cast<int>(aTempStore)));
+}
+
+TempStore Database::getTempStore() const {
+  return static_cast<TempStore>(queryPragmaInt64("PRAGMA temp_store"));
+}
+
+void Database::setPageSize(const int aPageSize) {
+  exec("PRAGMA page_size = " + std::to_string(aPageSize));
+}
+
+int Database::getPageSize() const {
+  return static_cast<int>(queryPragmaInt64("PRAGMA page_size"));
+}
+
+void Database::setWalAutoCheckpoint(const int aPages) {
+  exec("PRAGMA wal_autocheckpoint = " + std::to_string(aPages));
+}
+
+int Database::getWalAutoCheckpoint() const {
+  return static_cast<int>(queryPragmaInt64("PRAGMA wal_autocheckpoint"));
+}
+
+// Return the first column of the first row returned by a PRAGMA (without a Statement, to keep the getters const)
+string Database::queryPragma(const char* apQuery) const {
+  sqlite3_stmt* pStmt = nullptr;
+  int ret = sqlite3_prepare_v2(mpSQLite, apQuery, -1, &pStmt, nullptr);
+  string value;
+  if (SQLITE_OK == ret) {
+    ret = sqlite3_step(pStmt);
+    if (SQLITE_ROW == ret) {
+      const unsigned char* pText = sqlite3_column_text(pStmt, 0);
+      value = pText ? reinterpret_cast<const char*>(pText) : "";
+      ret = SQLITE_OK;
+    } else if (SQLITE_DONE == ret) {
+      ret = SQLITE_OK;
+    }
+  }
+  sqlite3_finalize(pStmt);
+  check(ret);
+  return value;
+}
+
+// Return the integer value returned by a PRAGMA, throwing a SQLite::Exception if it is empty or not an integer
+long long Database::queryPragmaInt64(const char* apQuery) const {
+  const string value = queryPragma(apQuery);
+  char* pEnd = nullptr;
+  errno = 0;
+  const long long number = std::strtoll(value.c_str(), &pEnd, 10);
+  if (value.empty() || ('\0' != *pEnd) || (ERANGE == errno))
+    throw SQLite::Exception(string(apQuery) + " did not return an integer: '" + value + "'");
+  return number;
+}
+
 // Shortcut to execute one or multiple SQL statements without results (UPDATE, INSERT, ALTER, COMMIT, CREATE...).
 int Database::exec(string const &queries) {
-  const int ret = sqlite3_exec(mpSQLite, queries.c_str(), nullptr, nullptr, nullptr);
+  const int ret = execQueries(queries.c_str());
   check(ret);
 
   // Return the number of rows modified by those SQL statements (INSERT, UPDATE or DELETE only)
   return sqlite3_changes(mpSQLite);
 }
 
+// Shortcut to execute one or multiple SQL statements without results, returning the result code instead of throwing.
+Expected<int> Database::tryExec(string const &aQueries) noexcept {
+  const int ret = execQueries(aQueries.c_str());
+  if (SQLITE_OK != ret)
+    return Expected<int>(Result(ret, mpSQLite));
+
+  return Expected<int>(sqlite3_changes(mpSQLite), Result(ret, mpSQLite));
+}
+
 // Shortcut to execute a one step query and fetch the first column of the result.
 // WARNING: Be very careful with this dangerous method: you have to
 // make a COPY OF THE result, else it will be destroy before the next line
@@ -149,6 +423,45 @@ void Database::createFunction(string const &apFuncName,
   check(ret);
 }
 
+// Create or redefine an aggregate window SQL function.
+void Database::createWindowFunction(const std::string& aFuncName,
+                                    int                aNbArg,
+                                    bool               abDeterministic,
+                                    void*              apApp,
+                                    void             (*apStep)(sqlite3_context *, int, sqlite3_value **),
+                                    void             (*apFinal)(sqlite3_context *),   // NOLINT(readability/casting)
+                                    void             (*apValue)(sqlite3_context *),   // NOLINT(readability/casting)
+                                    void             (*apInverse)(sqlite3_context *, int, sqlite3_value **),
+                                    void             (*apDestroy)(void *))
+{
+#if SQLITE_VERSION_NUMBER >= 3025000 // SQLite 3.25.0 (2018-09-15)
+  int TextRep = SQLITE_UTF8;
+  if (abDeterministic) {
+      TextRep = TextRep|SQLITE_DETERMINISTIC;
+  }
+  const int ret = sqlite3_create_window_function(mpSQLite, aFuncName.c_str(), aNbArg, TextRep,
+                                                 apApp, apStep, apFinal, apValue, apInverse, apDestroy);
+  check(ret);
+#else
+  // Unused
+  (void)aNbArg; (void)abDeterministic; (void)apStep; (void)apFinal; (void)apValue; (void)apInverse;
+  if (apDestroy) {
+      apDestroy(apApp);
+  }
+  throw SQLite::Exception("window functions require SQLite 3.25.0 or later: " + aFuncName);
+#endif
+}
+
+// Create the table-valued function reading an array bound with Statement::bindArray().
+void Database::createArrayFunction(const std::string& aFuncName /* = "carray" */)
+{
+#if SQLITE_VERSION_NUMBER >= 3020000 // SQLite 3.20.0 (2017-08-01)
+  check(detail::createArrayModule(mpSQLite, aFuncName.c_str()));
+#else
+  throw SQLite::Exception("array functions require SQLite 3.20.0 or later: " + aFuncName);
+#endif
+}
+
 // Load an extension into the sqlite database. Only affects the current connection.
 // Parameter details can be found here: http://www.sqlite.org/c3ref/load_extension.html
 void Database::loadExtension(string const &apExtensionName, string const &apEntryPointName) {
@@ -230,6 +543,766 @@ bool Database::isUnencrypted(const std::string& aFilename)
     throw exception;
 }
 
+// Install a sink called with the SQL text, elapsed time and row count of each statement run on this connection.
+void Database::setTraceSink(TraceSink aSink, bool abExpandSql /* = false */) {
+  if (!aSink) {
+    const int ret = sqlite3_trace_v2(mpSQLite, 0, nullptr, nullptr);
+    mpTracer.reset();
+    check(ret);
+    return;
+  }
+
+  unique_ptr<Tracer> pTracer{new Tracer{std::move(aSink), abExpandSql, {}}};
+
+  auto callback = [](unsigned aEvent, void* apContext, void* apStmt, void* apData) -> int {
+    Tracer& tracer = *static_cast<Tracer*>(apContext);
+    sqlite3_stmt* pStmt = static_cast<sqlite3_stmt*>(apStmt);
+
+    switch (aEvent) {
+    case SQLITE_TRACE_STMT:
+      // Also reported at the start of each trigger, with a "-- comment" instead of the SQL text
+      if (0 != strncmp(static_cast<const char*>(apData), "--", 2))
+        tracer.rows[pStmt] = 0;
+      break;
+    case SQLITE_TRACE_ROW:
+      ++tracer.rows[pStmt];
+      break;
+    case SQLITE_TRACE_PROFILE: {
+      TraceEvent event{string{}, *static_cast<sqlite3_int64*>(apData), 0};
+      const auto iRows = tracer.rows.find(pStmt);
+      if (iRows != tracer.rows.end()) {
+        event.rows = iRows->second;
+        tracer.rows.erase(iRows);
+      }
+
+      char* pExpanded = tracer.bExpandSql ? sqlite3_expanded_sql(pStmt) : nullptr;
+      if (nullptr != pExpanded) {
+        event.sql = pExpanded;
+        sqlite3_free(pExpanded);
+      } else {
+        const char* pSql = sqlite3_sql(pStmt);
+        event.sql = pSql ? pSql : "";
+      }
+
+      try {
+        tracer.sink(event);
+      } catch (...) {
+        // Never let an exception propagate through the SQLite library
+      }
+      break;
+    }
+    default:
+      break;
+    }
+    return 0;
+  };
+
+  const int ret = sqlite3_trace_v2(mpSQLite, SQLITE_TRACE_STMT | SQLITE_TRACE_ROW | SQLITE_TRACE_PROFILE,
+                                   callback, pTracer.get());
+  check(ret);
+  mpTracer = std::move(pTracer); // replaces (and frees) the previous tracer only once it is no longer registered
+}
+
+// Return the runtime counters of all the live prepared statements of this connection, summed per SQL text.
+map<string, StatementStatus> Database::getStatementStatus(bool abReset /* = false */) const {
+  map<string, StatementStatus> statuses;
+  for (sqlite3_stmt* pStmt = sqlite3_next_stmt(mpSQLite, nullptr); nullptr != pStmt;
+       pStmt = sqlite3_next_stmt(mpSQLite, pStmt)) {
+    const char* pSql = sqlite3_sql(pStmt);
+    statuses[pSql ? pSql : ""] += Statement::getStatus(pStmt, abReset);
+  }
+  return statuses;
+}
+
+// Return a snapshot of the page cache and memory statistics of this connection.
+DatabaseStatus Database::getStatus(bool abReset /* = false */) const {
+  const int reset = abReset ? 1 : 0;
+  DatabaseStatus status;
+
+  // Read one sqlite3_db_status() value, either the current value or the highwater mark
+  auto read = [this, reset](int aOp, bool abHighwater, long long& aValue) {
+    int current = 0;
+    int highwater = 0;
+    const int ret = sqlite3_db_status(mpSQLite, aOp, &current, &highwater, reset);
+    if (SQLITE_OK != ret)
+      throw SQLite::Exception(sqlite3_errstr(ret));
+    aValue = abHighwater ? highwater : current;
+  };
+
+  read(SQLITE_DBSTATUS_CACHE_HIT, false, status.cacheHit);
+  read(SQLITE_DBSTATUS_CACHE_MISS, false, status.cacheMiss);
+  read(SQLITE_DBSTATUS_CACHE_WRITE, false, status.cacheWrite);
+#ifdef SQLITE_DBSTATUS_CACHE_SPILL // Since SQLite 3.23
+  read(SQLITE_DBSTATUS_CACHE_SPILL, false, status.cacheSpill);
+#endif
+  read(SQLITE_DBSTATUS_CACHE_USED, false, status.cacheUsed);
+  read(SQLITE_DBSTATUS_LOOKASIDE_USED, false, status.lookasideUsed);
+  // Those three are only reported as highwater marks
+  read(SQLITE_DBSTATUS_LOOKASIDE_HIT, true, status.lookasideHit);
+  read(SQLITE_DBSTATUS_LOOKASIDE_MISS_SIZE, true, status.lookasideMissSize);
+  read(SQLITE_DBSTATUS_LOOKASIDE_MISS_FULL, true, status.lookasideMissFull);
+  read(SQLITE_DBSTATUS_SCHEMA_USED, false, status.schemaUsed);
+  read(SQLITE_DBSTATUS_STMT_USED, false, status.stmtUsed);
+  return status;
+}
+
+namespace {
+
+// Skip the spaces and the comments at the start of a SQL text
+const char* skipSpaces(const char* apSql) noexcept {
+  for (;;) {
+    while (isspace(static_cast<unsigned char>(*apSql)))
+      ++apSql;
+    if (('-' == apSql[0]) && ('-' == apSql[1])) {
+      while (*apSql && ('\n' != *apSql))
+        ++apSql;
+    } else if (('/' == apSql[0]) && ('*' == apSql[1])) {
+      const char* pEnd = strstr(apSql + 2, "*/");
+      apSql = pEnd ? pEnd + 2 : apSql + strlen(apSql);
+    } else {
+      return apSql;
+    }
+  }
+}
+
+// Read the next keyword or name of a SQL text, unquoted; abQuoted tells a quoted name from a keyword
+string readToken(const char*& apSql, bool& abQuoted) {
+  apSql = skipSpaces(apSql);
+  string token;
+  const char open = *apSql;
+  const char close = ('[' == open) ? ']' : open;
+  abQuoted = ('"' == open) || ('\'' == open) || ('`' == open) || ('[' == open);
+  if (abQuoted) {
+    for (++apSql; *apSql; ++apSql) {
+      if (close == *apSql) {
+        if (('[' == open) || (close != apSql[1])) {
+          ++apSql;
+          break;
+        }
+        ++apSql; // doubled quote
+      }
+      token += *apSql;
+    }
+  } else {
+    for (; isalnum(static_cast<unsigned char>(*apSql)) || ('_' == *apSql) || ('$' == *apSql) || (*apSql & 0x80); ++apSql)
+      token += *apSql;
+  }
+  return token;
+}
+
+// Return the quoted [schema.]table of the FROM clause aliased as aAlias ("FROM big AS x", "JOIN big x"), empty if not found
+string findAliasedTable(const char* apSql, const string& aAlias) {
+  bool bInFrom = false; // a comma separates tables only in a FROM clause, and columns elsewhere
+  bool bTable = false;  // the next name is a table: it follows FROM, JOIN, or a comma of a FROM clause
+  bool bQuoted = false;
+  while (*(apSql = skipSpaces(apSql))) {
+    const string token = readToken(apSql, bQuoted);
+    if (token.empty() && !bQuoted) {
+      const char c = *apSql++; // punctuation, or the parenthesis of a subquery
+      bTable = bInFrom && (',' == c);
+      if (';' == c)
+        bInFrom = false;
+      continue;
+    }
+    const bool bKeyword = !bQuoted;
+    if (bKeyword && (0 == sqlite3_stricmp(token.c_str(), "FROM"))) {
+      bInFrom = bTable = true;
+      continue;
+    }
+    if (bKeyword && (0 == sqlite3_stricmp(token.c_str(), "JOIN"))) {
+      bTable = true;
+      continue;
+    }
+    if (bKeyword) {
+      for (const char* pEnd : {"WHERE", "GROUP", "HAVING", "ORDER", "LIMIT", "WINDOW", "ON", "USING", "SELECT", "VALUES"}) {
+        if (0 == sqlite3_stricmp(token.c_str(), pEnd))
+          bInFrom = false;
+      }
+    }
+    if (!bTable)
+      continue;
+    bTable = false;
+
+    // [schema.]table [[AS] alias], the alias being left to the next iterations if it does not match
+    string table = detail::quoteIdentifier(token);
+    const char* pNext = skipSpaces(apSql);
+    if ('.' == *pNext) {
+      ++pNext;
+      table += '.' + detail::quoteIdentifier(readToken(pNext, bQuoted));
+      apSql = pNext;
+    }
+    string alias = readToken(pNext, bQuoted);
+    if (!bQuoted && (0 == sqlite3_stricmp(alias.c_str(), "AS")))
+      alias = readToken(pNext, bQuoted);
+    if (!alias.empty() && (0 == sqlite3_stricmp(alias.c_str(), aAlias.c_str())))
+      return table;
+  }
+  return "";
+}
+
+} // namespace
+
+// Opt-in debug mode checking the query plan of each Statement newly prepared on this connection.
+void Database::setPlanCheck(QueryPlanCallback aCallback, long long aMinTableRows /* = 0 */) {
+  if (aCallback)
+    mpPlanChecker.reset(new PlanChecker{std::move(aCallback), aMinTableRows, {}});
+  else
+    mpPlanChecker.reset();
+}
+
+// Check the query plan of a newly prepared statement
+void Database::checkPlan(const Statement& aStatement) {
+  QueryPlan plan;
+  try {
+    plan = aStatement.explainPlan();
+  } catch (SQLite::Exception&) {
+    return; // Some statements cannot be explained, like an EXPLAIN
+  }
+
+  PlanChecker& checker = *mpPlanChecker;
+
+  // Return the number of rows of a quoted table, counted on first use, -1 if it is not a table (subquery, view...)
+  auto countRows = [this, &checker](const string& aTable) -> long long {
+    const auto iRows = checker.tableRows.find(aTable);
+    if (iRows != checker.tableRows.end())
+      return iRows->second;
+
+    const string count = "SELECT count(*) FROM " + aTable;
+
+    long long rows = -1;
+    sqlite3_stmt* pStmt = nullptr;
+    if (SQLITE_OK == sqlite3_prepare_v2(mpSQLite, count.c_str(), -1, &pStmt, nullptr) &&
+        SQLITE_ROW == sqlite3_step(pStmt))
+      rows = sqlite3_column_int64(pStmt, 0);
+    sqlite3_finalize(pStmt);
+
+    checker.tableRows[aTable] = rows;
+    return rows;
+  };
+
+  // Walk the plan tree depth-first, in plan order
+  function<void(const QueryPlan&)> check = [&](const QueryPlan& aNodes) {
+    for (const QueryPlanNode& node : aNodes) {
+      if (node.isScan()) {
+        const string table = node.getTable();
+        long long rows = -1;
+        if (checker.minTableRows > 0) {
+          // The plan names the alias of a table ("SCAN x" for "FROM big AS x"), which is the table itself if not aliased
+          const string aliased = findAliasedTable(aStatement.getQuery().c_str(), table);
+          rows = countRows(aliased.empty() ? detail::quoteIdentifier(table) : aliased);
+        }
+        // Scans of tables of unknown size are reported, rather than silently dropped
+        if ((checker.minTableRows <= 0) || (rows < 0) || (rows >= checker.minTableRows))
+          checker.callback(QueryPlanWarning{QueryPlanWarning::FULL_SCAN, aStatement.getQuery(), node.detail, table, rows});
+      }
+      if (node.isTempBTree())
+        checker.callback(QueryPlanWarning{QueryPlanWarning::TEMP_BTREE, aStatement.getQuery(), node.detail, "", -1});
+      check(node.children);
+    }
+  };
+  check(plan);
+}
+
+namespace {
+
+#ifdef SQLITE_ENABLE_PREUPDATE_HOOK
+// Read the value of a column given by sqlite3_preupdate_old() or sqlite3_preupdate_new()
+ChangeValue toChangeValue(sqlite3_value* apValue) {
+  switch (sqlite3_value_type(apValue)) {
+  case SQLITE_INTEGER:
+    return sqlite3_value_int64(apValue);
+  case SQLITE_FLOAT:
+    return sqlite3_value_double(apValue);
+  case SQLITE_TEXT: {
+    const char* pText = reinterpret_cast<const char*>(sqlite3_value_text(apValue));
+    return string(pText, static_cast<size_t>(sqlite3_value_bytes(apValue)));
+  }
+  case SQLITE_BLOB: {
+    const unsigned char* pData = static_cast<const unsigned char*>(sqlite3_value_blob(apValue));
+    return vector<unsigned char>(pData, pData + sqlite3_value_bytes(apValue));
+  }
+  default:
+    return monostate();
+  }
+}
+#endif // SQLITE_ENABLE_PREUPDATE_HOOK
+
+ChangeType toChangeType(int aOperation) noexcept {
+  switch (aOperation) {
+  case SQLITE_INSERT: return ChangeType::Insert;
+  case SQLITE_UPDATE: return ChangeType::Update;
+  default:            return ChangeType::Delete;
+  }
+}
+
+/// Statements changing the savepoints, see parseSavepoint()
+enum class SavepointOperation {
+  None,       ///< Any other statement
+  Savepoint,  ///< SAVEPOINT name
+  Release,    ///< RELEASE [SAVEPOINT] name
+  RollbackTo  ///< ROLLBACK [TRANSACTION] TO [SAVEPOINT] name
+};
+
+// Tell whether a SQL statement opens, releases or rolls back to a savepoint, and read its name
+SavepointOperation parseSavepoint(const char* apSql, string& aName) {
+  bool bQuoted = false;
+  const auto isKeyword = [&](const string& aToken, const char* apKeyword) {
+    return !bQuoted && (0 == sqlite3_stricmp(aToken.c_str(), apKeyword));
+  };
+  // the name of a savepoint may also be a keyword: "RELEASE savepoint" releases the savepoint named "savepoint"
+  const auto readName = [&]() {
+    aName = readToken(apSql, bQuoted);
+    if (isKeyword(aName, "SAVEPOINT")) {
+      const char* pNext = apSql;
+      bool bNextQuoted = false;
+      string next = readToken(pNext, bNextQuoted);
+      if (!next.empty()) {
+        aName = std::move(next);
+        apSql = pNext;
+      }
+    }
+  };
+
+  string token = readToken(apSql, bQuoted);
+  if (isKeyword(token, "SAVEPOINT")) {
+    aName = readToken(apSql, bQuoted);
+    return SavepointOperation::Savepoint;
+  }
+  if (isKeyword(token, "RELEASE")) {
+    readName();
+    return SavepointOperation::Release;
+  }
+  if (isKeyword(token, "ROLLBACK")) {
+    token = readToken(apSql, bQuoted);
+    if (isKeyword(token, "TRANSACTION"))
+      token = readToken(apSql, bQuoted);
+    if (isKeyword(token, "TO")) {
+      readName();
+      return SavepointOperation::RollbackTo;
+    }
+  }
+  return SavepointOperation::None;
+}
+
+} // namespace
+
+// Install a sink receiving the rows changed by each transaction, in one batch after its successful commit.
+void Database::setChangeSink(ChangeSink aSink, bool abValues /* = false */) {
+#ifndef SQLITE_ENABLE_PREUPDATE_HOOK
+  if (aSink && abValues)
+    throw SQLite::Exception("Capturing the values of the changes requires SQLITE_ENABLE_PREUPDATE_HOOK");
+#endif
+  // SQLite has a single preupdate hook per connection: do not take it over from the sessions
+  if (aSink && abValues && (mSessionCount > 0))
+    throw SQLite::Exception("Cannot capture the values of the changes while a Session records the connection");
+
+  if (aSink) {
+    unique_ptr<ChangeCapture> capture{new ChangeCapture()};
+    capture->sink = std::move(aSink);
+    capture->bValues = abValues;
+    mpChangeCapture = std::move(capture);
+  } else {
+    mpChangeCapture.reset();
+  }
+  installHooks();
+}
+
+// (Un)register the hooks shared by the change capture and the result cache (SQLite allows only one of each)
+void Database::installHooks() noexcept {
+  ChangeCapture* pCapture = mpChangeCapture.get();
+  const bool bValues = pCapture && pCapture->bValues;
+
+#ifdef SQLITE_ENABLE_PREUPDATE_HOOK
+  if (bValues) {
+    sqlite3_preupdate_hook(mpSQLite, [](void* apContext, sqlite3* apSQLite, int aOperation, const char* apDatabase,
+                                        const char* apTable, sqlite3_int64 aOldRowid, sqlite3_int64 aNewRowid) {
+      ChangeCapture& capture = *static_cast<ChangeCapture*>(apContext);
+      RowChange change{toChangeType(aOperation), apDatabase, apTable,
+                       (SQLITE_DELETE == aOperation) ? aOldRowid : aNewRowid, aOldRowid, {}, {}};
+      const int count = sqlite3_preupdate_count(apSQLite);
+      for (int i = 0; i < count; ++i) {
+        sqlite3_value* pValue = nullptr;
+        if ((SQLITE_INSERT != aOperation) && (SQLITE_OK == sqlite3_preupdate_old(apSQLite, i, &pValue)))
+          change.oldValues.push_back(toChangeValue(pValue));
+        if ((SQLITE_DELETE != aOperation) && (SQLITE_OK == sqlite3_preupdate_new(apSQLite, i, &pValue)))
+          change.newValues.push_back(toChangeValue(pValue));
+      }
+      capture.changes.push_back(std::move(change));
+    }, pCapture);
+    mbPreupdateHook = true;
+  } else if (mbPreupdateHook) {
+    // only remove the hook installed here, not the one of a Session
+    sqlite3_preupdate_hook(mpSQLite, nullptr, nullptr);
+    mbPreupdateHook = false;
+  }
+#endif
+
+  if ((pCapture && !bValues) || mpResultCache) {
+    sqlite3_update_hook(mpSQLite, [](void* apDatabase, int aOperation, const char* apDbName, const char* apTable,
+                                     sqlite3_int64 aRowid) {
+      Database& database = *static_cast<Database*>(apDatabase);
+      if (database.mpChangeCapture && !database.mpChangeCapture->bValues)
+        database.mpChangeCapture->changes.push_back(RowChange{toChangeType(aOperation), apDbName, apTable,
+                                                              aRowid, aRowid, {}, {}});
+      if (database.mpResultCache)
+        database.mpResultCache->invalidate(apTable);
+    }, this);
+  } else {
+    sqlite3_update_hook(mpSQLite, nullptr, nullptr);
+  }
+
+  // The commit is not done yet when the commit hook is called: it may still fail (SQLITE_BUSY),
+  // so the changes are only delivered once the statement has returned, see deliverChanges()
+  if (pCapture) {
+    sqlite3_commit_hook(mpSQLite, [](void* apContext) -> int {
+      static_cast<ChangeCapture*>(apContext)->bCommitting = true;
+      return 0;
+    }, pCapture);
+  } else {
+    sqlite3_commit_hook(mpSQLite, nullptr, nullptr);
+  }
+
+  if (pCapture || mpResultCache) {
+    sqlite3_rollback_hook(mpSQLite, [](void* apDatabase) {
+      Database& database = *static_cast<Database*>(apDatabase);
+      if (database.mpChangeCapture) {
+        database.mpChangeCapture->changes.clear();
+        database.mpChangeCapture->savepoints.clear();
+        database.mpChangeCapture->bCommitting = false;
+      }
+      if (database.mpResultCache) // results read since the first change of the transaction may be rolled back
+        database.mpResultCache->clear(true);
+    }, this);
+  } else {
+    sqlite3_rollback_hook(mpSQLite, nullptr, nullptr);
+  }
+}
+
+// true if SQLiteCpp was built with SQLITE_ENABLE_PREUPDATE_HOOK
+bool Database::hasPreupdateHook() noexcept {
+#ifdef SQLITE_ENABLE_PREUPDATE_HOOK
+  return true;
+#else
+  return false;
+#endif
+}
+
+// Return the number of changes buffered, marking the start of a statement
+size_t Database::getChangesMark() const noexcept {
+  return mpChangeCapture ? mpChangeCapture->changes.size() : 0;
+}
+
+// Discard the changes undone by a failed statement or by a ROLLBACK TO, and keep track of the savepoints
+void Database::onCapturedStatement(sqlite3_stmt* apStmt, const int aRet, const size_t aMark) noexcept {
+  ChangeCapture& capture = *mpChangeCapture;
+  if (0 != sqlite3_get_autocommit(mpSQLite)) {
+    capture.savepoints.clear(); // committed or rolled back: the changes are delivered or discarded
+    return;
+  }
+
+  if ((SQLITE_ROW != aRet) && (SQLITE_DONE != aRet)) {
+    // A failed statement is rolled back, but not its transaction: its changes are undone, unless its conflict
+    // resolution is FAIL, which keeps the rows changed before the error (and then reports them in sqlite3_changes())
+    if ((aMark < capture.changes.size()) && (0 == sqlite3_changes(mpSQLite)))
+      capture.changes.resize(aMark);
+    return;
+  }
+
+  if (SQLITE_DONE != aRet)
+    return;
+  string name;
+  const SavepointOperation operation = parseSavepoint(sqlite3_sql(apStmt), name);
+  if (SavepointOperation::Savepoint == operation) {
+    capture.savepoints.emplace_back(std::move(name), capture.changes.size());
+  } else if (SavepointOperation::None != operation) {
+    // the innermost savepoint of this name (case insensitive), and all the savepoints opened after it
+    auto found = capture.savepoints.end();
+    while ((found != capture.savepoints.begin()) && (0 != sqlite3_stricmp((found - 1)->first.c_str(), name.c_str())))
+      --found;
+    if (found == capture.savepoints.begin())
+      return;
+    --found;
+    if (SavepointOperation::RollbackTo == operation) {
+      capture.changes.resize(std::min(found->second, capture.changes.size()));
+      ++found; // ROLLBACK TO keeps the savepoint open
+    }
+    capture.savepoints.erase(found, capture.savepoints.end());
+  }
+}
+
+// Run one or more SQL statements like sqlite3_exec(), but one by one when capturing changes, to tell their changes apart
+int Database::execQueries(const char* apQueries) noexcept {
+  if (!mpChangeCapture) {
+    const int ret = sqlite3_exec(mpSQLite, apQueries, nullptr, nullptr, nullptr);
+    onStatementEnd();
+    return ret;
+  }
+
+  int ret = SQLITE_OK;
+  const char* pTail = apQueries;
+  while ((SQLITE_OK == ret) && pTail && *pTail) {
+    sqlite3_stmt* pStmt = nullptr;
+    ret = sqlite3_prepare_v2(mpSQLite, pTail, -1, &pStmt, &pTail);
+    if (nullptr == pStmt)
+      continue; // error, or only spaces and comments left
+    const size_t mark = getChangesMark();
+    int stepRet;
+    do {
+      stepRet = sqlite3_step(pStmt);
+    } while (SQLITE_ROW == stepRet);
+    if (mpChangeCapture) // the sink may have been removed by a function
+      onCapturedStatement(pStmt, stepRet, mark);
+    // sqlite3_finalize() returns the error of the step, and keeps its message for check()
+    ret = sqlite3_finalize(pStmt);
+    onStatementEnd();
+  }
+  return ret;
+}
+
+// Deliver the buffered changes if the last statement committed a transaction
+void Database::deliverChanges() noexcept {
+  ChangeCapture& capture = *mpChangeCapture;
+  if (!capture.bCommitting)
+    return;
+  capture.bCommitting = false;
+
+  // Still in a transaction: the commit failed (SQLITE_BUSY), and the changes await the commit retried
+  if (0 == sqlite3_get_autocommit(mpSQLite))
+    return;
+
+  vector<RowChange> changes;
+  changes.swap(capture.changes);
+  if (changes.empty())
+    return;
+  try {
+    capture.sink(changes);
+  } catch (...) {
+    // Never throw from a statement that succeeded: the transaction is already committed
+  }
+}
+
+namespace {
+
+/// Append the bound values to the key of a cached query, with their type and size, so that equal keys mean equal values
+void appendCacheKey(string& aKey, const vector<ChangeValue>& aValues) {
+  for (const ChangeValue& value : aValues) {
+    aKey.push_back(static_cast<char>('0' + value.index()));
+    if (const long long* pInteger = std::get_if<long long>(&value)) {
+      aKey.append(reinterpret_cast<const char*>(pInteger), sizeof(*pInteger));
+    } else if (const double* pReal = std::get_if<double>(&value)) {
+      aKey.append(reinterpret_cast<const char*>(pReal), sizeof(*pReal));
+    } else {
+      const string* pText = std::get_if<string>(&value);
+      const vector<unsigned char>* pBlob = std::get_if<vector<unsigned char>>(&value);
+      const size_t size = pText ? pText->size() : (pBlob ? pBlob->size() : 0);
+      aKey.append(reinterpret_cast<const char*>(&size), sizeof(size));
+      if (pText)
+        aKey.append(*pText);
+      else if (pBlob)
+        aKey.append(reinterpret_cast<const char*>(pBlob->data()), pBlob->size());
+    }
+  }
+}
+
+/// Bind the value to the parameter aIndex of the statement
+int bindValue(sqlite3_stmt* apStmt, const int aIndex, const ChangeValue& aValue) {
+  if (const long long* pInteger = std::get_if<long long>(&aValue))
+    return sqlite3_bind_int64(apStmt, aIndex, *pInteger);
+  if (const double* pReal = std::get_if<double>(&aValue))
+    return sqlite3_bind_double(apStmt, aIndex, *pReal);
+  if (const string* pText = std::get_if<string>(&aValue))
+    return sqlite3_bind_text(apStmt, aIndex, pText->data(), static_cast<int>(pText->size()), SQLITE_STATIC);
+  if (const vector<unsigned char>* pBlob = std::get_if<vector<unsigned char>>(&aValue))
+    return sqlite3_bind_blob(apStmt, aIndex, pBlob->data(), static_cast<int>(pBlob->size()), SQLITE_STATIC);
+  return sqlite3_bind_null(apStmt, aIndex);
+}
+
+} // namespace
+
+// Enable the cache of the results of queryCached(), or disable and empty it
+void Database::setResultCache(const size_t aMaxBytes) {
+  if (0 == aMaxBytes) {
+    if (mpResultCache) {
+      sqlite3_set_authorizer(mpSQLite, nullptr, nullptr);
+      mpResultCache.reset();
+      installHooks();
+    }
+    return;
+  }
+  if (mpResultCache) {
+    mpResultCache->maxBytes = aMaxBytes;
+    mpResultCache->evict(0);
+    return;
+  }
+
+  mpResultCache.reset(new ResultCache());
+  mpResultCache->maxBytes = aMaxBytes;
+  // The authorizer sees each statement when it is prepared: the tables read by a cached query,
+  // the DELETE to report row by row, and the schema changes
+  const int ret = sqlite3_set_authorizer(mpSQLite, [](void* apDatabase, int aAction, const char* apArg1,
+                                                      const char*, const char*, const char*) -> int {
+    ResultCache& cache = *static_cast<Database*>(apDatabase)->mpResultCache;
+    const int previousAction = cache.lastAction;
+    cache.lastAction = aAction;
+    switch (aAction) {
+    case SQLITE_READ:
+      if (cache.pTablesRead && apArg1)
+        cache.pTablesRead->push_back(apArg1);
+      break;
+    case SQLITE_DELETE:
+      // Disable the truncate optimization of "DELETE FROM table", which bypasses the update hook.
+      // Not for the DELETE checked by DROP TABLE or VIEW (right after the DROP), nor for the schema:
+      // SQLITE_IGNORE would skip the DROP
+      if (apArg1 && (0 != sqlite3_strnicmp(apArg1, "sqlite_", 7)) && (SQLITE_DROP_TABLE != previousAction) &&
+          (SQLITE_DROP_TEMP_TABLE != previousAction) && (SQLITE_DROP_VIEW != previousAction) &&
+          (SQLITE_DROP_TEMP_VIEW != previousAction) && (SQLITE_DROP_VTABLE != previousAction))
+        return SQLITE_IGNORE;
+      break;
+    case SQLITE_DROP_VTABLE:
+    case SQLITE_DROP_TABLE:
+    case SQLITE_DROP_TEMP_TABLE:
+    case SQLITE_DROP_VIEW:
+    case SQLITE_DROP_TEMP_VIEW:
+    case SQLITE_ALTER_TABLE:
+    case SQLITE_DETACH:
+      cache.clear(true);
+      break;
+    default:
+      break;
+    }
+    return SQLITE_OK;
+  }, this);
+  if (SQLITE_OK != ret) {
+    mpResultCache.reset();
+    check(ret);
+  }
+  installHooks();
+}
+
+// Run a read-only query, or return its cached results
+shared_ptr<const ResultSet> Database::queryCached(const string& aQuery, const vector<ChangeValue>& aValues) {
+  string key;
+  if (mpResultCache) {
+    key.reserve(aQuery.size() + 1 + aValues.size() * 16);
+    key = aQuery;
+    key.push_back('\0');
+    appendCacheKey(key, aValues);
+    const auto found = mpResultCache->index.find(key);
+    if (found != mpResultCache->index.end()) {
+      ++mpResultCache->stats.hits;
+      mpResultCache->entries.splice(mpResultCache->entries.begin(), mpResultCache->entries, found->second);
+      onStatementEnd(); // a use of the connection, even without running the query
+      return found->second->result;
+    }
+    ++mpResultCache->stats.misses;
+  }
+
+  // Prepare the statement, recording the tables it reads
+  vector<string> tables;
+  sqlite3_stmt* pStmt = nullptr;
+  if (mpResultCache)
+    mpResultCache->pTablesRead = &tables;
+  int ret = sqlite3_prepare_v2(mpSQLite, aQuery.c_str(), static_cast<int>(aQuery.size()), &pStmt, nullptr);
+  if (mpResultCache)
+    mpResultCache->pTablesRead = nullptr;
+  check(ret);
+  const unique_ptr<sqlite3_stmt, int(*)(sqlite3_stmt*)> stmt(pStmt, sqlite3_finalize);
+
+  for (size_t i = 0; i < aValues.size(); ++i) {
+    ret = bindValue(pStmt, static_cast<int>(i) + 1, aValues[i]);
+    check(ret);
+  }
+
+  // Read all the rows into a compact ResultSet
+  shared_ptr<ResultSet> result = make_shared<ResultSet>();
+  const int columns = pStmt ? sqlite3_column_count(pStmt) : 0; // NULL statement for a comment only
+  for (int column = 0; column < columns; ++column)
+    result->mColumnNames.emplace_back(sqlite3_column_name(pStmt, column));
+  const size_t changesMark = getChangesMark();
+  while (pStmt && (SQLITE_ROW == (ret = sqlite3_step(pStmt)))) {
+    for (int column = 0; column < columns; ++column) {
+      ResultSet::Cell cell;
+      cell.type = sqlite3_column_type(pStmt, column);
+      cell.size = 0;
+      cell.integer = 0;
+      if (SQLITE_INTEGER == cell.type) {
+        cell.integer = sqlite3_column_int64(pStmt, column);
+      } else if (SQLITE_FLOAT == cell.type) {
+        cell.real = sqlite3_column_double(pStmt, column);
+      } else if ((SQLITE_TEXT == cell.type) || (SQLITE_BLOB == cell.type)) {
+        const char* pData = (SQLITE_TEXT == cell.type)
+                            ? reinterpret_cast<const char*>(sqlite3_column_text(pStmt, column))
+                            : static_cast<const char*>(sqlite3_column_blob(pStmt, column));
+        const size_t size = static_cast<size_t>(sqlite3_column_bytes(pStmt, column));
+        if (result->mData.size() + size > UINT32_MAX)
+          throw SQLite::Exception("Result of a cached query larger than 4 GiB");
+        cell.offset = static_cast<uint32_t>(result->mData.size());
+        cell.size = static_cast<uint32_t>(size);
+        result->mData.append(pData ? pData : "", size);
+      }
+      result->mCells.push_back(cell);
+    }
+  }
+  // Same end of statement as Statement and exec(): discard the changes of a failure, deliver them after a commit
+  if (pStmt && mpChangeCapture)
+    onCapturedStatement(pStmt, ret, changesMark);
+  onStatementEnd();
+  if (pStmt && (SQLITE_DONE != ret))
+    throw SQLite::Exception(mpSQLite);
+  result->mCells.shrink_to_fit();
+  result->mData.shrink_to_fit();
+
+  // Cache only the results of read-only statements
+  if (mpResultCache && pStmt && (0 != sqlite3_stmt_readonly(pStmt))) {
+    std::sort(tables.begin(), tables.end());
+    tables.erase(std::unique(tables.begin(), tables.end()), tables.end());
+    mpResultCache->insert(std::move(key), result, std::move(tables));
+  }
+  return result;
+}
+
+// Drop all the cached results
+void Database::clearResultCache() noexcept {
+  if (mpResultCache)
+    mpResultCache->clear(false);
+}
+
+// Return the counters of the result cache
+ResultCacheStats Database::getResultCacheStats() const noexcept {
+  if (!mpResultCache)
+    return ResultCacheStats();
+  ResultCacheStats stats = mpResultCache->stats;
+  stats.entries = mpResultCache->entries.size();
+  return stats;
+}
+
+// Throw the last error of the connection, as a SQLite::CancelledException if interrupted
+void Database::throwError(const int aRet) const {
+  if (SQLITE_INTERRUPT == (aRet & 0xFF))
+    throw SQLite::CancelledException("Statement interrupted: cancelled");
+  throw SQLite::Exception(mpSQLite);
+}
+
+// Interrupt the statements running on this connection, from any thread
+void Database::interrupt() noexcept {
+  sqlite3_interrupt(mpSQLite);
+}
+
+// Make the Statements wait for the table locks of a shared cache (the wait itself is done by Statement)
+void Database::setWaitForUnlock(const bool abWait) {
+  if (abWait && !hasUnlockNotify())
+    throw SQLite::Exception("Waiting for the locks of a shared cache requires SQLITE_ENABLE_UNLOCK_NOTIFY");
+  mbWaitForUnlock = abWait;
+}
+
+bool Database::hasUnlockNotify() noexcept {
+#ifdef SQLITE_ENABLE_UNLOCK_NOTIFY
+  return true;
+#else
+  return false;
+#endif
+}
+
 int Database::open(string const &fileName, int const flags, int const busyTimeoutMs, string const &vfs) {
   int result = sqlite3_open_v2(fileName.c_str(), &mpSQLite, flags, vfs.empty() ? nullptr : vfs.c_str());
 
@@ -237,6 +1310,8 @@ int Database::open(string const &fileName, int const flags, int const busyTimeou
     if (busyTimeoutMs > 0)
       setBusyTimeout(busyTimeoutMs);
 
+    onStatementEnd(); // first use
+    detail::registerDatabase(*this);
     return SQLITE_OK;
   } else {
     Exception exception(mpSQLite);
@@ -19,4 +19,21 @@ Exception::Exception(sqlite3* sqlite) :
 {
 }
 
+Exception::Exception(string const &message, int ret) :
+  runtime_error{message},
+  m_code{ret & 0xFF},
+  m_extendedCode{ret}
+{
+}
+
+TimeoutException::TimeoutException(string const &message) :
+  Exception{message, SQLITE_INTERRUPT}
+{
+}
+
+CancelledException::CancelledException(string const &message) :
+  Exception{message, SQLITE_INTERRUPT}
+{
+}
+
 } // SQLite
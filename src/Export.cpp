@@ -0,0 +1,275 @@
+#include <sqlite3.h>
+#include <SQLiteCpp/Export.h>
+#include <SQLiteCpp/Exception.h>
+#include <SQLiteCpp/Fields.h>
+#include <SQLiteCpp/Statement.h>
+
+#include <cerrno>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace SQLite {
+namespace {
+
+/// Size of the output buffer, written to the output each time it is full
+constexpr std::size_t BUFFER_SIZE = 1024 * 1024;
+
+/// Reusable output buffer, written by large chunks to an output stream or a file descriptor
+class OutputBuffer {
+public:
+  explicit OutputBuffer(std::ostream& aOutput) : mpOutput(&aOutput) {
+    mBuffer.reserve(BUFFER_SIZE + 64);
+  }
+  explicit OutputBuffer(int aFd) : mFd(aFd) {
+    mBuffer.reserve(BUFFER_SIZE + 64);
+  }
+
+  OutputBuffer(const OutputBuffer&) = delete;
+  OutputBuffer& operator=(const OutputBuffer&) = delete;
+
+  /// Text of the buffer, to append to
+  std::string& text() noexcept {
+    return mBuffer;
+  }
+
+  void append(char aChar) {
+    mBuffer.push_back(aChar);
+  }
+
+  void append(const char* apData, std::size_t aSize) {
+    mBuffer.append(apData, aSize);
+  }
+
+  void appendInteger(long long aValue) {
+    char digits[24];
+    const std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), aValue);
+    mBuffer.append(digits, result.ptr);
+  }
+
+  /// Shortest representation reading back to the same double
+  void appendDouble(double aValue) {
+    char digits[32];
+    const std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), aValue);
+    mBuffer.append(digits, result.ptr);
+  }
+
+  /// End of a record: write the buffer if it is full
+  void endRecord() {
+    mBuffer.push_back('\n');
+    if (mBuffer.size() >= BUFFER_SIZE)
+      flush();
+  }
+
+  void flush() {
+    if (mpOutput) {
+      mpOutput->write(mBuffer.data(), static_cast<std::streamsize>(mBuffer.size()));
+      if (!*mpOutput)
+        throw SQLite::Exception("Cannot write to the output stream");
+    } else {
+      const char* pData = mBuffer.data();
+      std::size_t size = mBuffer.size();
+      while (size > 0) {
+#ifdef _WIN32
+        const int written = ::_write(mFd, pData, static_cast<unsigned>(size));
+#else
+        const ssize_t written = ::write(mFd, pData, size);
+#endif
+        if (written < 0) {
+          if (EINTR == errno)
+            continue;
+          throw SQLite::Exception(std::string("Cannot write to the file descriptor: ") + std::strerror(errno));
+        }
+        pData += written;
+        size -= static_cast<std::size_t>(written);
+      }
+    }
+    mBuffer.clear();
+  }
+
+private:
+  std::ostream* mpOutput = nullptr;
+  int           mFd = -1;
+  std::string   mBuffer;
+};
+
+/// Append a CSV field, quoted only if it contains the delimiter, the quote, CR or LF
+void appendCsvField(std::string& aOutput, std::string_view aValue, const CsvOptions& aOptions) {
+  const char special[] = {aOptions.delimiter, aOptions.quote, '\r', '\n'};
+  if (std::string_view::npos == aValue.find_first_of(special, 0, sizeof(special))) {
+    aOutput.append(aValue.data(), aValue.size());
+    return;
+  }
+  aOutput.push_back(aOptions.quote);
+  std::size_t start = 0;
+  for (std::size_t quote = aValue.find(aOptions.quote); std::string_view::npos != quote;
+       quote = aValue.find(aOptions.quote, start)) {
+    aOutput.append(aValue.data() + start, quote + 1 - start);
+    aOutput.push_back(aOptions.quote);
+    start = quote + 1;
+  }
+  aOutput.append(aValue.data() + start, aValue.size() - start);
+  aOutput.push_back(aOptions.quote);
+}
+
+const char HEX[] = "0123456789abcdef";
+
+/// Append a JSON string, with the quotes, backslashes and control characters escaped
+void appendJsonString(std::string& aOutput, std::string_view aValue) {
+  aOutput.push_back('"');
+  std::size_t start = 0;
+  for (std::size_t i = 0; i < aValue.size(); ++i) {
+    const unsigned char c = static_cast<unsigned char>(aValue[i]);
+    if ((c >= 0x20) && ('"' != c) && ('\\' != c))
+      continue;
+    aOutput.append(aValue.data() + start, i - start);
+    start = i + 1;
+    switch (c) {
+    case '"':   aOutput.append("\\\"", 2); break;
+    case '\\':  aOutput.append("\\\\", 2); break;
+    case '\n':  aOutput.append("\\n", 2); break;
+    case '\r':  aOutput.append("\\r", 2); break;
+    case '\t':  aOutput.append("\\t", 2); break;
+    case '\b':  aOutput.append("\\b", 2); break;
+    case '\f':  aOutput.append("\\f", 2); break;
+    default: {
+      const char escape[] = {'\\', 'u', '0', '0', HEX[c >> 4], HEX[c & 0xF]};
+      aOutput.append(escape, sizeof(escape));
+    }
+    }
+  }
+  aOutput.append(aValue.data() + start, aValue.size() - start);
+  aOutput.push_back('"');
+}
+
+long long writeCsv(Statement& aStatement, OutputBuffer& aBuffer, const CsvOptions& aOptions) {
+  const int columnCount = aStatement.getColumnCount();
+  if (aOptions.bHeader) {
+    for (int i = 0; i < columnCount; ++i) {
+      if (i > 0)
+        aBuffer.append(aOptions.delimiter);
+      appendCsvField(aBuffer.text(), aStatement.getColumnName(i), aOptions);
+    }
+    aBuffer.endRecord();
+  }
+
+  long long rows = 0;
+  while (aStatement.executeStep()) {
+    for (int i = 0; i < columnCount; ++i) {
+      if (i > 0)
+        aBuffer.append(aOptions.delimiter);
+      switch (detail::StatementReader::getType(aStatement, i)) {
+      case SQLITE_INTEGER:
+        aBuffer.appendInteger(detail::StatementReader::getInt64(aStatement, i));
+        break;
+      case SQLITE_FLOAT:
+        aBuffer.appendDouble(detail::StatementReader::getDouble(aStatement, i));
+        break;
+      case SQLITE_TEXT:
+        appendCsvField(aBuffer.text(), detail::StatementReader::getText(aStatement, i), aOptions);
+        break;
+      case SQLITE_BLOB: {
+        const Blob blob = detail::StatementReader::getBlob(aStatement, i);
+        appendCsvField(aBuffer.text(), std::string_view(reinterpret_cast<const char*>(blob.data()), blob.size()), aOptions);
+        break;
+      }
+      default: // NULL: empty field
+        break;
+      }
+    }
+    aBuffer.endRecord();
+    ++rows;
+  }
+  aBuffer.flush();
+  return rows;
+}
+
+long long writeJsonLines(Statement& aStatement, OutputBuffer& aBuffer) {
+  const int columnCount = aStatement.getColumnCount();
+
+  // the keys are escaped only once: {"name1":, ,"name2":, ...
+  std::vector<std::string> keys(static_cast<std::size_t>(columnCount));
+  for (int i = 0; i < columnCount; ++i) {
+    std::string& key = keys[static_cast<std::size_t>(i)];
+    key.assign((0 == i) ? "{" : ",");
+    appendJsonString(key, aStatement.getColumnName(i));
+    key.push_back(':');
+  }
+
+  long long rows = 0;
+  while (aStatement.executeStep()) {
+    if (0 == columnCount)
+      aBuffer.append('{');
+    for (int i = 0; i < columnCount; ++i) {
+      aBuffer.text() += keys[static_cast<std::size_t>(i)];
+      switch (detail::StatementReader::getType(aStatement, i)) {
+      case SQLITE_INTEGER:
+        aBuffer.appendInteger(detail::StatementReader::getInt64(aStatement, i));
+        break;
+      case SQLITE_FLOAT: {
+        const double value = detail::StatementReader::getDouble(aStatement, i);
+        if (std::isfinite(value))
+          aBuffer.appendDouble(value);
+        else
+          aBuffer.append("null", 4);
+        break;
+      }
+      case SQLITE_TEXT:
+        appendJsonString(aBuffer.text(), detail::StatementReader::getText(aStatement, i));
+        break;
+      case SQLITE_BLOB: {
+        const Blob blob = detail::StatementReader::getBlob(aStatement, i);
+        aBuffer.append('"');
+        for (const unsigned char byte : blob) {
+          const char digits[] = {HEX[byte >> 4], HEX[byte & 0xF]};
+          aBuffer.append(digits, sizeof(digits));
+        }
+        aBuffer.append('"');
+        break;
+      }
+      default:
+        aBuffer.append("null", 4);
+        break;
+      }
+    }
+    aBuffer.append('}');
+    aBuffer.endRecord();
+    ++rows;
+  }
+  aBuffer.flush();
+  return rows;
+}
+
+} // namespace
+
+long long exportCsv(Statement& aStatement, std::ostream& aOutput, const CsvOptions& aOptions) {
+  OutputBuffer buffer(aOutput);
+  return writeCsv(aStatement, buffer, aOptions);
+}
+
+long long exportCsv(Statement& aStatement, int aFd, const CsvOptions& aOptions) {
+  OutputBuffer buffer(aFd);
+  return writeCsv(aStatement, buffer, aOptions);
+}
+
+long long exportJsonLines(Statement& aStatement, std::ostream& aOutput) {
+  OutputBuffer buffer(aOutput);
+  return writeJsonLines(aStatement, buffer);
+}
+
+long long exportJsonLines(Statement& aStatement, int aFd) {
+  OutputBuffer buffer(aFd);
+  return writeJsonLines(aStatement, buffer);
+}
+
+} // namespace SQLite
@@ -0,0 +1,43 @@
+#include <sqlite3.h>
+#include <SQLiteCpp/Fields.h>
+#include <SQLiteCpp/Exception.h>
+
+namespace SQLite {
+namespace detail {
+
+void StatementReader::checkRow(const Statement& aStatement, int aCount) {
+  aStatement.checkRow();
+  if (aCount > aStatement.mColumnCount)
+    throw SQLite::Exception("Not enough columns in the result to read all the fields of the struct.");
+}
+
+bool StatementReader::isNull(const Statement& aStatement, int aIndex) noexcept {
+  return SQLITE_NULL == sqlite3_column_type(aStatement.mStmtPtr, aIndex);
+}
+
+int StatementReader::getType(const Statement& aStatement, int aIndex) noexcept {
+  return sqlite3_column_type(aStatement.mStmtPtr, aIndex);
+}
+
+long long StatementReader::getInt64(const Statement& aStatement, int aIndex) noexcept {
+  return sqlite3_column_int64(aStatement.mStmtPtr, aIndex);
+}
+
+double StatementReader::getDouble(const Statement& aStatement, int aIndex) noexcept {
+  return sqlite3_column_double(aStatement.mStmtPtr, aIndex);
+}
+
+std::string_view StatementReader::getText(const Statement& aStatement, int aIndex) noexcept {
+  // sqlite3_column_text() first, then sqlite3_column_bytes() for the size of the UTF-8 text
+  const char* pText = reinterpret_cast<const char*>(sqlite3_column_text(aStatement.mStmtPtr, aIndex));
+  return pText ? std::string_view(pText, static_cast<std::size_t>(sqlite3_column_bytes(aStatement.mStmtPtr, aIndex)))
+               : std::string_view();
+}
+
+Blob StatementReader::getBlob(const Statement& aStatement, int aIndex) noexcept {
+  const unsigned char* pData = static_cast<const unsigned char*>(sqlite3_column_blob(aStatement.mStmtPtr, aIndex));
+  return Blob(pData, pData ? static_cast<std::size_t>(sqlite3_column_bytes(aStatement.mStmtPtr, aIndex)) : 0);
+}
+
+} // namespace detail
+} // namespace SQLite
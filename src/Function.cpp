@@ -0,0 +1,67 @@
+#include <sqlite3.h>
+#include <SQLiteCpp/Function.h>
+
+namespace SQLite {
+namespace detail {
+
+bool valueIsNull(sqlite3_value* apValue) noexcept {
+  return SQLITE_NULL == sqlite3_value_type(apValue);
+}
+
+long long valueInt64(sqlite3_value* apValue) noexcept {
+  return sqlite3_value_int64(apValue);
+}
+
+double valueDouble(sqlite3_value* apValue) noexcept {
+  return sqlite3_value_double(apValue);
+}
+
+std::string_view valueText(sqlite3_value* apValue) noexcept {
+  // sqlite3_value_text() first, then sqlite3_value_bytes() for the size of the UTF-8 text
+  const char* pText = reinterpret_cast<const char*>(sqlite3_value_text(apValue));
+  return pText ? std::string_view(pText, static_cast<std::size_t>(sqlite3_value_bytes(apValue))) : std::string_view();
+}
+
+Blob valueBlob(sqlite3_value* apValue) noexcept {
+  const unsigned char* pData = static_cast<const unsigned char*>(sqlite3_value_blob(apValue));
+  return Blob(pData, pData ? static_cast<std::size_t>(sqlite3_value_bytes(apValue)) : 0);
+}
+
+void resultNull(sqlite3_context* apContext) noexcept {
+  sqlite3_result_null(apContext);
+}
+
+void resultInt64(sqlite3_context* apContext, long long aValue) noexcept {
+  sqlite3_result_int64(apContext, aValue);
+}
+
+void resultDouble(sqlite3_context* apContext, double aValue) noexcept {
+  sqlite3_result_double(apContext, aValue);
+}
+
+void resultText(sqlite3_context* apContext, std::string_view aValue) noexcept {
+  sqlite3_result_text(apContext, aValue.data(), static_cast<int>(aValue.size()), SQLITE_TRANSIENT);
+}
+
+void resultBlob(sqlite3_context* apContext, Blob aValue) noexcept {
+  sqlite3_result_blob(apContext, aValue.data(), static_cast<int>(aValue.size()), SQLITE_TRANSIENT);
+}
+
+void resultError(sqlite3_context* apContext, const char* apMessage) noexcept {
+  sqlite3_result_error(apContext, apMessage, -1);
+}
+
+void resultErrorNoMem(sqlite3_context* apContext) noexcept {
+  sqlite3_result_error_nomem(apContext);
+}
+
+void* userData(sqlite3_context* apContext) noexcept {
+  return sqlite3_user_data(apContext);
+}
+
+void* aggregateContext(sqlite3_context* apContext, int aBytes) noexcept {
+  return sqlite3_aggregate_context(apContext, aBytes);
+}
+
+} // namespace detail
+} // SQLite
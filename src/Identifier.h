@@ -0,0 +1,32 @@
+/**
+ * @file    Identifier.h
+ * @ingroup SQLiteCpp
+ * @brief   Internal helper quoting SQL identifiers, shared by the sources of the library (not installed).
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <string>
+#include <string_view>
+
+namespace SQLite {
+namespace detail {
+
+/// Double quote an SQL identifier (table, column or schema name), escaping its embedded double quotes
+inline std::string quoteIdentifier(std::string_view aName) {
+  std::string quoted;
+  quoted.reserve(aName.size() + 2);
+  quoted += '"';
+  for (const char c : aName) {
+    quoted += c;
+    if ('"' == c)
+      quoted += '"';
+  }
+  quoted += '"';
+  return quoted;
+}
+
+} // namespace detail
+} // SQLite
@@ -0,0 +1,554 @@
+#include <sqlite3.h>
+#include <SQLiteCpp/Import.h>
+#include <SQLiteCpp/Database.h>
+#include <SQLiteCpp/Exception.h>
+#include <SQLiteCpp/Transaction.h>
+#include "Identifier.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace SQLite {
+namespace {
+
+/// Size of the blocks read from a stream, and target size of the chunks parsed by each thread
+constexpr std::size_t BLOCK_SIZE = 4 * 1024 * 1024;
+
+/// Number of records parsed before they are inserted, when parsing on the calling thread
+constexpr std::size_t RECORDS_PER_GROUP = 4096;
+
+constexpr std::size_t NOT_IN_SCRATCH = static_cast<std::size_t>(-1);
+
+/// A parsed field: a view into the input, or into the scratch buffer for an unescaped field
+struct FieldRef {
+  const char*   pData;
+  std::size_t   size;
+  std::size_t   scratchOffset;  ///< offset in the scratch buffer, NOT_IN_SCRATCH if pData points into the input
+};
+
+/// Fields of a sequence of records, with the quoted fields unescaped into the scratch buffer
+struct ParsedRecords {
+  std::vector<FieldRef>     fields;
+  std::vector<std::size_t>  recordEnds;  ///< index in fields after the last field of each record
+  std::string               scratch;
+
+  void clear() {
+    fields.clear();
+    recordEnds.clear();
+    scratch.clear();
+  }
+
+  /// Point the unescaped fields into the scratch buffer, once it does not grow anymore
+  void resolve() {
+    for (FieldRef& field : fields) {
+      if (NOT_IN_SCRATCH != field.scratchOffset)
+        field.pData = scratch.data() + field.scratchOffset;
+    }
+  }
+};
+
+/// Skip the empty lines (LF or CRLF) at aPos, if any
+const char* skipEmptyLines(const char* aPos, const char* aEnd) {
+  for (;;) {
+    if ((aPos < aEnd) && ('\n' == *aPos))
+      aPos += 1;
+    else if ((aPos + 1 < aEnd) && ('\r' == aPos[0]) && ('\n' == aPos[1]))
+      aPos += 2;
+    else
+      return aPos;
+  }
+}
+
+/**
+ * Parse the record starting at aPos, appending its fields to aRecords.
+ *
+ * Return the position after the record, or nullptr if the record is incomplete before aEnd
+ * and more input may follow (abEnd false): nothing is then appended.
+ */
+const char* parseRecord(const char* aPos, const char* aEnd, bool abEnd, const CsvOptions& aOptions,
+                        ParsedRecords& aRecords) {
+  const std::size_t fieldCount = aRecords.fields.size();
+  const std::size_t scratchSize = aRecords.scratch.size();
+  const auto incomplete = [&]() -> const char* {
+    aRecords.fields.resize(fieldCount);
+    aRecords.scratch.resize(scratchSize);
+    return nullptr;
+  };
+
+  const char* pos = aPos;
+  for (;;) {
+    if ((pos < aEnd) && (aOptions.quote == *pos)) {
+      const char* start = ++pos;
+      std::size_t scratchOffset = NOT_IN_SCRATCH;
+      for (;;) {
+        const char* quote = static_cast<const char*>(std::memchr(pos, aOptions.quote, aEnd - pos));
+        if (nullptr == quote) {
+          if (!abEnd)
+            return incomplete();
+          throw SQLite::Exception("Malformed CSV: unterminated quoted field");
+        }
+        if ((quote + 1 == aEnd) && !abEnd)
+          return incomplete(); // cannot tell a closing quote from a doubled one yet
+        if ((quote + 1 < aEnd) && (aOptions.quote == quote[1])) {
+          // doubled quote: unescape the field into the scratch buffer
+          if (NOT_IN_SCRATCH == scratchOffset)
+            scratchOffset = aRecords.scratch.size();
+          aRecords.scratch.append(pos, quote + 1);
+          pos = quote + 2;
+          continue;
+        }
+        if (NOT_IN_SCRATCH == scratchOffset) {
+          aRecords.fields.push_back({start, static_cast<std::size_t>(quote - start), NOT_IN_SCRATCH});
+        } else {
+          aRecords.scratch.append(pos, quote);
+          aRecords.fields.push_back({nullptr, aRecords.scratch.size() - scratchOffset, scratchOffset});
+        }
+        pos = quote + 1;
+        break;
+      }
+      if ((pos < aEnd) && ('\r' == *pos))
+        ++pos;
+      if ((pos < aEnd) && (aOptions.delimiter != *pos) && ('\n' != *pos))
+        throw SQLite::Exception("Malformed CSV: unexpected character after a closing quote");
+    } else {
+      const char* start = pos;
+      while ((pos < aEnd) && (aOptions.delimiter != *pos) && ('\n' != *pos))
+        ++pos;
+      if ((pos == aEnd) && !abEnd)
+        return incomplete();
+      std::size_t size = static_cast<std::size_t>(pos - start);
+      if ((size > 0) && ('\r' == start[size - 1]) && ((pos == aEnd) || ('\n' == *pos)))
+        --size;
+      aRecords.fields.push_back({start, size, NOT_IN_SCRATCH});
+    }
+
+    if ((pos < aEnd) && (aOptions.delimiter == *pos)) {
+      ++pos;
+      continue;
+    }
+    if ((pos == aEnd) && !abEnd)
+      return incomplete(); // a CR may be followed by the LF in the next block
+    aRecords.recordEnds.push_back(aRecords.fields.size());
+    return (pos < aEnd) ? pos + 1 : pos;
+  }
+}
+
+/// Parse all the records of [aBegin, aEnd), which holds whole records
+void parseChunk(const char* aBegin, const char* aEnd, const CsvOptions& aOptions, ParsedRecords& aRecords) {
+  const char* pos = skipEmptyLines(aBegin, aEnd);
+  while (pos < aEnd) {
+    pos = skipEmptyLines(parseRecord(pos, aEnd, true, aOptions, aRecords), aEnd);
+  }
+  aRecords.resolve();
+}
+
+/**
+ * Sequential scan of the quoting state of the records, with the rules of parseRecord(): a quote only opens
+ * a quoted field at the start of a field, and is an ordinary character inside an unquoted field.
+ * Much cheaper than parsing, to tell apart the newlines ending records from the ones inside quoted fields.
+ */
+class RecordScanner {
+public:
+  explicit RecordScanner(const CsvOptions& aOptions) :
+    mQuote(aOptions.quote),
+    mDelimiter(aOptions.delimiter)
+  {
+  }
+
+  /// Scan the next character, and return true if it ends a record
+  bool next(char aChar) noexcept {
+    switch (mState) {
+    case State::FieldStart:
+    case State::Unquoted:
+    case State::AfterQuote:
+      if ((mQuote == aChar) && (State::Unquoted != mState)) {
+        mState = State::Quoted; // opening quote, or doubled quote inside a quoted field
+      } else if (mDelimiter == aChar) {
+        mState = State::FieldStart;
+      } else if ('\n' == aChar) {
+        mState = State::FieldStart;
+        return true;
+      } else if ((State::FieldStart == mState) || ('\r' != aChar)) {
+        mState = State::Unquoted; // after a closing quote, only a CR is valid: any other character is an error of the parser
+      }
+      return false;
+    case State::Quoted:
+      if (mQuote == aChar)
+        mState = State::AfterQuote;
+      return false;
+    }
+    return false;
+  }
+
+private:
+  enum class State {
+    FieldStart, ///< At the start of a field
+    Unquoted,   ///< In an unquoted field
+    Quoted,     ///< In a quoted field
+    AfterQuote  ///< After a closing (or the first of a doubled) quote
+  };
+
+  const char  mQuote;
+  const char  mDelimiter;
+  State       mState = State::FieldStart;
+};
+
+/// Split [aBegin, aEnd) into chunks of whole records of about BLOCK_SIZE bytes, scanned by a RecordScanner
+std::vector<const char*> splitChunks(const char* aBegin, const char* aEnd, const CsvOptions& aOptions) {
+  std::vector<const char*> bounds{aBegin};
+  RecordScanner scanner(aOptions);
+  const char* pos = aBegin;
+  while (pos < aEnd) {
+    const char* target = (static_cast<std::size_t>(aEnd - pos) > BLOCK_SIZE) ? pos + BLOCK_SIZE : aEnd;
+    for (; pos < target; ++pos)
+      scanner.next(*pos);
+    for (; pos < aEnd; ++pos) {
+      if (scanner.next(*pos)) {
+        ++pos;
+        break;
+      }
+    }
+    bounds.push_back(pos);
+  }
+  return bounds;
+}
+
+/// The single writer: binds the parsed fields without copy to a reused INSERT, and commits by batches
+class Writer {
+public:
+  Writer(Database& aDatabase, const std::string& aTable, const CsvOptions& aOptions) :
+    mDatabase(aDatabase),
+    mTable(aTable),
+    mOptions(aOptions),
+    mStart(std::chrono::steady_clock::now())
+  {
+  }
+
+  ~Writer() {
+    sqlite3_finalize(mpStmt);
+  }
+
+  Writer(const Writer&) = delete;
+  Writer& operator=(const Writer&) = delete;
+
+  bool isPrepared() const noexcept {
+    return nullptr != mpStmt;
+  }
+
+  /// Prepare the INSERT, with the column names of the header (or the table order if aNames is null)
+  void prepare(const ParsedRecords* apNames, std::size_t aColumnCount) {
+    std::string columns;
+    std::string values;
+    for (std::size_t i = 0; i < aColumnCount; ++i) {
+      if (apNames) {
+        const FieldRef& name = apNames->fields[i];
+        columns += (0 == i) ? "" : ", ";
+        columns += detail::quoteIdentifier(std::string_view(name.pData, name.size));
+      }
+      values += (0 == i) ? "?" : ", ?";
+    }
+    const std::string table = detail::quoteIdentifier(mTable);
+    if (apNames && mOptions.bCreateTable)
+      mDatabase.exec("CREATE TABLE IF NOT EXISTS " + table + " (" + columns + ")");
+    const std::string sql = "INSERT INTO " + table + (apNames ? " (" + columns + ")" : "") + " VALUES (" + values + ")";
+
+    if (SQLITE_OK != sqlite3_prepare_v2(mDatabase.getHandle(), sql.c_str(), static_cast<int>(sql.size()), &mpStmt, nullptr))
+      throw SQLite::Exception(mDatabase.getHandle());
+    mColumnCount = aColumnCount;
+  }
+
+  /// Insert all the records, in order
+  void insert(const ParsedRecords& aRecords) {
+    std::size_t begin = 0;
+    for (const std::size_t end : aRecords.recordEnds) {
+      insert(&aRecords.fields[begin], end - begin);
+      begin = end;
+    }
+  }
+
+  /// Commit the last batch, and return the counters
+  ImportResult finish(long long aBytes) {
+    if (mpTransaction) {
+      mpTransaction->commit();
+      mpTransaction.reset();
+      ++mResult.batches;
+    }
+    mResult.bytes = aBytes;
+    mResult.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - mStart).count();
+    return mResult;
+  }
+
+private:
+  void insert(const FieldRef* apFields, std::size_t aCount) {
+    if (aCount > mColumnCount) {
+      throw SQLite::Exception("Malformed CSV: record " + std::to_string(mResult.rows + 1) + " has "
+                              + std::to_string(aCount) + " fields, expected " + std::to_string(mColumnCount));
+    }
+    if (!mpTransaction)
+      mpTransaction.reset(new Transaction(mDatabase));
+
+    for (std::size_t i = 0; i < aCount; ++i)
+      sqlite3_bind_text(mpStmt, static_cast<int>(i) + 1, apFields[i].pData, static_cast<int>(apFields[i].size), SQLITE_STATIC);
+    for (std::size_t i = aCount; i < mColumnCount; ++i)
+      sqlite3_bind_null(mpStmt, static_cast<int>(i) + 1);
+    const int ret = sqlite3_step(mpStmt);
+    sqlite3_reset(mpStmt);
+    if (SQLITE_DONE != ret)
+      throw SQLite::Exception(mDatabase.getHandle());
+    ++mResult.rows;
+
+    if ((mOptions.batchSize > 0) && (0 == mResult.rows % static_cast<long long>(mOptions.batchSize))) {
+      mpTransaction->commit();
+      mpTransaction.reset();
+      ++mResult.batches;
+    }
+  }
+
+  Database&                     mDatabase;
+  const std::string&            mTable;
+  const CsvOptions&             mOptions;
+  std::chrono::steady_clock::time_point mStart;
+  sqlite3_stmt*                 mpStmt = nullptr;
+  std::size_t                   mColumnCount = 0;
+  std::unique_ptr<Transaction>  mpTransaction;
+  ImportResult                  mResult;
+};
+
+/// Parse the first record (header or first row) at aBegin, and prepare the INSERT accordingly
+const char* startImport(const char* aBegin, const char* aEnd, bool abEnd, const CsvOptions& aOptions, Writer& aWriter) {
+  ParsedRecords first;
+  const char* pos = parseRecord(skipEmptyLines(aBegin, aEnd), aEnd, abEnd, aOptions, first);
+  if (nullptr == pos)
+    return nullptr;
+  first.resolve();
+  aWriter.prepare(aOptions.bHeader ? &first : nullptr, first.fields.size());
+  if (!aOptions.bHeader)
+    aWriter.insert(first);
+  return pos;
+}
+
+/// Parse the chunks on several threads, while the calling thread inserts them in order
+void importChunks(const std::vector<const char*>& aBounds, const CsvOptions& aOptions, Writer& aWriter) {
+  const std::size_t chunkCount = aBounds.size() - 1;
+  const std::size_t maxInFlight = 2 * static_cast<std::size_t>(aOptions.parserThreads);
+  std::vector<std::unique_ptr<ParsedRecords>> parsed(chunkCount);
+  std::vector<std::exception_ptr> errors(chunkCount);
+  std::mutex mutex;
+  std::condition_variable cond;
+  std::size_t nextChunk = 0;
+  std::size_t written = 0;
+  bool bAbort = false;
+
+  const auto parse = [&]() {
+    for (;;) {
+      std::size_t chunk;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        // bound the memory: do not parse too far ahead of the writer
+        cond.wait(lock, [&] { return bAbort || (nextChunk >= chunkCount) || (nextChunk < written + maxInFlight); });
+        if (bAbort || (nextChunk >= chunkCount))
+          return;
+        chunk = nextChunk++;
+      }
+      std::unique_ptr<ParsedRecords> records(new ParsedRecords());
+      std::exception_ptr error;
+      try {
+        parseChunk(aBounds[chunk], aBounds[chunk + 1], aOptions, *records);
+      } catch (...) {
+        error = std::current_exception();
+      }
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        parsed[chunk] = std::move(records);
+        errors[chunk] = error;
+      }
+      cond.notify_all();
+    }
+  };
+
+  std::vector<std::thread> threads;
+  const auto stop = [&]() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      bAbort = true;
+    }
+    cond.notify_all();
+    for (std::thread& thread : threads)
+      thread.join();
+  };
+
+  try {
+    for (unsigned i = 0; i < aOptions.parserThreads; ++i)
+      threads.emplace_back(parse);
+
+    for (std::size_t chunk = 0; chunk < chunkCount; ++chunk) {
+      std::unique_ptr<ParsedRecords> records;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        cond.wait(lock, [&] { return nullptr != parsed[chunk]; });
+        if (errors[chunk])
+          std::rethrow_exception(errors[chunk]);
+        records = std::move(parsed[chunk]);
+      }
+      aWriter.insert(*records);
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++written;
+      }
+      cond.notify_all();
+    }
+  } catch (...) {
+    stop();
+    throw;
+  }
+  stop();
+}
+
+/// Read-only memory mapping of a whole file (or its content read in memory where mmap() is not available)
+class MappedFile {
+public:
+  explicit MappedFile(const std::string& aPath) {
+#ifndef _WIN32
+    const int fd = ::open(aPath.c_str(), O_RDONLY);
+    if (fd < 0)
+      throw SQLite::Exception("Cannot open " + aPath);
+    struct stat status;
+    if (0 != ::fstat(fd, &status)) {
+      ::close(fd);
+      throw SQLite::Exception("Cannot stat " + aPath);
+    }
+    mSize = static_cast<std::size_t>(status.st_size);
+    if (mSize > 0) {
+      void* pData = ::mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (MAP_FAILED == pData) {
+        ::close(fd);
+        throw SQLite::Exception("Cannot map " + aPath);
+      }
+      ::madvise(pData, mSize, MADV_SEQUENTIAL);
+      mpData = static_cast<const char*>(pData);
+    }
+    ::close(fd);
+#else
+    std::ifstream file(aPath, std::ios::binary);
+    if (!file)
+      throw SQLite::Exception("Cannot open " + aPath);
+    mContent.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    mpData = mContent.data();
+    mSize = mContent.size();
+#endif
+  }
+
+  ~MappedFile() {
+#ifndef _WIN32
+    if (mpData)
+      ::munmap(const_cast<char*>(mpData), mSize);
+#endif
+  }
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  const char* begin() const noexcept { return mpData; }
+  const char* end() const noexcept { return mpData + mSize; }
+  std::size_t size() const noexcept { return mSize; }
+
+private:
+  const char* mpData = nullptr;
+  std::size_t mSize = 0;
+#ifdef _WIN32
+  std::string mContent;
+#endif
+};
+
+} // namespace
+
+ImportResult importCsv(Database& aDatabase, const std::string& aTable, const std::string& aPath,
+                       const CsvOptions& aOptions) {
+  Writer writer(aDatabase, aTable, aOptions);
+  const MappedFile file(aPath);
+  if (0 == file.size())
+    return writer.finish(0);
+
+  const char* pos = startImport(file.begin(), file.end(), true, aOptions, writer);
+  if (aOptions.parserThreads > 1) {
+    importChunks(splitChunks(pos, file.end(), aOptions), aOptions, writer);
+  } else {
+    ParsedRecords records;
+    pos = skipEmptyLines(pos, file.end());
+    while (pos < file.end()) {
+      records.clear();
+      for (std::size_t i = 0; (i < RECORDS_PER_GROUP) && (pos < file.end()); ++i)
+        pos = skipEmptyLines(parseRecord(pos, file.end(), true, aOptions, records), file.end());
+      records.resolve();
+      writer.insert(records);
+    }
+  }
+  return writer.finish(static_cast<long long>(file.size()));
+}
+
+ImportResult importCsv(Database& aDatabase, const std::string& aTable, std::istream& aInput,
+                       const CsvOptions& aOptions) {
+  Writer writer(aDatabase, aTable, aOptions);
+  std::vector<char> buffer(BLOCK_SIZE);
+  std::size_t used = 0;
+  long long bytes = 0;
+  bool bEnd = false;
+  ParsedRecords records;
+
+  while (!bEnd) {
+    if (used == buffer.size())
+      buffer.resize(2 * buffer.size()); // a single record larger than the buffer
+    aInput.read(buffer.data() + used, static_cast<std::streamsize>(buffer.size() - used));
+    const std::size_t count = static_cast<std::size_t>(aInput.gcount());
+    if ((0 == count) && aInput.bad())
+      throw SQLite::Exception("Cannot read the CSV input stream");
+    bEnd = !aInput;
+    used += count;
+    bytes += static_cast<long long>(count);
+
+    const char* pos = buffer.data();
+    const char* end = buffer.data() + used;
+    if (!writer.isPrepared()) {
+      if (used == 0)
+        break;
+      const char* next = startImport(pos, end, bEnd, aOptions, writer);
+      if (nullptr == next)
+        continue;
+      pos = next;
+    }
+
+    // parse the whole records of the block, and insert them before the block is overwritten
+    records.clear();
+    pos = skipEmptyLines(pos, end);
+    while (pos < end) {
+      const char* next = parseRecord(pos, end, bEnd, aOptions, records);
+      if (nullptr == next)
+        break;
+      pos = skipEmptyLines(next, end);
+    }
+    records.resolve();
+    writer.insert(records);
+
+    // carry over the partial record
+    used = static_cast<std::size_t>(end - pos);
+    std::memmove(buffer.data(), pos, used);
+  }
+  return writer.finish(bytes);
+}
+
+} // namespace SQLite
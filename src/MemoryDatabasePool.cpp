@@ -0,0 +1,122 @@
+#include <sqlite3.h>
+#include <SQLiteCpp/MemoryDatabasePool.h>
+#include <SQLiteCpp/Exception.h>
+
+#include <algorithm>
+#include <thread>
+#include <utility>
+
+namespace SQLite {
+
+namespace {
+
+// Escape the characters of the name ending the path of a URI
+std::string toUri(const std::string& aName) {
+  std::string uri = "file:";
+  for (const char c : aName) {
+    if (('%' == c) || ('?' == c) || ('#' == c)) {
+      static const char HEX[] = "0123456789ABCDEF";
+      uri += '%';
+      uri += HEX[(static_cast<unsigned char>(c) >> 4) & 0xF];
+      uri += HEX[static_cast<unsigned char>(c) & 0xF];
+    } else {
+      uri += c;
+    }
+  }
+  return uri + "?mode=memory&cache=shared";
+}
+
+} // namespace
+
+MemoryDatabasePool::Connection::Connection(Connection&& aOther) noexcept :
+  mpPool(aOther.mpPool),
+  mpDatabase(aOther.mpDatabase)
+{
+  aOther.mpPool = nullptr;
+  aOther.mpDatabase = nullptr;
+}
+
+MemoryDatabasePool::Connection& MemoryDatabasePool::Connection::operator=(Connection&& aOther) noexcept {
+  if (this != &aOther) {
+    release();
+    std::swap(mpPool, aOther.mpPool);
+    std::swap(mpDatabase, aOther.mpDatabase);
+  }
+  return *this;
+}
+
+void MemoryDatabasePool::Connection::release() noexcept {
+  if (mpDatabase) {
+    mpPool->release(*mpDatabase);
+    mpPool = nullptr;
+    mpDatabase = nullptr;
+  }
+}
+
+MemoryDatabasePool::MemoryDatabasePool(const std::string& aName, const unsigned aReaders, const bool abReadUncommitted) :
+  mName(aName),
+  mUri(toUri(aName))
+{
+  if (aName.empty())
+    throw SQLite::Exception("A shared in-memory database needs a name");
+
+  // The writer creates the database: it is destroyed when its last connection is closed
+  mpWriter.reset(new Database(mUri, SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE | SQLite::OPEN_URI));
+  if (Database::hasUnlockNotify())
+    mpWriter->setWaitForUnlock(true);
+
+  const unsigned readers = (aReaders > 0) ? aReaders : std::max(1u, std::thread::hardware_concurrency());
+  mReaders.reserve(readers);
+  mFreeReaders.reserve(readers);
+  for (unsigned i = 0; i < readers; ++i) {
+    mReaders.emplace_back(new Database(mUri, SQLite::OPEN_READONLY | SQLite::OPEN_URI));
+    Database& reader = *mReaders.back();
+    reader.exec("PRAGMA query_only = 1"); // the shared cache is opened read-write by the writer, whatever the flags
+    if (abReadUncommitted)
+      reader.exec("PRAGMA read_uncommitted = 1");
+    if (Database::hasUnlockNotify())
+      reader.setWaitForUnlock(true);
+    mFreeReaders.push_back(&reader);
+  }
+}
+
+// Close the readers before the writer (declared first, destroyed last)
+MemoryDatabasePool::~MemoryDatabasePool() = default;
+
+MemoryDatabasePool::Connection MemoryDatabasePool::acquireReader() {
+  std::unique_lock<std::mutex> lock(mMutex);
+  mReleased.wait(lock, [this] { return !mFreeReaders.empty(); });
+  Database& reader = *mFreeReaders.back();
+  mFreeReaders.pop_back();
+  return Connection(*this, reader);
+}
+
+MemoryDatabasePool::Connection MemoryDatabasePool::tryAcquireReader() {
+  std::lock_guard<std::mutex> lock(mMutex);
+  if (mFreeReaders.empty())
+    return Connection();
+  Database& reader = *mFreeReaders.back();
+  mFreeReaders.pop_back();
+  return Connection(*this, reader);
+}
+
+MemoryDatabasePool::Connection MemoryDatabasePool::acquireWriter() {
+  std::unique_lock<std::mutex> lock(mMutex);
+  mReleased.wait(lock, [this] { return mbWriterFree; });
+  mbWriterFree = false;
+  return Connection(*this, *mpWriter);
+}
+
+void MemoryDatabasePool::release(Database& aDatabase) noexcept {
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (&aDatabase == mpWriter.get())
+      mbWriterFree = true;
+    else
+      mFreeReaders.push_back(&aDatabase);
+  }
+  // Readers and the writer wait on the same condition
+  mReleased.notify_all();
+}
+
+} // namespace SQLite
@@ -0,0 +1,170 @@
+#include <sqlite3.h>
+#include <SQLiteCpp/MemoryGovernor.h>
+#include <SQLiteCpp/Database.h>
+#include <SQLiteCpp/Exception.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace SQLite {
+
+namespace detail {
+
+std::atomic<unsigned long long> gMemoryEpoch{1};
+
+/// Process-wide registry of the open connections, with the budget, the counters and the background thread
+struct MemoryRegistry {
+  std::mutex              mutex;        ///< Guards all the members below
+  std::vector<Database*>  databases;    ///< Open connections
+  MemoryBudget            budget;       ///< Current budget
+  MemoryGovernorStats     stats;        ///< Counters (memoryUsed and connections computed on demand)
+  std::condition_variable wake;         ///< Wakes the background thread up to stop it
+  bool                    bStop = false; ///< Stop the background thread
+  std::thread             watcher;      ///< Background thread checking the memory used, if any
+  std::mutex              configMutex;  ///< Serializes setMemoryBudget(), which starts and stops the thread
+
+  static MemoryRegistry& instance() {
+    static MemoryRegistry registry;
+    return registry;
+  }
+
+  ~MemoryRegistry() {
+    stopWatcher();
+  }
+
+  long long getTarget() const noexcept {
+    return (budget.target > 0) ? budget.target : budget.softLimit;
+  }
+
+  /// Release the caches of the idle connections, least recently used first (with the mutex locked)
+  long long reclaim(const bool abForce) {
+    // Each check is a tick of the clock of the last uses: the connections used from now on are more recent
+    gMemoryEpoch.fetch_add(1, std::memory_order_relaxed);
+    const long long target = getTarget();
+    if (!abForce && ((target <= 0) || (sqlite3_memory_used() <= target)))
+      return 0;
+    ++stats.reclaims;
+
+    std::vector<Database*> order(databases);
+    std::sort(order.begin(), order.end(), [](const Database* apA, const Database* apB) {
+      return apA->mLastUse.load(std::memory_order_relaxed) < apB->mLastUse.load(std::memory_order_relaxed);
+    });
+
+    long long reclaimed = 0;
+    for (Database* pDatabase : order) {
+      if (!abForce && (sqlite3_memory_used() <= target))
+        break;
+
+      // Never wait for a connection in use by another thread
+      sqlite3* pSQLite = pDatabase->getHandle();
+      sqlite3_mutex* pMutex = sqlite3_db_mutex(pSQLite);
+      if ((nullptr == pMutex) || (SQLITE_OK != sqlite3_mutex_try(pMutex))) {
+        ++stats.connectionsSkipped;
+        continue;
+      }
+      bool bBusy = false;
+      for (sqlite3_stmt* pStmt = sqlite3_next_stmt(pSQLite, nullptr); pStmt && !bBusy;
+           pStmt = sqlite3_next_stmt(pSQLite, pStmt))
+        bBusy = (0 != sqlite3_stmt_busy(pStmt));
+      if (bBusy) {
+        ++stats.connectionsSkipped;
+      } else {
+        int before = 0;
+        int after = 0;
+        int highwater = 0;
+        sqlite3_db_status(pSQLite, SQLITE_DBSTATUS_CACHE_USED, &before, &highwater, 0);
+        sqlite3_db_release_memory(pSQLite);
+        sqlite3_db_status(pSQLite, SQLITE_DBSTATUS_CACHE_USED, &after, &highwater, 0);
+        if (before > after)
+          reclaimed += before - after;
+        ++stats.connectionsReleased;
+      }
+      sqlite3_mutex_leave(pMutex);
+    }
+    stats.bytesReclaimed += reclaimed;
+    return reclaimed;
+  }
+
+  void startWatcher(const std::chrono::milliseconds aInterval) {
+    bStop = false;
+    watcher = std::thread([this, aInterval] {
+      std::unique_lock<std::mutex> lock(mutex);
+      while (!wake.wait_for(lock, aInterval, [this] { return bStop; }))
+        reclaim(false);
+    });
+  }
+
+  void stopWatcher() {
+    if (!watcher.joinable())
+      return;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      bStop = true;
+    }
+    wake.notify_all();
+    watcher.join();
+  }
+};
+
+void registerDatabase(Database& aDatabase) {
+  MemoryRegistry& registry = MemoryRegistry::instance();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  registry.databases.push_back(&aDatabase);
+  registry.reclaim(false); // a new connection is a good time to check the budget
+}
+
+void unregisterDatabase(Database& aDatabase) noexcept {
+  MemoryRegistry& registry = MemoryRegistry::instance();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  const auto found = std::find(registry.databases.begin(), registry.databases.end(), &aDatabase);
+  if (found != registry.databases.end()) {
+    *found = registry.databases.back();
+    registry.databases.pop_back();
+  }
+}
+
+} // namespace detail
+
+void setMemoryBudget(const MemoryBudget& aBudget) {
+  if ((aBudget.softLimit < 0) || (aBudget.hardLimit < 0) || (aBudget.target < 0) || (aBudget.checkInterval.count() < 0))
+    throw SQLite::Exception("Invalid memory budget: negative value");
+
+  detail::MemoryRegistry& registry = detail::MemoryRegistry::instance();
+  std::lock_guard<std::mutex> configLock(registry.configMutex);
+  registry.stopWatcher();
+  {
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.budget = aBudget;
+    sqlite3_soft_heap_limit64(aBudget.softLimit);
+    sqlite3_hard_heap_limit64(aBudget.hardLimit);
+    registry.reclaim(false);
+    if (aBudget.checkInterval.count() > 0)
+      registry.startWatcher(aBudget.checkInterval);
+  }
+}
+
+MemoryBudget getMemoryBudget() {
+  detail::MemoryRegistry& registry = detail::MemoryRegistry::instance();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  return registry.budget;
+}
+
+long long reclaimMemory(const bool abForce /* = false */) {
+  detail::MemoryRegistry& registry = detail::MemoryRegistry::instance();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  return registry.reclaim(abForce);
+}
+
+MemoryGovernorStats getMemoryGovernorStats() {
+  detail::MemoryRegistry& registry = detail::MemoryRegistry::instance();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  MemoryGovernorStats stats = registry.stats;
+  stats.memoryUsed = sqlite3_memory_used();
+  stats.connections = static_cast<long long>(registry.databases.size());
+  return stats;
+}
+
+} // namespace SQLite
@@ -0,0 +1,43 @@
+#include <SQLiteCpp/Pragma.h>
+
+namespace SQLite {
+
+ConnectionProfile ConnectionProfile::readHeavy() {
+  ConnectionProfile profile;
+  profile.journalMode = JournalMode::Wal;
+  profile.synchronous = Synchronous::Normal;
+  profile.cacheSize = -64 * 1024;
+  profile.mmapSize = 256LL * 1024 * 1024;
+  profile.tempStore = TempStore::Memory;
+  return profile;
+}
+
+ConnectionProfile ConnectionProfile::writeHeavy() {
+  ConnectionProfile profile;
+  profile.journalMode = JournalMode::Wal;
+  profile.synchronous = Synchronous::Normal;
+  profile.cacheSize = -32 * 1024;
+  profile.tempStore = TempStore::Memory;
+  profile.walAutoCheckpoint = 4000;
+  return profile;
+}
+
+ConnectionProfile ConnectionProfile::bulkLoad() {
+  ConnectionProfile profile;
+  profile.pageSize = 64 * 1024;
+  profile.journalMode = JournalMode::Off;
+  profile.synchronous = Synchronous::Off;
+  profile.cacheSize = -256 * 1024;
+  profile.tempStore = TempStore::Memory;
+  return profile;
+}
+
+ConnectionProfile ConnectionProfile::inMemoryEphemeral() {
+  ConnectionProfile profile;
+  profile.journalMode = JournalMode::Memory;
+  profile.synchronous = Synchronous::Off;
+  profile.tempStore = TempStore::Memory;
+  return profile;
+}
+
+} // SQLite
@@ -0,0 +1,44 @@
+#include <SQLiteCpp/QueryPlan.h>
+
+using namespace std;
+
+namespace SQLite {
+
+namespace {
+
+// Test if the string starts with the given prefix
+bool startsWith(const string& aString, const char* apPrefix) {
+  return 0 == aString.compare(0, char_traits<char>::length(apPrefix), apPrefix);
+}
+
+} // namespace
+
+// true for a full scan of a table or of an index
+bool QueryPlanNode::isScan() const {
+  // "SCAN t" since SQLite 3.36, "SCAN TABLE t" before
+  return startsWith(detail, "SCAN ") && !startsWith(detail, "SCAN CONSTANT ROW");
+}
+
+// true for a temporary b-tree, used for a sort or a DISTINCT/GROUP BY
+bool QueryPlanNode::isTempBTree() const {
+  return string::npos != detail.find("USE TEMP B-TREE");
+}
+
+// Return the name of the table (or alias) scanned or searched by this node
+string QueryPlanNode::getTable() const {
+  size_t start;
+  if (startsWith(detail, "SCAN "))
+    start = 5;
+  else if (startsWith(detail, "SEARCH "))
+    start = 7;
+  else
+    return "";
+
+  if (0 == detail.compare(start, 6, "TABLE ")) // before SQLite 3.36
+    start += 6;
+
+  const size_t end = detail.find(' ', start);
+  return detail.substr(start, (string::npos == end) ? string::npos : end - start);
+}
+
+} // SQLite
@@ -0,0 +1,28 @@
+#include <sqlite3.h>
+#include <SQLiteCpp/Result.h>
+#include <SQLiteCpp/Exception.h>
+
+namespace SQLite {
+
+bool Result::isOk() const noexcept {
+  const int code = mCode & 0xFF;
+  return (SQLITE_OK == code) || (SQLITE_ROW == code) || (SQLITE_DONE == code);
+}
+
+bool Result::isBusy() const noexcept {
+  const int code = mCode & 0xFF;
+  return (SQLITE_BUSY == code) || (SQLITE_LOCKED == code);
+}
+
+const char* Result::getErrorMsg() const noexcept {
+  // the message of the connection describes the last error, which may be another one since
+  if (mpSQLite && ((sqlite3_errcode(mpSQLite) == mCode) || (sqlite3_extended_errcode(mpSQLite) == mCode)))
+    return sqlite3_errmsg(mpSQLite);
+  return sqlite3_errstr(mCode);
+}
+
+void Result::throwException() const {
+  throw SQLite::Exception(getErrorMsg(), mCode);
+}
+
+} // namespace SQLite
@@ -0,0 +1,47 @@
+#include <sqlite3.h>
+#include <SQLiteCpp/ResultCache.h>
+
+namespace SQLite {
+
+bool ResultSet::isNull(const std::size_t aRow, const int aColumn) const {
+  return SQLITE_NULL == cell(aRow, aColumn).type;
+}
+
+long long ResultSet::getInt64(const std::size_t aRow, const int aColumn) const {
+  const Cell& value = cell(aRow, aColumn);
+  if (SQLITE_INTEGER == value.type)
+    return value.integer;
+  if (SQLITE_FLOAT == value.type)
+    return static_cast<long long>(value.real);
+  return 0;
+}
+
+double ResultSet::getDouble(const std::size_t aRow, const int aColumn) const {
+  const Cell& value = cell(aRow, aColumn);
+  if (SQLITE_FLOAT == value.type)
+    return value.real;
+  if (SQLITE_INTEGER == value.type)
+    return static_cast<double>(value.integer);
+  return 0.0;
+}
+
+std::string_view ResultSet::getText(const std::size_t aRow, const int aColumn) const {
+  const Cell& value = cell(aRow, aColumn);
+  if ((SQLITE_TEXT != value.type) && (SQLITE_BLOB != value.type))
+    return std::string_view();
+  return std::string_view(mData.data() + value.offset, value.size);
+}
+
+Span<const unsigned char> ResultSet::getBlob(const std::size_t aRow, const int aColumn) const {
+  const std::string_view data = getText(aRow, aColumn);
+  return Span<const unsigned char>(reinterpret_cast<const unsigned char*>(data.data()), data.size());
+}
+
+std::size_t ResultSet::getMemoryUsed() const noexcept {
+  std::size_t bytes = sizeof(ResultSet) + mCells.capacity() * sizeof(Cell) + mData.capacity();
+  for (const std::string& name : mColumnNames)
+    bytes += sizeof(std::string) + name.capacity();
+  return bytes;
+}
+
+} // namespace SQLite
@@ -0,0 +1,300 @@
+#include <sqlite3.h>
+#include <SQLiteCpp/RoutingDatabase.h>
+#include <SQLiteCpp/Exception.h>
+#include <SQLiteCpp/Snapshot.h>
+#include "Identifier.h"
+
+#include <algorithm>
+#include <cctype>
+#include <exception>
+#include <optional>
+#include <thread>
+
+namespace SQLite {
+
+/// Connection leased from the RoutingDatabase for the scope of a call
+class RoutingDatabase::Lease {
+public:
+  Lease(RoutingDatabase& aRouter, const Route aRoute) :
+    mRouter(aRouter),
+    mDatabase(aRouter.acquire(aRoute)) {
+  }
+
+  ~Lease() {
+    mRouter.release(mDatabase);
+  }
+
+  Lease(const Lease&) = delete;
+  Lease& operator=(const Lease&) = delete;
+
+  Database& operator*() const noexcept {
+    return mDatabase;
+  }
+
+private:
+  RoutingDatabase&  mRouter;
+  Database&         mDatabase;
+};
+
+namespace {
+
+// true if the first keyword of the query, after the spaces and comments, is apKeyword (in upper case)
+bool startsWith(const std::string& aQuery, const char* apKeyword) {
+  std::size_t pos = 0;
+  while (pos < aQuery.size()) {
+    if (std::isspace(static_cast<unsigned char>(aQuery[pos]))) {
+      ++pos;
+    } else if (0 == aQuery.compare(pos, 2, "--")) {
+      pos = aQuery.find('\n', pos);
+      if (std::string::npos == pos)
+        return false;
+    } else if (0 == aQuery.compare(pos, 2, "/*")) {
+      pos = aQuery.find("*/", pos + 2);
+      if (std::string::npos == pos)
+        return false;
+      pos += 2;
+    } else {
+      break;
+    }
+  }
+  std::size_t length = 0;
+  for (; apKeyword[length] != '\0'; ++length) {
+    if ((pos + length >= aQuery.size()) ||
+        (std::toupper(static_cast<unsigned char>(aQuery[pos + length])) != apKeyword[length]))
+      return false;
+  }
+  return (pos + length == aQuery.size()) || !std::isalnum(static_cast<unsigned char>(aQuery[pos + length]));
+}
+
+// Route of a statement prepared on a reader
+Route decideRoute(const Statement& aStatement) {
+  if (!aStatement.isReadOnly())
+    return Route::Writer;
+  // Read-only for sqlite3_stmt_readonly(), but changing the state of the connection running them
+  static const char* const CONNECTION_STATEMENTS[] = {
+    "BEGIN", "COMMIT", "END", "ROLLBACK", "SAVEPOINT", "RELEASE", "ATTACH", "DETACH", "PRAGMA"
+  };
+  for (const char* pKeyword : CONNECTION_STATEMENTS) {
+    if (startsWith(aStatement.getQuery(), pKeyword))
+      return Route::Writer;
+  }
+  return Route::Reader;
+}
+
+} // namespace
+
+RoutingDatabase::RoutingDatabase(const std::string& aFilename, const unsigned aReaders,
+                                 const int aFlags, const int aBusyTimeoutMs)
+{
+  // The writer first, to create the database if needed
+  mpWriter.reset(new Database(aFilename, aFlags, aBusyTimeoutMs));
+  if (Database::hasUnlockNotify())
+    mpWriter->setWaitForUnlock(true); // only used with a shared cache
+
+  const int readerFlags = (aFlags & ~(SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE)) | SQLite::OPEN_READONLY;
+  const unsigned readers = (aReaders > 0) ? aReaders : std::max(1u, std::thread::hardware_concurrency());
+  mReaders.reserve(readers);
+  mFreeReaders.reserve(readers);
+  for (unsigned i = 0; i < readers; ++i) {
+    mReaders.emplace_back(new Database(aFilename, readerFlags, aBusyTimeoutMs));
+    Database& reader = *mReaders.back();
+    reader.exec("PRAGMA query_only = 1"); // also with a shared cache, where OPEN_READONLY is ignored
+    if (Database::hasUnlockNotify())
+      reader.setWaitForUnlock(true);
+    mFreeReaders.push_back(&reader);
+  }
+}
+
+// Defined here, where Lease is a complete type
+RoutingDatabase::~RoutingDatabase() = default;
+
+Database& RoutingDatabase::acquire(const Route aRoute) {
+  std::unique_lock<std::mutex> lock(mMutex);
+  if (Route::Writer == aRoute) {
+    mReleased.wait(lock, [this] { return mbWriterFree; });
+    mbWriterFree = false;
+    return *mpWriter;
+  }
+  mReleased.wait(lock, [this] { return !mFreeReaders.empty(); });
+  Database* pReader = mFreeReaders.back();
+  mFreeReaders.pop_back();
+  return *pReader;
+}
+
+void RoutingDatabase::release(Database& aDatabase) noexcept {
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (&aDatabase == mpWriter.get())
+      mbWriterFree = true;
+    else
+      mFreeReaders.push_back(&aDatabase);
+  }
+  // Readers and the writer wait on the same condition
+  mReleased.notify_all();
+}
+
+bool RoutingDatabase::findRoute(const std::string& aQuery, Route& aRoute) const {
+  std::lock_guard<std::mutex> lock(mMutex);
+  const auto found = mRoutes.find(aQuery);
+  if (found == mRoutes.end())
+    return false;
+  aRoute = found->second;
+  return true;
+}
+
+Route RoutingDatabase::addRoute(const Statement& aStatement) {
+  const Route route = decideRoute(aStatement);
+  std::lock_guard<std::mutex> lock(mMutex);
+  mRoutes.emplace(aStatement.getQuery(), route);
+  ++mStats.routeMisses;
+  return route;
+}
+
+Route RoutingDatabase::getRoute(const std::string& aQuery) {
+  Route route = Route::Reader;
+  if (findRoute(aQuery, route))
+    return route;
+  Lease reader(*this, Route::Reader);
+  const Statement statement(*reader, aQuery);
+  return addRoute(statement);
+}
+
+void RoutingDatabase::run(const std::string& aQuery, const std::function<void(Statement&)>& aTask) {
+  Route route = Route::Reader;
+  const bool bKnown = findRoute(aQuery, route);
+  if (Route::Reader == route) {
+    // A new SQL text is prepared on a reader, and run there if read-only: prepared only once either way
+    Lease reader(*this, Route::Reader);
+    Statement statement(*reader, aQuery);
+    if (!bKnown)
+      route = addRoute(statement);
+    if (Route::Reader == route) {
+      count(route, bKnown);
+      aTask(statement);
+      return;
+    }
+  }
+
+  Lease writer(*this, Route::Writer);
+  Statement statement(*writer, aQuery);
+  count(route, bKnown);
+  aTask(statement);
+}
+
+void RoutingDatabase::count(const Route aRoute, const bool abKnown) noexcept {
+  std::lock_guard<std::mutex> lock(mMutex);
+  ++((Route::Reader == aRoute) ? mStats.reads : mStats.writes);
+  if (abKnown)
+    ++mStats.routeHits;
+}
+
+void RoutingDatabase::withWriter(const std::function<void(Database&)>& aTask) {
+  Lease writer(*this, Route::Writer);
+  aTask(*writer);
+}
+
+void RoutingDatabase::forEachConnection(const std::function<void(Database&)>& aTask) {
+  withWriter(aTask);
+  for (const std::unique_ptr<Database>& reader : mReaders) {
+    // Wait for this very reader to be given back
+    std::unique_lock<std::mutex> lock(mMutex);
+    mReleased.wait(lock, [&] {
+      return std::find(mFreeReaders.begin(), mFreeReaders.end(), reader.get()) != mFreeReaders.end();
+    });
+    mFreeReaders.erase(std::find(mFreeReaders.begin(), mFreeReaders.end(), reader.get()));
+    lock.unlock();
+
+    try {
+      aTask(*reader);
+    } catch (...) {
+      release(*reader);
+      throw;
+    }
+    release(*reader);
+  }
+}
+
+void RoutingDatabase::scanPartitions(const std::string& aTable, const std::string& aColumns, const unsigned aPartitions,
+                                     const std::function<void(Statement&, std::size_t)>& aTask) {
+  const std::size_t partitions = getPartitionCount(aPartitions);
+
+  // Start the read transactions of the readers on the same state (the leases outlive their transactions)
+  std::vector<std::unique_ptr<Lease>> readers;
+  std::vector<std::unique_ptr<ReadTransaction>> transactions;
+  {
+    Lease writer(*this, Route::Writer); // no write of this facade commits in between
+    std::optional<Snapshot> snapshot;
+    for (std::size_t partition = 0; partition < partitions; ++partition) {
+      readers.emplace_back(new Lease(*this, Route::Reader));
+      Database& reader = **readers.back();
+      transactions.emplace_back(snapshot ? new ReadTransaction(reader, *snapshot) : new ReadTransaction(reader));
+      if ((0 == partition) && Snapshot::isAvailable()) {
+        // The first reader captures the snapshot opened by the others, to be immune to other processes (WAL mode only)
+        try {
+          snapshot.emplace(transactions.back()->getSnapshot());
+        } catch (const SQLite::Exception&) {
+          // not in WAL mode: holding the writer is enough
+        }
+      }
+    }
+  }
+
+  // Split the rowid range of this state into partitions of the same width
+  const std::string table = detail::quoteIdentifier(aTable);
+  long long first = 0;
+  unsigned long long span = 0;
+  {
+    Statement range(**readers[0], "SELECT min(rowid), max(rowid) FROM " + table);
+    range.executeStep();
+    if (range.isColumnNull(0))
+      return; // empty table
+    first = range.getColumn(0).getInt64();
+    span = static_cast<unsigned long long>(range.getColumn(1).getInt64()) - static_cast<unsigned long long>(first);
+  }
+  const unsigned long long width = span / partitions + 1;
+
+  // Scan each partition on its own reader and thread (the first one on the calling thread)
+  std::vector<std::exception_ptr> errors(partitions);
+  const auto scan = [&](const std::size_t aPartition) {
+    try {
+      Statement query(**readers[aPartition], "SELECT " + aColumns + " FROM " + table + " WHERE rowid BETWEEN ? AND ?");
+      const unsigned long long offset = aPartition * width;
+      if (offset <= span) {
+        query.bind(1, static_cast<long long>(static_cast<unsigned long long>(first) + offset));
+        query.bind(2, static_cast<long long>(static_cast<unsigned long long>(first) + std::min(offset + width - 1, span)));
+      } else {
+        query.bind(1, 1LL); // more partitions than rowids: empty partition
+        query.bind(2, 0LL);
+      }
+      aTask(query, aPartition);
+    } catch (...) {
+      errors[aPartition] = std::current_exception();
+    }
+  };
+  std::vector<std::thread> threads;
+  threads.reserve(partitions - 1);
+  for (std::size_t partition = 1; partition < partitions; ++partition)
+    threads.emplace_back(scan, partition);
+  scan(0);
+  for (std::thread& thread : threads)
+    thread.join();
+
+  for (const std::exception_ptr& error : errors) {
+    if (error)
+      std::rethrow_exception(error);
+  }
+}
+
+void RoutingDatabase::clearRoutes() {
+  std::lock_guard<std::mutex> lock(mMutex);
+  mRoutes.clear();
+}
+
+RoutingStats RoutingDatabase::getStats() const {
+  std::lock_guard<std::mutex> lock(mMutex);
+  RoutingStats stats = mStats;
+  stats.routes = mRoutes.size();
+  return stats;
+}
+
+} // namespace SQLite
@@ -0,0 +1,194 @@
+#include <sqlite3.h>
+#include <SQLiteCpp/Session.h>
+#include <SQLiteCpp/Exception.h>
+
+#include <exception>
+
+namespace SQLite {
+
+namespace {
+
+#ifdef SQLITE_ENABLE_SESSION
+
+/// Copy a buffer allocated by the session extension into a Changeset, and free it
+Changeset takeChangeset(const int aRet, const int aSize, void* apBuffer) {
+  if (SQLITE_OK != aRet) {
+    sqlite3_free(apBuffer);
+    throw SQLite::Exception("Cannot build the changeset", aRet);
+  }
+  const unsigned char* pData = static_cast<const unsigned char*>(apBuffer);
+  Changeset changeset(pData, pData + aSize);
+  sqlite3_free(apBuffer);
+  return changeset;
+}
+
+ConflictType toConflictType(const int aConflict) noexcept {
+  switch (aConflict) {
+  case SQLITE_CHANGESET_DATA:       return ConflictType::Data;
+  case SQLITE_CHANGESET_NOTFOUND:   return ConflictType::NotFound;
+  case SQLITE_CHANGESET_CONFLICT:   return ConflictType::Conflict;
+  case SQLITE_CHANGESET_CONSTRAINT: return ConflictType::Constraint;
+  default:                          return ConflictType::ForeignKey;
+  }
+}
+
+/// State of sqlite3changeset_apply() conflict callback
+struct ApplyContext {
+  const ConflictHandler&  handler;
+  std::exception_ptr      error;    ///< Exception thrown by the handler, rethrown once aborted
+};
+
+#else
+
+[[noreturn]] void throwUnavailable() {
+  throw SQLite::Exception("The session extension requires SQLITE_ENABLE_SESSION");
+}
+
+#endif // SQLITE_ENABLE_SESSION
+
+} // namespace
+
+Session::Session(Database& aDatabase, const std::string& aDbName /* = "main" */) :
+  mDatabase(aDatabase),
+  mDbName(aDbName),
+  mbEnabled(true),
+  mpSession(nullptr)
+{
+  // SQLite has a single preupdate hook per connection, used by all its sessions
+  if (mDatabase.mbPreupdateHook)
+    throw SQLite::Exception("Cannot create a session on a connection capturing the values of its changes (setChangeSink())");
+  create();
+  ++mDatabase.mSessionCount;
+}
+
+bool Session::isAvailable() noexcept {
+#ifdef SQLITE_ENABLE_SESSION
+  return true;
+#else
+  return false;
+#endif
+}
+
+#ifdef SQLITE_ENABLE_SESSION
+
+Session::~Session() {
+  sqlite3session_delete(mpSession);
+  --mDatabase.mSessionCount;
+}
+
+void Session::create() {
+  sqlite3_session* pSession = nullptr;
+  const int ret = sqlite3session_create(mDatabase.getHandle(), mDbName.c_str(), &pSession);
+  if (SQLITE_OK != ret)
+    throw SQLite::Exception(mDatabase.getHandle());
+  for (const std::string& table : mTables) {
+    const int attachRet = sqlite3session_attach(pSession, table.empty() ? nullptr : table.c_str());
+    if (SQLITE_OK != attachRet) {
+      sqlite3session_delete(pSession);
+      throw SQLite::Exception("Cannot attach the session to table " + table, attachRet);
+    }
+  }
+  sqlite3session_enable(pSession, mbEnabled ? 1 : 0);
+  if (mpSession) // sqlite3session_delete() does not accept NULL
+    sqlite3session_delete(mpSession);
+  mpSession = pSession;
+}
+
+void Session::attach(const std::string& aTable /* = std::string() */) {
+  const int ret = sqlite3session_attach(mpSession, aTable.empty() ? nullptr : aTable.c_str());
+  if (SQLITE_OK != ret)
+    throw SQLite::Exception("Cannot attach the session to table " + aTable, ret);
+  mTables.push_back(aTable);
+}
+
+void Session::setEnabled(const bool abEnabled) noexcept {
+  mbEnabled = abEnabled;
+  sqlite3session_enable(mpSession, abEnabled ? 1 : 0);
+}
+
+bool Session::isEmpty() const noexcept {
+  return 0 != sqlite3session_isempty(mpSession);
+}
+
+Changeset Session::changeset() const {
+  int size = 0;
+  void* pBuffer = nullptr;
+  const int ret = sqlite3session_changeset(mpSession, &size, &pBuffer);
+  return takeChangeset(ret, size, pBuffer);
+}
+
+Changeset Session::patchset() const {
+  int size = 0;
+  void* pBuffer = nullptr;
+  const int ret = sqlite3session_patchset(mpSession, &size, &pBuffer);
+  return takeChangeset(ret, size, pBuffer);
+}
+
+void Session::clear() {
+  create();
+}
+
+void applyChangeset(Database& aDatabase, const Changeset& aChangeset, const ConflictHandler& aHandler) {
+  ApplyContext context{aHandler, nullptr};
+  const int ret = sqlite3changeset_apply(aDatabase.getHandle(), static_cast<int>(aChangeset.size()),
+                                         const_cast<unsigned char*>(aChangeset.data()), nullptr,
+                                         [](void* apContext, int aConflict, sqlite3_changeset_iter* apIter) -> int {
+    ApplyContext& context = *static_cast<ApplyContext*>(apContext);
+    try {
+      const char* pTable = nullptr;
+      int columns = 0;
+      int operation = 0;
+      sqlite3changeset_op(apIter, &pTable, &columns, &operation, nullptr);
+      switch (context.handler(toConflictType(aConflict), pTable ? pTable : "")) {
+      case ConflictAction::Omit:
+        return SQLITE_CHANGESET_OMIT;
+      case ConflictAction::Replace:
+        // REPLACE is a misuse for the other types of conflict
+        if ((SQLITE_CHANGESET_DATA == aConflict) || (SQLITE_CHANGESET_CONFLICT == aConflict))
+          return SQLITE_CHANGESET_REPLACE;
+        return SQLITE_CHANGESET_OMIT;
+      default:
+        return SQLITE_CHANGESET_ABORT;
+      }
+    } catch (...) {
+      context.error = std::current_exception();
+      return SQLITE_CHANGESET_ABORT;
+    }
+  }, &context);
+
+  if (context.error)
+    std::rethrow_exception(context.error);
+  if (SQLITE_ABORT == ret)
+    throw SQLite::Exception("Changeset aborted on a conflict", ret);
+  if (SQLITE_OK != ret)
+    throw SQLite::Exception(aDatabase.getHandle());
+}
+
+Changeset invertChangeset(const Changeset& aChangeset) {
+  int size = 0;
+  void* pBuffer = nullptr;
+  const int ret = sqlite3changeset_invert(static_cast<int>(aChangeset.size()), aChangeset.data(), &size, &pBuffer);
+  return takeChangeset(ret, size, pBuffer);
+}
+
+#else
+
+Session::~Session() = default;
+void Session::create() { throwUnavailable(); }
+void Session::attach(const std::string&) { throwUnavailable(); }
+void Session::setEnabled(bool) noexcept {}
+bool Session::isEmpty() const noexcept { return true; }
+Changeset Session::changeset() const { throwUnavailable(); }
+Changeset Session::patchset() const { throwUnavailable(); }
+void Session::clear() { throwUnavailable(); }
+void applyChangeset(Database&, const Changeset&, const ConflictHandler&) { throwUnavailable(); }
+Changeset invertChangeset(const Changeset&) { throwUnavailable(); }
+
+#endif // SQLITE_ENABLE_SESSION
+
+void applyChangeset(Database& aDatabase, const Changeset& aChangeset,
+                    const ConflictAction aPolicy /* = ConflictAction::Abort */) {
+  applyChangeset(aDatabase, aChangeset, [aPolicy](ConflictType, const std::string&) { return aPolicy; });
+}
+
+} // namespace SQLite
@@ -0,0 +1,146 @@
+#include <sqlite3.h>
+#include <SQLiteCpp/ShardedDatabase.h>
+#include <SQLiteCpp/Exception.h>
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+namespace SQLite {
+
+/// Fixed pool of threads running the per-shard tasks of the fan-out
+class ShardedDatabase::Pool {
+public:
+  explicit Pool(unsigned aThreads) {
+    for (unsigned i = 0; i < aThreads; ++i)
+      mThreads.emplace_back([this] { run(); });
+  }
+
+  ~Pool() {
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mbStop = true;
+    }
+    mCondition.notify_all();
+    for (std::thread& thread : mThreads)
+      thread.join();
+  }
+
+  Pool(const Pool&) = delete;
+  Pool& operator=(const Pool&) = delete;
+
+  /// Run aTask(i) for each i in [0, aCount) on the threads, wait for all of them, and rethrow the first exception
+  void runAll(std::size_t aCount, const std::function<void(std::size_t)>& aTask) {
+    std::mutex mutex;
+    std::condition_variable done;
+    std::size_t remaining = aCount;
+    std::exception_ptr error;
+
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      for (std::size_t i = 0; i < aCount; ++i) {
+        mTasks.emplace_back([&, i] {
+          std::exception_ptr taskError;
+          try {
+            aTask(i);
+          } catch (...) {
+            taskError = std::current_exception();
+          }
+          std::lock_guard<std::mutex> doneLock(mutex);
+          if (taskError && !error)
+            error = taskError;
+          if (0 == --remaining)
+            done.notify_one();
+        });
+      }
+    }
+    mCondition.notify_all();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [&] { return 0 == remaining; });
+    if (error)
+      std::rethrow_exception(error);
+  }
+
+private:
+  void run() {
+    for (;;) {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mCondition.wait(lock, [this] { return mbStop || !mTasks.empty(); });
+        if (mTasks.empty())
+          return; // stopped
+        task = std::move(mTasks.front());
+        mTasks.pop_front();
+      }
+      task();
+    }
+  }
+
+  std::vector<std::thread>          mThreads;
+  std::deque<std::function<void()>> mTasks;
+  std::mutex                        mMutex;
+  std::condition_variable           mCondition;
+  bool                              mbStop = false;
+};
+
+namespace {
+
+/// Default hash: the finalizer of SplitMix64, spreading sequential keys over the shards
+std::size_t mixKey(long long aKey) {
+  unsigned long long x = static_cast<unsigned long long>(aKey);
+  x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+  x = x ^ (x >> 31);
+  return static_cast<std::size_t>(x);
+}
+
+} // namespace
+
+ShardedDatabase::ShardedDatabase(const std::vector<std::string>& aFilenames, const int aFlags,
+                                 HashFunction aHash, const unsigned aThreads) :
+  mHash(aHash ? std::move(aHash) : HashFunction(mixKey))
+{
+  if (aFilenames.empty())
+    throw SQLite::Exception("A ShardedDatabase needs at least one shard");
+
+  mShards.reserve(aFilenames.size());
+  for (const std::string& filename : aFilenames)
+    mShards.emplace_back(new Database(filename, aFlags));
+
+  unsigned threads = aThreads;
+  if (0 == threads) {
+    const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    threads = static_cast<unsigned>(std::min<std::size_t>(mShards.size(), cores));
+  }
+  mpPool.reset(new Pool(threads));
+}
+
+// Defined here, where Pool is a complete type
+ShardedDatabase::~ShardedDatabase() = default;
+
+std::size_t ShardedDatabase::getShardIndex(const long long aKey) const {
+  return mHash(aKey) % mShards.size();
+}
+
+void ShardedDatabase::forEachShard(const std::function<void(Database&, std::size_t)>& aTask) {
+  mpPool->runAll(mShards.size(), [&](std::size_t aIndex) {
+    aTask(*mShards[aIndex], aIndex);
+  });
+}
+
+int ShardedDatabase::exec(const std::string& aQueries) {
+  std::vector<int> changes(mShards.size(), 0);
+  forEachShard([&](Database& aShard, std::size_t aIndex) {
+    changes[aIndex] = aShard.exec(aQueries);
+  });
+  int total = 0;
+  for (const int change : changes)
+    total += change;
+  return total;
+}
+
+} // namespace SQLite
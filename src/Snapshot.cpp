@@ -0,0 +1,120 @@
+#include <sqlite3.h>
+#include <SQLiteCpp/Snapshot.h>
+#include <SQLiteCpp/Exception.h>
+#include "Identifier.h"
+
+#include <utility>
+
+namespace SQLite {
+
+#ifndef SQLITE_ENABLE_SNAPSHOT
+
+namespace {
+
+[[noreturn]] void throwUnavailable() {
+  throw SQLite::Exception("Snapshots require SQLITE_ENABLE_SNAPSHOT");
+}
+
+} // namespace
+
+#endif // SQLITE_ENABLE_SNAPSHOT
+
+Snapshot::Snapshot(Database& aDatabase, const std::string& aDbName /* = "main" */) :
+  mDbName(aDbName)
+{
+#ifdef SQLITE_ENABLE_SNAPSHOT
+  const int ret = sqlite3_snapshot_get(aDatabase.getHandle(), mDbName.c_str(), &mpSnapshot);
+  if (SQLITE_OK != ret)
+    throw SQLite::Exception("Cannot get the snapshot of " + mDbName + " (WAL mode and a read transaction are required)", ret);
+#else
+  (void)aDatabase;
+  throwUnavailable();
+#endif
+}
+
+Snapshot::~Snapshot() {
+#ifdef SQLITE_ENABLE_SNAPSHOT
+  if (mpSnapshot)
+    sqlite3_snapshot_free(mpSnapshot);
+#endif
+}
+
+Snapshot::Snapshot(Snapshot&& aOther) noexcept :
+  mDbName(std::move(aOther.mDbName)),
+  mpSnapshot(aOther.mpSnapshot)
+{
+  aOther.mpSnapshot = nullptr;
+}
+
+Snapshot& Snapshot::operator=(Snapshot&& aOther) noexcept {
+  std::swap(mDbName, aOther.mDbName);
+  std::swap(mpSnapshot, aOther.mpSnapshot);
+  return *this;
+}
+
+bool Snapshot::isAvailable() noexcept {
+#ifdef SQLITE_ENABLE_SNAPSHOT
+  return true;
+#else
+  return false;
+#endif
+}
+
+int Snapshot::compare(const Snapshot& aOther) const noexcept {
+#ifdef SQLITE_ENABLE_SNAPSHOT
+  return sqlite3_snapshot_cmp(mpSnapshot, aOther.mpSnapshot);
+#else
+  (void)aOther;
+  return 0; // no snapshot can be constructed
+#endif
+}
+
+ReadTransaction::ReadTransaction(Database& aDatabase, const std::string& aDbName /* = "main" */) :
+  mDatabase(aDatabase),
+  mDbName(aDbName),
+  mbEnded(false)
+{
+  mDatabase.exec("BEGIN");
+  try {
+    // A deferred transaction starts reading at its first read: read the schema version now, to fix the state
+    mDatabase.exec("PRAGMA " + detail::quoteIdentifier(mDbName) + ".schema_version");
+  } catch (SQLite::Exception&) {
+    mDatabase.tryExec("ROLLBACK");
+    throw;
+  }
+}
+
+ReadTransaction::ReadTransaction(Database& aDatabase, const Snapshot& aSnapshot) :
+  mDatabase(aDatabase),
+  mDbName(aSnapshot.getDbName()),
+  mbEnded(false)
+{
+#ifdef SQLITE_ENABLE_SNAPSHOT
+  mDatabase.exec("BEGIN");
+  const int ret = sqlite3_snapshot_open(mDatabase.getHandle(), mDbName.c_str(), aSnapshot.getHandle());
+  if (SQLITE_OK != ret) {
+    mDatabase.tryExec("ROLLBACK");
+    throw SQLite::Exception("Cannot open the snapshot of " + mDbName, ret);
+  }
+#else
+  throwUnavailable();
+#endif
+}
+
+ReadTransaction::~ReadTransaction() {
+  if (!mbEnded)
+    mDatabase.tryExec("COMMIT"); // never throw in a destructor: nothing to lose for a read transaction
+}
+
+Snapshot ReadTransaction::getSnapshot() const {
+  return Snapshot(mDatabase, mDbName);
+}
+
+void ReadTransaction::end() {
+  if (mbEnded)
+    throw SQLite::Exception("Read transaction already ended.");
+  mDatabase.exec("COMMIT");
+  mbEnded = true;
+}
+
+} // namespace SQLite
@@ -4,20 +4,112 @@
 #include <SQLiteCpp/Column.h>
 #include <SQLiteCpp/Assertion.h>
 #include <SQLiteCpp/Exception.h>
+#include <SQLiteCpp/VirtualTable.h>
+
+#include <condition_variable>
+#include <mutex>
 
 using namespace std;
 
 namespace SQLite {
 
+namespace {
+
+// Build the tree of the children of aParent from the flat list of EXPLAIN QUERY PLAN rows
+QueryPlan buildPlanTree(const vector<QueryPlanNode>& aNodes, const int aParent) {
+  QueryPlan tree;
+  for (const QueryPlanNode& node : aNodes) {
+    if (node.parent == aParent) {
+      tree.push_back(node);
+      tree.back().children = buildPlanTree(aNodes, node.id);
+    }
+  }
+  return tree;
+}
+
+// If aRet is a table lock of a shared cache, wait for the end of the transaction holding it:
+// return true once the statement (or its preparation) can be retried, see Database::setWaitForUnlock()
+bool waitForUnlock(const int aRet, sqlite3* apSQLite) noexcept {
+#ifdef SQLITE_ENABLE_UNLOCK_NOTIFY
+  if ((SQLITE_LOCKED != (aRet & 0xff)) || (SQLITE_LOCKED_SHAREDCACHE != sqlite3_extended_errcode(apSQLite)))
+    return false;
+
+  struct Notification {
+    std::mutex              mutex;
+    std::condition_variable unlocked;
+    bool                    bUnlocked = false;
+  } notification;
+  // The callback is invoked by the blocking connection, from another thread (or right away if already unlocked)
+  const int ret = sqlite3_unlock_notify(apSQLite, [](void** apArgs, int aCount) {
+    for (int i = 0; i < aCount; ++i) {
+      Notification& waiting = *static_cast<Notification*>(apArgs[i]);
+      lock_guard<std::mutex> lock(waiting.mutex);
+      waiting.bUnlocked = true;
+      waiting.unlocked.notify_one();
+    }
+  }, &notification);
+  if (SQLITE_OK != ret)
+    return false; // SQLITE_LOCKED: waiting would deadlock
+
+  unique_lock<std::mutex> lock(notification.mutex);
+  notification.unlocked.wait(lock, [&] { return notification.bUnlocked; });
+  return true;
+#else
+  (void)aRet;
+  (void)apSQLite;
+  return false;
+#endif
+}
+
+} // namespace
+
 // Compile and register the SQL query for the provided SQLite Database Connection
 Statement::Statement(Database &aDatabase, const std::string& aQuery) :
+    mDatabase(aDatabase),
     mQuery(aQuery),
-    mStmtPtr(aDatabase.mpSQLite, mQuery), // prepare the SQL query, and ref count (needs Database friendship)
+    mStmtPtr(aDatabase.mpSQLite, mQuery, aDatabase.mbWaitForUnlock), // prepare the SQL query, and ref count (needs Database friendship)
     mColumnCount(0),
     mbHasRow(false),
     mbDone(false)
 {
   mColumnCount = sqlite3_column_count(mStmtPtr);
+
+  // Opt-in debug mode checking the query plan of each new statement (needs Database friendship)
+  if (aDatabase.mpPlanChecker)
+    aDatabase.checkPlan(*this);
+}
+
+// Take ownership of a statement already prepared by tryPrepare()
+Statement::Statement(Database &aDatabase, const std::string& aQuery, sqlite3_stmt*& apStmt) :
+    mDatabase(aDatabase),
+    mQuery(aQuery),
+    mStmtPtr(aDatabase.mpSQLite, apStmt),
+    mColumnCount(0),
+    mbHasRow(false),
+    mbDone(false)
+{
+  mColumnCount = sqlite3_column_count(mStmtPtr);
+
+  if (aDatabase.mpPlanChecker)
+    aDatabase.checkPlan(*this);
+}
+
+// Compile the SQL query, returning the result code instead of throwing
+Expected<std::unique_ptr<Statement>> Statement::tryPrepare(Database& aDatabase, const std::string& aQuery) {
+  sqlite3_stmt* pStmt = NULL;
+  int ret = sqlite3_prepare_v2(aDatabase.mpSQLite, aQuery.c_str(), static_cast<int>(aQuery.size()), &pStmt, NULL);
+  while (aDatabase.mbWaitForUnlock && waitForUnlock(ret, aDatabase.mpSQLite))
+    ret = sqlite3_prepare_v2(aDatabase.mpSQLite, aQuery.c_str(), static_cast<int>(aQuery.size()), &pStmt, NULL);
+  if (SQLITE_OK != ret)
+    return Expected<std::unique_ptr<Statement>>(Result(ret, aDatabase.mpSQLite));
+
+  try {
+    std::unique_ptr<Statement> statement(new Statement(aDatabase, aQuery, pStmt));
+    return Expected<std::unique_ptr<Statement>>(std::move(statement), Result(SQLITE_OK, aDatabase.mpSQLite));
+  } catch (...) {
+    sqlite3_finalize(pStmt); // not owned yet by a Statement if NULL
+    throw;
+  }
 }
 
 // Finalize and unregister the SQL query from the SQLite Database Connection.
@@ -34,7 +126,10 @@ void Statement::reset() {
 int Statement::tryReset() noexcept {
   mbHasRow = false;
   mbDone = false;
-  return sqlite3_reset(mStmtPtr);
+  mbStarted = false;
+  const int ret = sqlite3_reset(mStmtPtr);
+  mDatabase.onStatementEnd(); // resetting a statement may end its (autocommit) transaction
+  return ret;
 }
 
 // Clears away all the bindings of a prepared statement (can be associated with #reset() above).
@@ -120,16 +215,130 @@ void Statement::bind(const int aIndex) {
   check(ret);
 }
 
+// Bind an array of integers to a parameter "?", "?NNN", ":VVV", "@VVV" or "$VVV" in the SQL prepared statement
+void Statement::bindArray(const int aIndex, Span<const long long> aValues) {
+  const int ret = detail::bindArray(mStmtPtr, aIndex, detail::ArrayType::INT64, aValues.data(), aValues.size());
+  check(ret);
+}
+
+// Bind an array of std::int64_t (same 64bits representation as long long) to a parameter
+void Statement::bindArray(const int aIndex, Span<const detail::DistinctInt64> aValues) {
+  static_assert(sizeof(std::int64_t) == sizeof(long long), "The INT64 arrays are read as long long");
+  const int ret = detail::bindArray(mStmtPtr, aIndex, detail::ArrayType::INT64, aValues.data(), aValues.size());
+  check(ret);
+}
+
+// Bind an array of floating point values to a parameter "?", "?NNN", ":VVV", "@VVV" or "$VVV" in the SQL prepared statement
+void Statement::bindArray(const int aIndex, Span<const double> aValues) {
+  const int ret = detail::bindArray(mStmtPtr, aIndex, detail::ArrayType::DOUBLE, aValues.data(), aValues.size());
+  check(ret);
+}
+
+// Bind an array of UTF-8 strings to a parameter "?", "?NNN", ":VVV", "@VVV" or "$VVV" in the SQL prepared statement
+void Statement::bindArray(const int aIndex, Span<const std::string_view> aValues) {
+  const int ret = detail::bindArray(mStmtPtr, aIndex, detail::ArrayType::TEXT, aValues.data(), aValues.size());
+  check(ret);
+}
+
+// Bind a 32bits unsigned int value to a parameter "?NNN", ":VVV", "@VVV" or "$VVV" in the SQL prepared statement
+void Statement::bind(string const &apName, const unsigned aValue) {
+  bind(sqlite3_bind_parameter_index(mStmtPtr, apName.c_str()), aValue);
+}
+
+// Bind a 64bits int value to a parameter "?NNN", ":VVV", "@VVV" or "$VVV" in the SQL prepared statement
+void Statement::bind(string const &apName, const long long aValue) {
+  bind(sqlite3_bind_parameter_index(mStmtPtr, apName.c_str()), aValue);
+}
+
+// Bind a double (64bits float) value to a parameter "?NNN", ":VVV", "@VVV" or "$VVV" in the SQL prepared statement
+void Statement::bind(string const &apName, const double aValue) {
+  bind(sqlite3_bind_parameter_index(mStmtPtr, apName.c_str()), aValue);
+}
+
+// Bind a string value to a parameter "?NNN", ":VVV", "@VVV" or "$VVV" in the SQL prepared statement
+void Statement::bind(string const &apName, const string& aValue) {
+  bind(sqlite3_bind_parameter_index(mStmtPtr, apName.c_str()), aValue);
+}
+
+// Bind a binary blob value to a parameter "?NNN", ":VVV", "@VVV" or "$VVV" in the SQL prepared statement
+void Statement::bind(string const &apName, const void* apValue, const int aSize) {
+  bind(sqlite3_bind_parameter_index(mStmtPtr, apName.c_str()), apValue, aSize);
+}
+
+// Bind a NULL value to a parameter "?NNN", ":VVV", "@VVV" or "$VVV" in the SQL prepared statement
+void Statement::bind(string const &apName) {
+  bind(sqlite3_bind_parameter_index(mStmtPtr, apName.c_str()));
+}
+
+// Bind an array of integers to a named parameter "?NNN", ":VVV", "@VVV" or "$VVV" in the SQL prepared statement
+void Statement::bindArray(string const &apName, Span<const long long> aValues) {
+  bindArray(sqlite3_bind_parameter_index(mStmtPtr, apName.c_str()), aValues);
+}
+
+// Bind an array of std::int64_t to a named parameter "?NNN", ":VVV", "@VVV" or "$VVV" in the SQL prepared statement
+void Statement::bindArray(string const &apName, Span<const detail::DistinctInt64> aValues) {
+  bindArray(sqlite3_bind_parameter_index(mStmtPtr, apName.c_str()), aValues);
+}
+
+// Bind an array of floating point values to a named parameter "?NNN", ":VVV", "@VVV" or "$VVV" in the SQL prepared statement
+void Statement::bindArray(string const &apName, Span<const double> aValues) {
+  bindArray(sqlite3_bind_parameter_index(mStmtPtr, apName.c_str()), aValues);
+}
+
+// Bind an array of UTF-8 strings to a named parameter "?NNN", ":VVV", "@VVV" or "$VVV" in the SQL prepared statement
+void Statement::bindArray(string const &apName, Span<const std::string_view> aValues) {
+  bindArray(sqlite3_bind_parameter_index(mStmtPtr, apName.c_str()), aValues);
+}
+
+// Non-throwing variants of bind(), returning the result code
+Result Statement::tryBind(const int aIndex, const int aValue) noexcept {
+  return Result(sqlite3_bind_int(mStmtPtr, aIndex, aValue), mStmtPtr);
+}
+
+Result Statement::tryBind(const int aIndex, const long long aValue) noexcept {
+  return Result(sqlite3_bind_int64(mStmtPtr, aIndex, aValue), mStmtPtr);
+}
+
+Result Statement::tryBind(const int aIndex, const double aValue) noexcept {
+  return Result(sqlite3_bind_double(mStmtPtr, aIndex, aValue), mStmtPtr);
+}
+
+Result Statement::tryBind(const int aIndex, const std::string& aValue) noexcept {
+  return Result(sqlite3_bind_text(mStmtPtr, aIndex, aValue.c_str(), static_cast<int>(aValue.size()), SQLITE_TRANSIENT),
+                mStmtPtr);
+}
+
+Result Statement::tryBind(const int aIndex, const char* apValue) noexcept {
+  return Result(sqlite3_bind_text(mStmtPtr, aIndex, apValue, -1, SQLITE_TRANSIENT), mStmtPtr);
+}
+
+Result Statement::tryBind(const int aIndex, const void* apValue, const int aSize) noexcept {
+  return Result(sqlite3_bind_blob(mStmtPtr, aIndex, apValue, aSize, SQLITE_TRANSIENT), mStmtPtr);
+}
+
+Result Statement::tryBind(const int aIndex) noexcept {
+  return Result(sqlite3_bind_null(mStmtPtr, aIndex), mStmtPtr);
+}
+
 // Execute a step of the query to fetch one row of results
 bool Statement::executeStep() {
   const int ret = tryExecuteStep();
 
   if ((SQLITE_ROW != ret) && (SQLITE_DONE != ret)) // on row or no (more) row ready, else it's a problem
-    throw SQLite::Exception(mStmtPtr);
+    throwStepError();
 
   return mbHasRow; // true only if one row is accessible by getColumn(N)
 }
 
+// Execute a one-step query with no expected result, returning the result code instead of throwing
+Expected<int> Statement::tryExec() noexcept {
+  const int ret = tryExecuteStep();
+  if (SQLITE_DONE != ret)
+    return Expected<int>(Result((SQLITE_ROW == ret) ? SQLITE_MISUSE : ret, mStmtPtr));
+
+  return Expected<int>(sqlite3_changes(mStmtPtr), Result(ret, mStmtPtr));
+}
+
 // Execute a one-step query with no expected result
 int Statement::exec() {
   const int ret = tryExecuteStep();
@@ -138,7 +347,7 @@ int Statement::exec() {
     if (SQLITE_ROW == ret)
       throw SQLite::Exception("exec() does not expect results. Use executeStep.");
     else
-      throw SQLite::Exception(mStmtPtr);
+      throwStepError();
   }
 
   // Return the number of rows modified by those SQL statements (INSERT, UPDATE or DELETE)
@@ -148,7 +357,20 @@ int Statement::exec() {
 int Statement::tryExecuteStep() noexcept {
   if (false == mbDone)
   {
-      const int ret = sqlite3_step(mStmtPtr);
+      mInterruption = Interruption::None;
+      const bool bWatched = (mTimeout.count() > 0 || mCancellationToken);
+      // The changes of a statement are made by its first step: the ones to discard if it fails
+      const std::size_t changesMark = (mDatabase.mpChangeCapture && (0 == sqlite3_stmt_busy(mStmtPtr)))
+                                    ? mDatabase.getChangesMark() : static_cast<std::size_t>(-1);
+      int ret = bWatched ? watchedStep() : sqlite3_step(mStmtPtr);
+      while (mDatabase.mbWaitForUnlock && waitForUnlock(ret, mStmtPtr))
+      {
+          sqlite3_reset(mStmtPtr); // the table locks are taken before reading any row: restart the statement
+          ret = bWatched ? watchedStep() : sqlite3_step(mStmtPtr);
+      }
+      if (mDatabase.mpChangeCapture)
+          mDatabase.onCapturedStatement(mStmtPtr, ret, changesMark);
+      mDatabase.onStatementEnd(); // deliver the changes if this step committed a transaction
       if (SQLITE_ROW == ret) // one row is ready : call getColumn(N) to access it
       {
           mbHasRow = true;
@@ -173,6 +395,43 @@ int Statement::tryExecuteStep() noexcept {
   }
 }
 
+// Step with the deadline and cancellation token checked by a progress handler
+int Statement::watchedStep() noexcept {
+  if (!mbStarted) {
+    mbStarted = true;
+    mDeadline = std::chrono::steady_clock::now() + mTimeout;
+  }
+
+  int ret;
+  if (mCancellationToken.isCancelled()) {
+    mInterruption = Interruption::Cancelled;
+    ret = SQLITE_INTERRUPT;
+  } else {
+    // The progress handler is per connection: install it only for the duration of this step
+    sqlite3* pSQLite = mStmtPtr;
+    sqlite3_progress_handler(pSQLite, mDatabase.mCancellationCheckInterval, [](void* apStatement) -> int {
+      Statement& statement = *static_cast<Statement*>(apStatement);
+      if (statement.mCancellationToken.isCancelled())
+        statement.mInterruption = Interruption::Cancelled;
+      else if ((statement.mTimeout.count() > 0) && (std::chrono::steady_clock::now() >= statement.mDeadline))
+        statement.mInterruption = Interruption::Timeout;
+      return (Interruption::None != statement.mInterruption) ? 1 : 0; // non-zero interrupts the statement
+    }, this);
+    ret = sqlite3_step(mStmtPtr);
+    sqlite3_progress_handler(pSQLite, 0, nullptr, nullptr);
+  }
+  return ret;
+}
+
+// Throw the SQLite::Exception of a failed step
+void Statement::throwStepError() const {
+  if (Interruption::Timeout == mInterruption)
+    throw SQLite::TimeoutException("Statement interrupted: timeout of " + std::to_string(mTimeout.count()) + "ms");
+  if ((Interruption::Cancelled == mInterruption) || (SQLITE_INTERRUPT == sqlite3_errcode(mStmtPtr)))
+    throw SQLite::CancelledException("Statement interrupted: cancelled");
+  throw SQLite::Exception(mStmtPtr);
+}
+
 // Return a copy of the column data specified by its index starting at 0
 // (use the Column copy-constructor)
 Column Statement::getColumn(const int aIndex) {
@@ -240,6 +499,11 @@ int Statement::getColumnIndex(string const &apName) const {
   return (*iIndex).second;
 }
 
+// true if the statement makes no direct change to the database files
+bool Statement::isReadOnly() const noexcept {
+  return 0 != sqlite3_stmt_readonly(mStmtPtr);
+}
+
 // Return the numeric result code for the most recent failed API call (if any).
 int Statement::getErrorCode() const noexcept {
   return sqlite3_errcode(mStmtPtr);
@@ -253,6 +517,51 @@ string Statement::getErrorMsg() const noexcept {
   return sqlite3_errmsg(mStmtPtr);
 }
 
+// Return the runtime counters of the statement
+StatementStatus Statement::getStatus(bool abReset /* = false */) noexcept {
+  return getStatus(mStmtPtr, abReset);
+}
+
+// Read the runtime counters of any SQLite prepared statement
+StatementStatus Statement::getStatus(sqlite3_stmt* apStmt, bool abReset) noexcept {
+  const int reset = abReset ? 1 : 0;
+  StatementStatus status;
+  status.fullscanSteps = sqlite3_stmt_status(apStmt, SQLITE_STMTSTATUS_FULLSCAN_STEP, reset);
+  status.sorts         = sqlite3_stmt_status(apStmt, SQLITE_STMTSTATUS_SORT, reset);
+  status.autoIndexes   = sqlite3_stmt_status(apStmt, SQLITE_STMTSTATUS_AUTOINDEX, reset);
+  status.vmSteps       = sqlite3_stmt_status(apStmt, SQLITE_STMTSTATUS_VM_STEP, reset);
+  status.reprepares    = sqlite3_stmt_status(apStmt, SQLITE_STMTSTATUS_REPREPARE, reset);
+  status.runs          = sqlite3_stmt_status(apStmt, SQLITE_STMTSTATUS_RUN, reset);
+  status.memUsed       = sqlite3_stmt_status(apStmt, SQLITE_STMTSTATUS_MEMUSED, 0);
+  return status;
+}
+
+// Run EXPLAIN QUERY PLAN for the SQL query of this statement and return the plan as a tree.
+QueryPlan Statement::explainPlan() const {
+  sqlite3* pSQLite = mStmtPtr;
+  const string explain = "EXPLAIN QUERY PLAN " + mQuery;
+  sqlite3_stmt* pStmt = nullptr;
+  int ret = sqlite3_prepare_v2(pSQLite, explain.c_str(), static_cast<int>(explain.size()), &pStmt, nullptr);
+  if (SQLITE_OK != ret)
+    throw SQLite::Exception(pSQLite);
+
+  // Each row is (id, parent, notused, detail)
+  vector<QueryPlanNode> nodes;
+  while (SQLITE_ROW == (ret = sqlite3_step(pStmt))) {
+    const char* pDetail = reinterpret_cast<const char*>(sqlite3_column_text(pStmt, 3));
+    nodes.push_back(QueryPlanNode{sqlite3_column_int(pStmt, 0), sqlite3_column_int(pStmt, 1),
+                                  pDetail ? pDetail : "", {}});
+  }
+  if (SQLITE_DONE != ret) {
+    const SQLite::Exception exception(pSQLite);
+    sqlite3_finalize(pStmt);
+    throw exception;
+  }
+  sqlite3_finalize(pStmt);
+
+  return buildPlanTree(nodes, 0);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Internal class : shared pointer to the sqlite3_stmt SQLite Statement Object
 ////////////////////////////////////////////////////////////////////////////////
@@ -260,15 +569,18 @@ string Statement::getErrorMsg() const noexcept {
 /**
  * @brief Prepare the statement and initialize its reference counter
  *
- * @param[in] apSQLite  The sqlite3 database connexion
- * @param[in] aQuery    The SQL query string to prepare
+ * @param[in] apSQLite          The sqlite3 database connexion
+ * @param[in] aQuery            The SQL query string to prepare
+ * @param[in] abWaitForUnlock   Wait for the table locks of a shared cache, see Database::setWaitForUnlock()
  */
-Statement::Ptr::Ptr(sqlite3* apSQLite, std::string& aQuery) :
+Statement::Ptr::Ptr(sqlite3* apSQLite, std::string& aQuery, const bool abWaitForUnlock) :
     mpSQLite(apSQLite),
     mpStmt(NULL),
     mpRefCount(NULL)
 {
-  const int ret = sqlite3_prepare_v2(apSQLite, aQuery.c_str(), static_cast<int>(aQuery.size()), &mpStmt, NULL);
+  int ret = sqlite3_prepare_v2(apSQLite, aQuery.c_str(), static_cast<int>(aQuery.size()), &mpStmt, NULL);
+  while (abWaitForUnlock && waitForUnlock(ret, apSQLite))
+    ret = sqlite3_prepare_v2(apSQLite, aQuery.c_str(), static_cast<int>(aQuery.size()), &mpStmt, NULL);
   if (SQLITE_OK != ret)
     throw SQLite::Exception(apSQLite);
 
@@ -278,6 +590,20 @@ Statement::Ptr::Ptr(sqlite3* apSQLite, std::string& aQuery) :
   mpRefCount = new unsigned int(1);  // NOLINT(readability/casting)
 }
 
+/**
+ * @brief Take ownership of a statement already prepared, and initialize its reference counter
+ *
+ * @param[in]     apSQLite  the SQLite Database Connection
+ * @param[in,out] apStmt    the prepared statement, set to NULL once owned (not if the allocation fails)
+ */
+Statement::Ptr::Ptr(sqlite3* apSQLite, sqlite3_stmt*& apStmt) :
+    mpSQLite(apSQLite),
+    mpStmt(apStmt),
+    mpRefCount(new unsigned int(1))  // NOLINT(readability/casting)
+{
+  apStmt = NULL;
+}
+
 /**
  * @brief Copy constructor increments the ref counter
  *
@@ -0,0 +1,60 @@
+#include <sqlite3.h>
+#include <SQLiteCpp/Status.h>
+#include <SQLiteCpp/Exception.h>
+
+namespace SQLite {
+
+// Return the difference between two snapshots of connection statistics
+DatabaseStatus operator-(const DatabaseStatus& aAfter, const DatabaseStatus& aBefore) noexcept {
+  DatabaseStatus delta;
+  delta.cacheHit          = aAfter.cacheHit - aBefore.cacheHit;
+  delta.cacheMiss         = aAfter.cacheMiss - aBefore.cacheMiss;
+  delta.cacheWrite        = aAfter.cacheWrite - aBefore.cacheWrite;
+  delta.cacheSpill        = aAfter.cacheSpill - aBefore.cacheSpill;
+  delta.cacheUsed         = aAfter.cacheUsed - aBefore.cacheUsed;
+  delta.lookasideUsed     = aAfter.lookasideUsed - aBefore.lookasideUsed;
+  delta.lookasideHit      = aAfter.lookasideHit - aBefore.lookasideHit;
+  delta.lookasideMissSize = aAfter.lookasideMissSize - aBefore.lookasideMissSize;
+  delta.lookasideMissFull = aAfter.lookasideMissFull - aBefore.lookasideMissFull;
+  delta.schemaUsed        = aAfter.schemaUsed - aBefore.schemaUsed;
+  delta.stmtUsed          = aAfter.stmtUsed - aBefore.stmtUsed;
+  return delta;
+}
+
+// Return the difference between two snapshots of process-wide statistics
+MemoryStatus operator-(const MemoryStatus& aAfter, const MemoryStatus& aBefore) noexcept {
+  MemoryStatus delta;
+  delta.memoryUsed                 = aAfter.memoryUsed - aBefore.memoryUsed;
+  delta.memoryUsedHighwater        = aAfter.memoryUsedHighwater - aBefore.memoryUsedHighwater;
+  delta.mallocCount                = aAfter.mallocCount - aBefore.mallocCount;
+  delta.mallocCountHighwater       = aAfter.mallocCountHighwater - aBefore.mallocCountHighwater;
+  delta.mallocSizeHighwater        = aAfter.mallocSizeHighwater - aBefore.mallocSizeHighwater;
+  delta.pagecacheUsed              = aAfter.pagecacheUsed - aBefore.pagecacheUsed;
+  delta.pagecacheOverflow          = aAfter.pagecacheOverflow - aBefore.pagecacheOverflow;
+  delta.pagecacheOverflowHighwater = aAfter.pagecacheOverflowHighwater - aBefore.pagecacheOverflowHighwater;
+  return delta;
+}
+
+// Return a snapshot of the process-wide memory statistics of the SQLite library.
+MemoryStatus getMemoryStatus(bool abReset /* = false */) {
+  const int reset = abReset ? 1 : 0;
+  MemoryStatus status;
+  sqlite3_int64 unused = 0;
+
+  int ret = sqlite3_status64(SQLITE_STATUS_MEMORY_USED, &status.memoryUsed, &status.memoryUsedHighwater, reset);
+  if (SQLITE_OK == ret)
+    ret = sqlite3_status64(SQLITE_STATUS_MALLOC_COUNT, &status.mallocCount, &status.mallocCountHighwater, reset);
+  if (SQLITE_OK == ret)
+    ret = sqlite3_status64(SQLITE_STATUS_MALLOC_SIZE, &unused, &status.mallocSizeHighwater, reset);
+  if (SQLITE_OK == ret)
+    ret = sqlite3_status64(SQLITE_STATUS_PAGECACHE_USED, &status.pagecacheUsed, &unused, reset);
+  if (SQLITE_OK == ret)
+    ret = sqlite3_status64(SQLITE_STATUS_PAGECACHE_OVERFLOW, &status.pagecacheOverflow,
+                           &status.pagecacheOverflowHighwater, reset);
+  if (SQLITE_OK != ret)
+    throw SQLite::Exception(sqlite3_errstr(ret));
+
+  return status;
+}
+
+} // SQLite
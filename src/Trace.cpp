@@ -0,0 +1,27 @@
+#include <iomanip>
+#include <ostream>
+#include <SQLiteCpp/Trace.h>
+
+namespace SQLite {
+
+SlowQueryLogger::SlowQueryLogger(std::ostream& aStream, std::chrono::nanoseconds aThreshold) :
+  mpStream{&aStream},
+  mThreshold{aThreshold}
+{
+}
+
+// Log the statement if it ran for at least the threshold duration
+void SlowQueryLogger::operator()(const TraceEvent& aEvent) const {
+  if (aEvent.elapsedNs < mThreshold.count())
+    return;
+
+  std::ostream& stream = *mpStream;
+  const std::ios_base::fmtflags flags = stream.flags();
+  const std::streamsize precision = stream.precision();
+  stream << "slow query (" << std::fixed << std::setprecision(3) << (aEvent.elapsedNs / 1e6) << " ms, "
+         << aEvent.rows << " rows): " << aEvent.sql << '\n';
+  stream.flags(flags);
+  stream.precision(precision);
+}
+
+} // SQLite
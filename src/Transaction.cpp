@@ -8,6 +8,7 @@
  * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
  * or copy at http://opensource.org/licenses/MIT)
  */
+#include <sqlite3.h>
 #include <SQLiteCpp/Transaction.h>
 
 #include <SQLiteCpp/Database.h>
@@ -56,5 +57,21 @@ void Transaction::commit()
     }
 }
 
+// Commit the transaction, returning the result code instead of throwing.
+Result Transaction::tryCommit() noexcept
+{
+    if (mbCommited)
+    {
+        return Result(SQLITE_MISUSE);
+    }
+
+    const Result result = mDatabase.tryExec("COMMIT");
+    if (result.isOk())
+    {
+        mbCommited = true;
+    }
+    return result;
+}
+
 
 }  // namespace SQLite
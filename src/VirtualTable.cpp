@@ -0,0 +1,428 @@
+#include <sqlite3.h>
+#include <SQLiteCpp/VirtualTable.h>
+
+#include <cstring>
+#include <new>
+#include <string_view>
+
+namespace SQLite {
+namespace detail {
+
+namespace {
+
+// Bits of the idxNum chosen by xBestIndex, and passed to xFilter, for each constraint used (in argv order)
+const int ROWID_EQ  = 1;
+const int KEY_EQ    = 2;
+const int KEY_GT    = 4;
+const int KEY_GE    = 8;
+const int KEY_LT    = 16;
+const int KEY_LE    = 32;
+
+struct ContainerVTab {
+  sqlite3_vtab      base;     ///< Base class, must come first
+  ContainerSource*  pSource;  ///< Rows of the container, owned by the module
+};
+
+struct ContainerCursor {
+  sqlite3_vtab_cursor base;   ///< Base class, must come first
+  std::size_t         row;    ///< Current row
+  std::size_t         end;    ///< End of the range of rows selected by xFilter
+};
+
+ContainerSource* getSource(sqlite3_vtab_cursor* apCursor) {
+  return reinterpret_cast<ContainerVTab*>(apCursor->pVtab)->pSource;
+}
+
+int xConnect(sqlite3* apSQLite, void* apAux, int, const char* const*, sqlite3_vtab** appVTab, char**) {
+  ContainerSource* pSource = static_cast<ContainerSource*>(apAux);
+  int ret = sqlite3_declare_vtab(apSQLite, pSource->mSchema.c_str());
+  if (SQLITE_OK == ret) {
+    ContainerVTab* pVTab = new (std::nothrow) ContainerVTab();
+    if (nullptr == pVTab)
+      return SQLITE_NOMEM;
+    pVTab->pSource = pSource;
+    *appVTab = &pVTab->base;
+  }
+  return ret;
+}
+
+int xDisconnect(sqlite3_vtab* apVTab) {
+  delete reinterpret_cast<ContainerVTab*>(apVTab);
+  return SQLITE_OK;
+}
+
+// True if the constraint aIndex compares the key column with the BINARY collating sequence used by compareKey()
+bool isBinaryCollation(sqlite3_index_info* apInfo, int aIndex) {
+#if SQLITE_VERSION_NUMBER >= 3022000 // SQLite 3.22.0 (2018-01-22)
+  const char* pCollation = sqlite3_vtab_collation(apInfo, aIndex);
+  return (nullptr == pCollation) || (0 == sqlite3_stricmp(pCollation, "BINARY"));
+#else
+  (void)apInfo;
+  (void)aIndex;
+  return true;
+#endif
+}
+
+int xBestIndex(sqlite3_vtab* apVTab, sqlite3_index_info* apInfo) {
+  const ContainerSource* pSource = reinterpret_cast<ContainerVTab*>(apVTab)->pSource;
+  const int keyColumn = pSource->mKeyColumn;
+  // Index of the constraint used for each idxNum bit, in argv order
+  int constraints[6] = {-1, -1, -1, -1, -1, -1};
+  for (int i = 0; i < apInfo->nConstraint; ++i) {
+    const sqlite3_index_info::sqlite3_index_constraint& constraint = apInfo->aConstraint[i];
+    if (!constraint.usable)
+      continue;
+    if (-1 == constraint.iColumn && SQLITE_INDEX_CONSTRAINT_EQ == constraint.op) {
+      constraints[0] = i;
+    } else if (-1 != keyColumn && keyColumn == constraint.iColumn && isBinaryCollation(apInfo, i)) {
+      switch (constraint.op) {
+      case SQLITE_INDEX_CONSTRAINT_EQ: constraints[1] = i; break;
+      case SQLITE_INDEX_CONSTRAINT_GT: constraints[2] = i; break;
+      case SQLITE_INDEX_CONSTRAINT_GE: constraints[3] = i; break;
+      case SQLITE_INDEX_CONSTRAINT_LT: constraints[4] = i; break;
+      case SQLITE_INDEX_CONSTRAINT_LE: constraints[5] = i; break;
+      default: break;
+      }
+    }
+  }
+
+  int idxNum = 0;
+  int argvIndex = 0;
+  for (int bit = 0; bit < 6; ++bit) {
+    if (-1 != constraints[bit]) {
+      idxNum |= (1 << bit);
+      // Not omitted: SQLite double checks each row, as a constraint value of another type is ignored by xFilter
+      apInfo->aConstraintUsage[constraints[bit]].argvIndex = ++argvIndex;
+    }
+  }
+  apInfo->idxNum = idxNum;
+
+  const double rows = static_cast<double>(pSource->size()) + 1.0;
+  if (idxNum & ROWID_EQ) {
+    apInfo->estimatedCost = 1.0;
+    apInfo->estimatedRows = 1;
+    apInfo->idxFlags = SQLITE_INDEX_SCAN_UNIQUE;
+  } else if (idxNum & KEY_EQ) {
+    apInfo->estimatedCost = 10.0;
+    apInfo->estimatedRows = 10;
+  } else if (idxNum & (KEY_GT | KEY_GE | KEY_LT | KEY_LE)) {
+    apInfo->estimatedCost = rows / 4;
+    apInfo->estimatedRows = static_cast<sqlite3_int64>(rows / 4);
+  } else {
+    apInfo->estimatedCost = rows;
+    apInfo->estimatedRows = static_cast<sqlite3_int64>(rows);
+  }
+
+  // Rows are visited in ascending order of rowid, and thus of the sorted key
+  if (1 == apInfo->nOrderBy && !apInfo->aOrderBy[0].desc &&
+      (-1 == apInfo->aOrderBy[0].iColumn || (-1 != keyColumn && keyColumn == apInfo->aOrderBy[0].iColumn))) {
+    apInfo->orderByConsumed = 1;
+  }
+  return SQLITE_OK;
+}
+
+int xOpen(sqlite3_vtab*, sqlite3_vtab_cursor** appCursor) {
+  ContainerCursor* pCursor = new (std::nothrow) ContainerCursor();
+  if (nullptr == pCursor)
+    return SQLITE_NOMEM;
+  *appCursor = &pCursor->base;
+  return SQLITE_OK;
+}
+
+int xClose(sqlite3_vtab_cursor* apCursor) {
+  delete reinterpret_cast<ContainerCursor*>(apCursor);
+  return SQLITE_OK;
+}
+
+// True if the constraint value can be compared to the sorted key by ContainerSource::compareKey()
+bool isComparable(const ContainerSource* apSource, sqlite3_value* apValue) {
+  switch (sqlite3_value_type(apValue)) {
+  case SQLITE_INTEGER:
+  case SQLITE_FLOAT:  return ValueKind::NUMERIC == apSource->mKeyKind;
+  case SQLITE_TEXT:   return ValueKind::TEXT == apSource->mKeyKind;
+  case SQLITE_BLOB:   return ValueKind::BLOB == apSource->mKeyKind;
+  default:            return false;
+  }
+}
+
+// First row in [aBegin, aEnd) whose key is not less than (or greater than, if abUpper) apValue
+std::size_t bound(const ContainerSource* apSource, std::size_t aBegin, std::size_t aEnd,
+                  sqlite3_value* apValue, bool abUpper) {
+  while (aBegin < aEnd) {
+    const std::size_t middle = aBegin + (aEnd - aBegin) / 2;
+    const int cmp = apSource->compareKey(middle, apValue);
+    if (cmp < 0 || (abUpper && 0 == cmp))
+      aBegin = middle + 1;
+    else
+      aEnd = middle;
+  }
+  return aBegin;
+}
+
+int xFilter(sqlite3_vtab_cursor* apCursor, int aIdxNum, const char*, int, sqlite3_value** apArgv) {
+  ContainerCursor* pCursor = reinterpret_cast<ContainerCursor*>(apCursor);
+  const ContainerSource* pSource = getSource(apCursor);
+  std::size_t begin = 0;
+  std::size_t end = pSource->size();
+  int arg = 0;
+  for (int bit = 1; bit <= KEY_LE; bit <<= 1) {
+    if (0 == (aIdxNum & bit))
+      continue;
+    sqlite3_value* pValue = apArgv[arg++];
+    if (SQLITE_NULL == sqlite3_value_type(pValue)) {
+      end = begin; // No row compares equal, less or greater than NULL
+    } else if (ROWID_EQ == bit) {
+      if (SQLITE_INTEGER == sqlite3_value_type(pValue)) {
+        const sqlite3_int64 rowid = sqlite3_value_int64(pValue);
+        if (rowid >= static_cast<sqlite3_int64>(begin) && rowid < static_cast<sqlite3_int64>(end)) {
+          begin = static_cast<std::size_t>(rowid);
+          end = begin + 1;
+        } else {
+          end = begin;
+        }
+      }
+    } else if (isComparable(pSource, pValue)) {
+      switch (bit) {
+      case KEY_EQ:
+        begin = bound(pSource, begin, end, pValue, false);
+        end = bound(pSource, begin, end, pValue, true);
+        break;
+      case KEY_GT: begin = bound(pSource, begin, end, pValue, true); break;
+      case KEY_GE: begin = bound(pSource, begin, end, pValue, false); break;
+      case KEY_LT: end = bound(pSource, begin, end, pValue, false); break;
+      case KEY_LE: end = bound(pSource, begin, end, pValue, true); break;
+      default: break;
+      }
+    }
+  }
+  pCursor->row = begin;
+  pCursor->end = (end > begin) ? end : begin;
+  return SQLITE_OK;
+}
+
+int xNext(sqlite3_vtab_cursor* apCursor) {
+  ++reinterpret_cast<ContainerCursor*>(apCursor)->row;
+  return SQLITE_OK;
+}
+
+int xEof(sqlite3_vtab_cursor* apCursor) {
+  const ContainerCursor* pCursor = reinterpret_cast<ContainerCursor*>(apCursor);
+  return pCursor->row >= pCursor->end;
+}
+
+int xColumn(sqlite3_vtab_cursor* apCursor, sqlite3_context* apContext, int aColumn) {
+  getSource(apCursor)->result(apContext, reinterpret_cast<ContainerCursor*>(apCursor)->row, aColumn);
+  return SQLITE_OK;
+}
+
+int xRowid(sqlite3_vtab_cursor* apCursor, sqlite3_int64* apRowid) {
+  *apRowid = static_cast<sqlite3_int64>(reinterpret_cast<ContainerCursor*>(apCursor)->row);
+  return SQLITE_OK;
+}
+
+void deleteSource(void* apSource) {
+  delete static_cast<ContainerSource*>(apSource);
+}
+
+sqlite3_module makeContainerModule() {
+  sqlite3_module module;
+  std::memset(&module, 0, sizeof(module));
+  module.iVersion = 0;
+  module.xCreate = nullptr; // Eponymous-only virtual table: no CREATE VIRTUAL TABLE needed
+  module.xConnect = xConnect;
+  module.xBestIndex = xBestIndex;
+  module.xDisconnect = xDisconnect;
+  module.xDestroy = xDisconnect;
+  module.xOpen = xOpen;
+  module.xClose = xClose;
+  module.xFilter = xFilter;
+  module.xNext = xNext;
+  module.xEof = xEof;
+  module.xColumn = xColumn;
+  module.xRowid = xRowid;
+  return module;
+}
+
+const sqlite3_module sContainerModule = makeContainerModule();
+
+#if SQLITE_VERSION_NUMBER >= 3020000 // SQLite 3.20.0 (2017-08-01): sqlite3_bind_pointer()
+
+/// Type of the pointers bound by bindArray(), checked by sqlite3_value_pointer()
+const char* const ARRAY_POINTER_TYPE = "SQLiteCpp_array";
+
+/// Array bound by bindArray(): the elements are not copied
+struct ArrayDescriptor {
+  ArrayType   type;   ///< Type of the elements
+  const void* pData;  ///< First element
+  std::size_t size;   ///< Number of elements
+};
+
+struct ArrayCursor {
+  sqlite3_vtab_cursor     base;     ///< Base class, must come first
+  const ArrayDescriptor*  pArray;   ///< Array selected by xFilter, nullptr if none
+  std::size_t             row;      ///< Current element
+};
+
+// Columns of the table-valued function: the value, and the hidden argument "pointer" bound by bindArray()
+const int ARRAY_COLUMN_VALUE   = 0;
+const int ARRAY_COLUMN_POINTER = 1;
+
+int xArrayConnect(sqlite3* apSQLite, void*, int, const char* const*, sqlite3_vtab** appVTab, char**) {
+  int ret = sqlite3_declare_vtab(apSQLite, "CREATE TABLE x(value, pointer HIDDEN)");
+  if (SQLITE_OK == ret) {
+    sqlite3_vtab* pVTab = new (std::nothrow) sqlite3_vtab();
+    if (nullptr == pVTab)
+      return SQLITE_NOMEM;
+    *appVTab = pVTab;
+  }
+  return ret;
+}
+
+int xArrayDisconnect(sqlite3_vtab* apVTab) {
+  delete apVTab;
+  return SQLITE_OK;
+}
+
+int xArrayBestIndex(sqlite3_vtab*, sqlite3_index_info* apInfo) {
+  for (int i = 0; i < apInfo->nConstraint; ++i) {
+    const sqlite3_index_info::sqlite3_index_constraint& constraint = apInfo->aConstraint[i];
+    if (constraint.usable && ARRAY_COLUMN_POINTER == constraint.iColumn &&
+        SQLITE_INDEX_CONSTRAINT_EQ == constraint.op) {
+      apInfo->aConstraintUsage[i].argvIndex = 1;
+      apInfo->aConstraintUsage[i].omit = 1;
+      apInfo->idxNum = 1;
+      apInfo->estimatedCost = 1.0;
+      apInfo->estimatedRows = 100;
+      return SQLITE_OK;
+    }
+  }
+  // Without the array argument, the table is empty: make this plan the least favorable
+  apInfo->idxNum = 0;
+  apInfo->estimatedCost = 2147483647.0;
+  apInfo->estimatedRows = 2147483647;
+  return SQLITE_OK;
+}
+
+int xArrayOpen(sqlite3_vtab*, sqlite3_vtab_cursor** appCursor) {
+  ArrayCursor* pCursor = new (std::nothrow) ArrayCursor();
+  if (nullptr == pCursor)
+    return SQLITE_NOMEM;
+  *appCursor = &pCursor->base;
+  return SQLITE_OK;
+}
+
+int xArrayClose(sqlite3_vtab_cursor* apCursor) {
+  delete reinterpret_cast<ArrayCursor*>(apCursor);
+  return SQLITE_OK;
+}
+
+int xArrayFilter(sqlite3_vtab_cursor* apCursor, int aIdxNum, const char*, int, sqlite3_value** apArgv) {
+  ArrayCursor* pCursor = reinterpret_cast<ArrayCursor*>(apCursor);
+  pCursor->pArray = (1 == aIdxNum) ?
+      static_cast<const ArrayDescriptor*>(sqlite3_value_pointer(apArgv[0], ARRAY_POINTER_TYPE)) : nullptr;
+  pCursor->row = 0;
+  return SQLITE_OK;
+}
+
+int xArrayNext(sqlite3_vtab_cursor* apCursor) {
+  ++reinterpret_cast<ArrayCursor*>(apCursor)->row;
+  return SQLITE_OK;
+}
+
+int xArrayEof(sqlite3_vtab_cursor* apCursor) {
+  const ArrayCursor* pCursor = reinterpret_cast<ArrayCursor*>(apCursor);
+  return (nullptr == pCursor->pArray) || (pCursor->row >= pCursor->pArray->size);
+}
+
+int xArrayColumn(sqlite3_vtab_cursor* apCursor, sqlite3_context* apContext, int aColumn) {
+  const ArrayCursor* pCursor = reinterpret_cast<ArrayCursor*>(apCursor);
+  if (ARRAY_COLUMN_VALUE != aColumn) {
+    sqlite3_result_null(apContext);
+    return SQLITE_OK;
+  }
+  const ArrayDescriptor& array = *pCursor->pArray;
+  switch (array.type) {
+  case ArrayType::INT64:
+    sqlite3_result_int64(apContext, static_cast<const long long*>(array.pData)[pCursor->row]);
+    break;
+  case ArrayType::DOUBLE:
+    sqlite3_result_double(apContext, static_cast<const double*>(array.pData)[pCursor->row]);
+    break;
+  case ArrayType::TEXT: {
+    // The array is unchanged while executing the statement
+    const std::string_view& text = static_cast<const std::string_view*>(array.pData)[pCursor->row];
+    sqlite3_result_text64(apContext, text.data(), text.size(), SQLITE_STATIC, SQLITE_UTF8);
+    break;
+  }
+  }
+  return SQLITE_OK;
+}
+
+int xArrayRowid(sqlite3_vtab_cursor* apCursor, sqlite3_int64* apRowid) {
+  *apRowid = static_cast<sqlite3_int64>(reinterpret_cast<ArrayCursor*>(apCursor)->row);
+  return SQLITE_OK;
+}
+
+void deleteArray(void* apArray) {
+  delete static_cast<ArrayDescriptor*>(apArray);
+}
+
+sqlite3_module makeArrayModule() {
+  sqlite3_module module;
+  std::memset(&module, 0, sizeof(module));
+  module.iVersion = 0;
+  module.xCreate = nullptr; // Eponymous-only virtual table: a table-valued function
+  module.xConnect = xArrayConnect;
+  module.xBestIndex = xArrayBestIndex;
+  module.xDisconnect = xArrayDisconnect;
+  module.xDestroy = xArrayDisconnect;
+  module.xOpen = xArrayOpen;
+  module.xClose = xArrayClose;
+  module.xFilter = xArrayFilter;
+  module.xNext = xArrayNext;
+  module.xEof = xArrayEof;
+  module.xColumn = xArrayColumn;
+  module.xRowid = xArrayRowid;
+  return module;
+}
+
+const sqlite3_module sArrayModule = makeArrayModule();
+
+#endif // SQLITE_VERSION_NUMBER >= 3020000
+
+} // namespace
+
+int createContainerModule(sqlite3* apSQLite, const char* apName, ContainerSource* apSource) noexcept {
+  // On error, sqlite3_create_module_v2() calls the destructor of the client data
+  return sqlite3_create_module_v2(apSQLite, apName, &sContainerModule, apSource, &deleteSource);
+}
+
+int createArrayModule(sqlite3* apSQLite, const char* apName) noexcept {
+#if SQLITE_VERSION_NUMBER >= 3020000
+  return sqlite3_create_module_v2(apSQLite, apName, &sArrayModule, nullptr, nullptr);
+#else
+  (void)apSQLite;
+  (void)apName;
+  return SQLITE_ERROR;
+#endif
+}
+
+int bindArray(sqlite3_stmt* apStmt, int aIndex, ArrayType aType, const void* apData, std::size_t aSize) noexcept {
+#if SQLITE_VERSION_NUMBER >= 3020000
+  ArrayDescriptor* pArray = new (std::nothrow) ArrayDescriptor{aType, apData, aSize};
+  if (nullptr == pArray)
+    return SQLITE_NOMEM;
+  // On error, sqlite3_bind_pointer() calls the destructor of the pointer
+  return sqlite3_bind_pointer(apStmt, aIndex, pArray, ARRAY_POINTER_TYPE, &deleteArray);
+#else
+  (void)apStmt;
+  (void)aIndex;
+  (void)aType;
+  (void)apData;
+  (void)aSize;
+  return SQLITE_ERROR;
+#endif
+}
+
+} // namespace detail
+} // namespace SQLite
@@ -0,0 +1,78 @@
+#include <sqlite3.h>
+#include <string>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include <SQLiteCpp/Allocator.h>
+#include <SQLiteCpp/Database.h>
+#include <SQLiteCpp/Statement.h>
+#include <SQLiteCpp/Transaction.h>
+
+static void workload(int aRows) {
+  SQLite::Database db(SQLite::MEMORY, SQLite::OPEN_READWRITE);
+  db.exec("CREATE TABLE test (id INTEGER PRIMARY KEY, name TEXT)");
+  SQLite::Transaction transaction(db);
+  SQLite::Statement insert(db, "INSERT INTO test VALUES (?, ?)");
+  for (int i = 0; i < aRows; ++i) {
+    insert.bind(1, i);
+    insert.bind(2, std::string(static_cast<size_t>(i % 200), 'x'));
+    insert.exec();
+    insert.reset();
+  }
+  transaction.commit();
+  SQLite::Statement query(db, "SELECT name FROM test ORDER BY name");
+  while (query.executeStep()) {
+  }
+}
+
+TEST(Allocator, configure) {
+  // The allocator can only be changed while SQLite is not initialized
+  ASSERT_EQ(SQLITE_OK, sqlite3_initialize());
+  EXPECT_THROW(SQLite::configureAllocator(), SQLite::Exception);
+  EXPECT_FALSE(SQLite::isAllocatorConfigured());
+
+  ASSERT_EQ(SQLITE_OK, sqlite3_shutdown());
+  SQLite::configureAllocator();
+  EXPECT_TRUE(SQLite::isAllocatorConfigured());
+  SQLite::configureAllocator(); // Does nothing when already installed
+
+  const SQLite::AllocatorStats before = SQLite::getAllocatorStats();
+  workload(1000);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i)
+    threads.emplace_back(workload, 500);
+  for (std::thread& thread : threads)
+    thread.join();
+  const SQLite::AllocatorStats after = SQLite::getAllocatorStats();
+
+  EXPECT_GT(after.mallocCount, before.mallocCount);
+  EXPECT_GT(after.freeCount, before.freeCount);
+  EXPECT_GT(after.cacheHits, before.cacheHits);
+  EXPECT_GT(after.largeCount, before.largeCount); // Pages of the page cache
+  EXPECT_GT(after.arenaBytes, 0);
+  EXPECT_LE(after.cacheHits, after.mallocCount);
+
+  // Memory statistics of SQLite use the sizes given by xSize(): all the memory has been freed
+  EXPECT_EQ(0, sqlite3_memory_used());
+
+  // Out of memory once the arenas reach their limit: the blocks left in the pool are used, then nullptr
+  std::vector<void*> blocks(1, sqlite3_malloc(100));
+  ASSERT_NE(nullptr, blocks[0]);
+  SQLite::setAllocatorArenaLimit(SQLite::getAllocatorStats().arenaBytes);
+  while ((nullptr != blocks.back()) && (blocks.size() < 100000))
+    blocks.push_back(sqlite3_malloc(100));
+  EXPECT_EQ(nullptr, blocks.back());
+  EXPECT_GT(blocks.size(), 2u);
+  for (void* pBlock : blocks)
+    sqlite3_free(pBlock);
+  SQLite::setAllocatorArenaLimit(0);
+  EXPECT_NE(nullptr, blocks[0] = sqlite3_malloc(100));
+  sqlite3_free(blocks[0]);
+  EXPECT_EQ(0, sqlite3_memory_used());
+
+  EXPECT_THROW(SQLite::restoreAllocator(), SQLite::Exception);
+  ASSERT_EQ(SQLITE_OK, sqlite3_shutdown());
+  SQLite::restoreAllocator();
+  EXPECT_FALSE(SQLite::isAllocatorConfigured());
+  workload(10);
+}
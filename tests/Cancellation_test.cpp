@@ -0,0 +1,113 @@
+#include <chrono>
+#include <string>
+#include <thread>
+#include <sqlite3.h>
+#include <gtest/gtest.h>
+#include <SQLiteCpp/Database.h>
+#include <SQLiteCpp/Exception.h>
+#include <SQLiteCpp/Statement.h>
+
+namespace {
+
+// Never ending query
+const char* const RUNAWAY = "WITH RECURSIVE c(x) AS (SELECT 1 UNION ALL SELECT x + 1 FROM c) SELECT count(*) FROM c";
+
+} // namespace
+
+TEST(Cancellation, timeout) {
+  SQLite::Database db(":memory:", SQLite::OPEN_READWRITE);
+  SQLite::Statement query(db, RUNAWAY);
+  query.setTimeout(std::chrono::milliseconds(50));
+
+  const auto start = std::chrono::steady_clock::now();
+  EXPECT_THROW(query.executeStep(), SQLite::TimeoutException);
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+  EXPECT_EQ(SQLite::Interruption::Timeout, query.getInterruption());
+
+  // non-throwing API: the reason is kept by the statement
+  query.tryReset(); // reset() would throw the error of the interrupted step again
+  EXPECT_EQ(SQLITE_INTERRUPT, query.tryExecuteStep());
+  EXPECT_EQ(SQLite::Interruption::Timeout, query.getInterruption());
+
+  // a new deadline for each execution, and the connection remains usable
+  SQLite::Statement bounded(db, "WITH RECURSIVE c(x) AS (SELECT 1 UNION ALL SELECT x + 1 FROM c WHERE x < 1000) "
+                                "SELECT count(*) FROM c");
+  bounded.setTimeout(std::chrono::milliseconds(1000));
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_TRUE(bounded.executeStep());
+    EXPECT_EQ(1000, bounded.getColumn(0).getInt());
+    EXPECT_EQ(SQLite::Interruption::None, bounded.getInterruption());
+    bounded.reset();
+  }
+}
+
+TEST(Cancellation, token) {
+  SQLite::Database db(":memory:", SQLite::OPEN_READWRITE);
+  db.setCancellationCheckInterval(100);
+  SQLite::Statement query(db, RUNAWAY);
+  SQLite::CancellationToken token = SQLite::CancellationToken::create();
+  query.setCancellationToken(token);
+  EXPECT_FALSE(token.isCancelled());
+
+  std::thread canceller([token]() mutable {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    token.cancel();
+  });
+  EXPECT_THROW(query.executeStep(), SQLite::CancelledException);
+  canceller.join();
+  EXPECT_TRUE(token.isCancelled());
+  EXPECT_EQ(SQLite::Interruption::Cancelled, query.getInterruption());
+
+  // already cancelled: fails before running
+  query.tryReset();
+  const SQLite::Expected<int> result = query.tryExec();
+  EXPECT_EQ(SQLITE_INTERRUPT, result.getErrorCode());
+  EXPECT_EQ(SQLite::Interruption::Cancelled, query.getInterruption());
+
+  // a default token is never cancelled
+  SQLite::CancellationToken none;
+  none.cancel();
+  EXPECT_FALSE(none.isCancelled());
+  query.setCancellationToken(none);
+  SQLite::Statement quick(db, "SELECT 1");
+  quick.setCancellationToken(none);
+  EXPECT_TRUE(quick.executeStep());
+}
+
+TEST(Cancellation, interrupt) {
+  SQLite::Database db(":memory:", SQLite::OPEN_READWRITE);
+  SQLite::Statement query(db, RUNAWAY);
+
+  std::thread interrupter([&db] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    db.interrupt();
+  });
+  try {
+    query.executeStep();
+    ADD_FAILURE() << "not interrupted";
+  } catch (const SQLite::CancelledException& e) {
+    EXPECT_EQ(SQLITE_INTERRUPT, e.code());
+  }
+  interrupter.join();
+  EXPECT_EQ(SQLite::Interruption::None, query.getInterruption()); // not interrupted by the statement itself
+
+  query.tryReset();
+  SQLite::Statement quick(db, "SELECT 1");
+  EXPECT_TRUE(quick.executeStep());
+
+  // also for the statements run by exec(); an interruption lasts until no statement is running anymore
+  quick.reset();
+  db.exec("CREATE TABLE test (id INTEGER PRIMARY KEY)");
+  std::thread execInterrupter([&db] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    db.interrupt();
+  });
+  try {
+    db.exec(std::string("INSERT INTO test ") + RUNAWAY);
+    ADD_FAILURE() << "not interrupted";
+  } catch (const SQLite::CancelledException& e) {
+    EXPECT_EQ(SQLITE_INTERRUPT, e.code());
+  }
+  execInterrupter.join();
+  EXPECT_EQ(0, db.execAndGet("SELECT count(*) FROM test").getInt());
+}
@@ -0,0 +1,210 @@
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <SQLiteCpp/Database.h>
+#include <SQLiteCpp/Exception.h>
+#include <SQLiteCpp/Statement.h>
+#include <SQLiteCpp/Transaction.h>
+
+TEST(Changes, deliveredAfterCommit) {
+  SQLite::Database db(":memory:", SQLite::OPEN_READWRITE);
+  db.exec("CREATE TABLE test (id INTEGER PRIMARY KEY, value TEXT)");
+
+  std::vector<std::vector<SQLite::RowChange>> batches;
+  db.setChangeSink([&](const std::vector<SQLite::RowChange>& aChanges) { batches.push_back(aChanges); });
+
+  // autocommit statements: one batch each
+  db.exec("INSERT INTO test VALUES (1, 'one')");
+  ASSERT_EQ(1u, batches.size());
+  ASSERT_EQ(1u, batches[0].size());
+  EXPECT_EQ(SQLite::ChangeType::Insert, batches[0][0].type);
+  EXPECT_EQ("main", batches[0][0].database);
+  EXPECT_EQ("test", batches[0][0].table);
+  EXPECT_EQ(1, batches[0][0].rowid);
+  EXPECT_TRUE(batches[0][0].newValues.empty());
+
+  SQLite::Statement insert(db, "INSERT INTO test VALUES (?, 'x')");
+  insert.bind(1, 2);
+  EXPECT_EQ(1, insert.exec());
+  ASSERT_EQ(2u, batches.size());
+  EXPECT_EQ(2, batches[1][0].rowid);
+
+  // read-only statements deliver nothing
+  SQLite::Statement query(db, "SELECT count(*) FROM test");
+  EXPECT_TRUE(query.executeStep());
+  EXPECT_EQ(2u, batches.size());
+
+  // a transaction: nothing before the commit, then all its changes in order
+  {
+    SQLite::Transaction transaction(db);
+    db.exec("UPDATE test SET value = 'two' WHERE id = 2");
+    db.exec("DELETE FROM test WHERE id = 1");
+    EXPECT_EQ(2u, batches.size());
+    transaction.commit();
+  }
+  ASSERT_EQ(3u, batches.size());
+  ASSERT_EQ(2u, batches[2].size());
+  EXPECT_EQ(SQLite::ChangeType::Update, batches[2][0].type);
+  EXPECT_EQ(2, batches[2][0].rowid);
+  EXPECT_EQ(SQLite::ChangeType::Delete, batches[2][1].type);
+  EXPECT_EQ(1, batches[2][1].rowid);
+
+  // a rollback discards the changes
+  {
+    SQLite::Transaction transaction(db);
+    db.exec("INSERT INTO test VALUES (3, 'three')");
+  }
+  EXPECT_EQ(3u, batches.size());
+  db.exec("INSERT INTO test VALUES (4, 'four')");
+  ASSERT_EQ(4u, batches.size());
+  ASSERT_EQ(1u, batches[3].size());
+  EXPECT_EQ(4, batches[3][0].rowid);
+
+  // exceptions of the sink are swallowed, and the capture stops with a null sink
+  db.setChangeSink([](const std::vector<SQLite::RowChange>&) { throw std::runtime_error("sink"); });
+  EXPECT_NO_THROW(db.exec("INSERT INTO test VALUES (5, 'five')"));
+  db.setChangeSink(nullptr);
+  db.exec("INSERT INTO test VALUES (6, 'six')");
+  EXPECT_EQ(4u, batches.size());
+}
+
+TEST(Changes, busyCommitRetried) {
+  remove("test_changes.db3");
+  {
+    SQLite::Database writer("test_changes.db3", SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE);
+    SQLite::Database reader("test_changes.db3", SQLite::OPEN_READONLY);
+    writer.exec("CREATE TABLE test (id INTEGER PRIMARY KEY)");
+    writer.exec("INSERT INTO test VALUES (1)");
+
+    int batches = 0;
+    std::size_t changes = 0;
+    writer.setChangeSink([&](const std::vector<SQLite::RowChange>& aChanges) {
+      ++batches;
+      changes += aChanges.size();
+    });
+
+    writer.exec("BEGIN");
+    writer.exec("INSERT INTO test VALUES (2)");
+    {
+      // a pending read keeps a shared lock on the file: the commit fails with SQLITE_BUSY
+      SQLite::Statement query(reader, "SELECT id FROM test");
+      EXPECT_TRUE(query.executeStep());
+      EXPECT_THROW(writer.exec("COMMIT"), SQLite::Exception);
+      EXPECT_EQ(0, batches);
+    }
+    writer.exec("COMMIT");
+    EXPECT_EQ(1, batches);
+    EXPECT_EQ(1u, changes);
+  }
+  remove("test_changes.db3");
+}
+
+TEST(Changes, values) {
+  SQLite::Database db(":memory:", SQLite::OPEN_READWRITE);
+  db.exec("CREATE TABLE test (id INTEGER PRIMARY KEY, value TEXT, weight REAL, data BLOB)");
+  const auto sink = [](const std::vector<SQLite::RowChange>&) {};
+  if (!SQLite::Database::hasPreupdateHook()) {
+    EXPECT_THROW(db.setChangeSink(sink, true), SQLite::Exception);
+    return;
+  }
+
+  std::vector<SQLite::RowChange> changes;
+  db.setChangeSink([&](const std::vector<SQLite::RowChange>& aChanges) {
+    changes.insert(changes.end(), aChanges.begin(), aChanges.end());
+  }, true);
+  db.exec("INSERT INTO test VALUES (1, 'one', 1.5, x'0102')");
+  db.exec("UPDATE test SET id = 2, value = NULL WHERE id = 1");
+  ASSERT_EQ(2u, changes.size());
+  ASSERT_EQ(4u, changes[0].newValues.size());
+  EXPECT_TRUE(changes[0].oldValues.empty());
+  EXPECT_EQ(1, std::get<long long>(changes[0].newValues[0]));
+  EXPECT_EQ("one", std::get<std::string>(changes[0].newValues[1]));
+  EXPECT_EQ(1.5, std::get<double>(changes[0].newValues[2]));
+  EXPECT_EQ((std::vector<unsigned char>{1, 2}), std::get<std::vector<unsigned char>>(changes[0].newValues[3]));
+  EXPECT_EQ(2, changes[1].rowid);
+  EXPECT_EQ(1, changes[1].oldRowid);
+  EXPECT_EQ("one", std::get<std::string>(changes[1].oldValues[1]));
+  EXPECT_TRUE(std::holds_alternative<std::monostate>(changes[1].newValues[1]));
+}
+
+TEST(Changes, statementAndSavepointRollbacks) {
+  SQLite::Database db(":memory:", SQLite::OPEN_READWRITE);
+  db.exec("CREATE TABLE test (id INTEGER PRIMARY KEY, value TEXT UNIQUE)");
+
+  std::vector<long long> rowids;
+  db.setChangeSink([&](const std::vector<SQLite::RowChange>& aChanges) {
+    for (const SQLite::RowChange& change : aChanges)
+      rowids.push_back(change.rowid);
+  });
+
+  // a failed statement undoes its own changes, but not the transaction
+  db.exec("BEGIN");
+  EXPECT_THROW(db.exec("INSERT INTO test VALUES (1, 'a'), (2, 'b'), (3, 'a')"), SQLite::Exception);
+  SQLite::Statement insert(db, "INSERT INTO test VALUES (?, ?), (?, 'dup'), (?, 'dup')");
+  insert.bind(1, 4);
+  insert.bind(2, "d");
+  insert.bind(3, 5);
+  insert.bind(4, 6);
+  EXPECT_THROW(insert.exec(), SQLite::Exception);
+
+  // ROLLBACK TO undoes the changes since the savepoint, RELEASE keeps them
+  db.exec("SAVEPOINT sp; INSERT INTO test VALUES (10, 'j'); ROLLBACK TO sp; INSERT INTO test VALUES (11, 'k')");
+  db.exec("SAVEPOINT \"Outer\"; INSERT INTO test VALUES (12, 'l'); SAVEPOINT inner; INSERT INTO test VALUES (13, 'm')");
+  db.exec("RELEASE inner");
+  db.exec("INSERT INTO test VALUES (14, 'n')");
+  db.exec("ROLLBACK TRANSACTION TO SAVEPOINT outer"); // names are case insensitive
+  db.exec("INSERT INTO test VALUES (15, 'o'); RELEASE outer");
+  // a statement with the FAIL conflict resolution keeps the rows changed before its error
+  EXPECT_THROW(db.exec("INSERT OR FAIL INTO test VALUES (16, 'p'), (17, 'o')"), SQLite::Exception);
+  EXPECT_TRUE(rowids.empty());
+  db.exec("COMMIT");
+  EXPECT_EQ((std::vector<long long>{11, 15, 16}), rowids);
+  EXPECT_EQ(3, db.execAndGet("SELECT count(*) FROM test").getInt());
+
+  // a savepoint outside of a transaction starts one, committed by its release
+  rowids.clear();
+  db.exec("SAVEPOINT first");
+  db.exec("INSERT INTO test VALUES (20, 't')");
+  db.exec("SAVEPOINT second");
+  db.exec("INSERT INTO test VALUES (21, 'u')");
+  db.exec("ROLLBACK TO first");
+  db.exec("INSERT INTO test VALUES (22, 'v')");
+  EXPECT_TRUE(rowids.empty());
+  db.exec("RELEASE SAVEPOINT first");
+  EXPECT_EQ((std::vector<long long>{22}), rowids);
+  EXPECT_EQ(4, db.execAndGet("SELECT count(*) FROM test").getInt());
+}
+
+TEST(Changes, queryCached) {
+  SQLite::Database db(":memory:", SQLite::OPEN_READWRITE);
+  db.exec("CREATE TABLE test (id INTEGER PRIMARY KEY, value TEXT UNIQUE)");
+  db.setResultCache(1024 * 1024);
+
+  std::vector<long long> rowids;
+  db.setChangeSink([&](const std::vector<SQLite::RowChange>& aChanges) {
+    for (const SQLite::RowChange& change : aChanges)
+      rowids.push_back(change.rowid);
+  });
+
+  // an autocommit write run by queryCached() is delivered at its own commit
+  db.queryCached("INSERT INTO test VALUES (1, 'a')");
+  EXPECT_EQ((std::vector<long long>{1}), rowids);
+  db.queryCached("INSERT INTO test VALUES (?, ?)", 2, "b");
+  EXPECT_EQ((std::vector<long long>{1, 2}), rowids);
+
+  // a failed statement undoes its own changes, but not the transaction
+  rowids.clear();
+  db.exec("BEGIN");
+  db.queryCached("INSERT INTO test VALUES (3, 'c')");
+  EXPECT_THROW(db.queryCached("INSERT INTO test VALUES (4, 'd'), (5, 'a')"), SQLite::Exception);
+  EXPECT_TRUE(rowids.empty());
+  db.exec("COMMIT");
+  EXPECT_EQ((std::vector<long long>{3}), rowids);
+
+  // read-only queries, run or cached, deliver nothing
+  rowids.clear();
+  EXPECT_EQ(3, db.queryCached("SELECT count(*) FROM test")->getInt64(0, 0));
+  EXPECT_EQ(3, db.queryCached("SELECT count(*) FROM test")->getInt64(0, 0));
+  EXPECT_TRUE(rowids.empty());
+}
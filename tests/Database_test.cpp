@@ -10,6 +10,7 @@
  */
 
 #include <SQLiteCpp/Database.h>
+#include <SQLiteCpp/Statement.h>
 
 #include <sqlite3.h> // for SQLITE_ERROR and SQLITE_VERSION_NUMBER
 
@@ -326,3 +327,29 @@ TEST(Database, encryptAndDecrypt) {
     remove("test.db3");
 }
 #endif // SQLITE_HAS_CODEC
+
+TEST(Database, getStatementStatus) {
+    SQLite::Database db(SQLite::MEMORY);
+    db.exec("CREATE TABLE test (id INTEGER PRIMARY KEY, value TEXT)");
+    db.exec("INSERT INTO test VALUES (1, 'first'), (2, 'second')");
+    EXPECT_TRUE(db.getStatementStatus().empty());
+
+    const std::string sql = "SELECT * FROM test WHERE value > ''";
+    SQLite::Statement query1(db, sql);
+    SQLite::Statement query2(db, sql);
+    SQLite::Statement other(db, "SELECT count(*) FROM test");
+    while (query1.executeStep()) {}
+    while (query2.executeStep()) {}
+
+    std::map<std::string, SQLite::StatementStatus> statuses = db.getStatementStatus(true);
+    ASSERT_EQ(2u, statuses.size());
+    EXPECT_EQ(2, statuses[sql].runs);
+    EXPECT_EQ(2, statuses[sql].fullscanSteps);
+    EXPECT_EQ(query1.getStatus().memUsed + query2.getStatus().memUsed, statuses[sql].memUsed);
+    EXPECT_EQ(0, statuses["SELECT count(*) FROM test"].runs);
+
+    // Counters have been reset
+    statuses = db.getStatementStatus();
+    EXPECT_EQ(0, statuses[sql].runs);
+    EXPECT_EQ(0, statuses[sql].fullscanSteps);
+}
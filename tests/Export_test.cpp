@@ -0,0 +1,106 @@
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <gtest/gtest.h>
+#include <SQLiteCpp/Database.h>
+#include <SQLiteCpp/Exception.h>
+#include <SQLiteCpp/Export.h>
+#include <SQLiteCpp/Statement.h>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+void createTestTable(SQLite::Database& aDb) {
+  aDb.exec("CREATE TABLE test (id INTEGER, name TEXT, value REAL, data BLOB)");
+  aDb.exec("INSERT INTO test VALUES (1, 'plain', 0.5, x'0aff')");
+  aDb.exec("INSERT INTO test VALUES (-2, 'with, comma and \"quotes\"', NULL, NULL)");
+  aDb.exec("INSERT INTO test VALUES (3, 'multi' || char(10) || 'line\\' || char(1), 1e300 * 1e300, NULL)");
+}
+
+} // namespace
+
+TEST(Export, csv) {
+  SQLite::Database db(":memory:", SQLite::OPEN_READWRITE);
+  createTestTable(db);
+  SQLite::Statement query(db, "SELECT id, name AS \"the name\", value FROM test ORDER BY rowid");
+  std::ostringstream output;
+  EXPECT_EQ(3, SQLite::exportCsv(query, output));
+  EXPECT_EQ("id,the name,value\n"
+            "1,plain,0.5\n"
+            "-2,\"with, comma and \"\"quotes\"\"\",\n"
+            "3,\"multi\nline\\\x01\",inf\n", output.str());
+
+  // TSV without header, continuing after a reset
+  query.reset();
+  SQLite::CsvOptions options;
+  options.delimiter = '\t';
+  options.bHeader = false;
+  std::ostringstream tsv;
+  EXPECT_EQ(3, SQLite::exportCsv(query, tsv, options));
+  EXPECT_EQ("1\tplain\t0.5\n"
+            "-2\t\"with, comma and \"\"quotes\"\"\"\t\n"
+            "3\t\"multi\nline\\\x01\"\tinf\n", tsv.str());
+}
+
+TEST(Export, jsonLines) {
+  SQLite::Database db(":memory:", SQLite::OPEN_READWRITE);
+  createTestTable(db);
+  SQLite::Statement query(db, "SELECT id, name AS \"the \"\"name\"\"\", value, data FROM test ORDER BY rowid");
+  std::ostringstream output;
+  EXPECT_EQ(3, SQLite::exportJsonLines(query, output));
+  EXPECT_EQ("{\"id\":1,\"the \\\"name\\\"\":\"plain\",\"value\":0.5,\"data\":\"0aff\"}\n"
+            "{\"id\":-2,\"the \\\"name\\\"\":\"with, comma and \\\"quotes\\\"\",\"value\":null,\"data\":null}\n"
+            "{\"id\":3,\"the \\\"name\\\"\":\"multi\\nline\\\\\\u0001\",\"value\":null,\"data\":null}\n",
+            output.str());
+}
+
+TEST(Export, fileDescriptor) {
+  remove("test_export.csv");
+  SQLite::Database db(":memory:", SQLite::OPEN_READWRITE);
+  db.exec("CREATE TABLE test (id INTEGER PRIMARY KEY, name TEXT)");
+  db.exec("WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < 100000) "
+          "INSERT INTO test SELECT i, 'name ' || i FROM n");
+
+  // larger than the output buffer, so written in several chunks
+#ifdef _WIN32
+  const int fd = _open("test_export.csv", _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, 0644);
+#else
+  const int fd = open("test_export.csv", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+#endif
+  ASSERT_GE(fd, 0);
+  SQLite::Statement query(db, "SELECT id, name FROM test ORDER BY id");
+  EXPECT_EQ(100000, SQLite::exportJsonLines(query, fd));
+#ifdef _WIN32
+  _close(fd);
+#else
+  close(fd);
+#endif
+
+  std::ifstream file("test_export.csv");
+  std::string line;
+  int count = 0;
+  while (std::getline(file, line)) {
+    ++count;
+    EXPECT_EQ("{\"id\":" + std::to_string(count) + ",\"name\":\"name " + std::to_string(count) + "\"}", line);
+  }
+  EXPECT_EQ(100000, count);
+  file.close();
+  remove("test_export.csv");
+
+  // the write() error on a bad file descriptor, not the misuse of a statement to reset
+  query.reset();
+  try {
+    SQLite::exportCsv(query, -1);
+    ADD_FAILURE() << "exportCsv() to a bad file descriptor did not throw";
+  } catch (const SQLite::Exception& e) {
+    EXPECT_NE(std::string::npos, std::string(e.what()).find("file descriptor")) << e.what();
+  }
+}
@@ -0,0 +1,80 @@
+#include <optional>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <SQLiteCpp/Database.h>
+#include <SQLiteCpp/Statement.h>
+#include <SQLiteCpp/Fields.h>
+
+namespace {
+
+struct Track {
+  long long                   id;
+  std::string                 name;
+  std::optional<double>       duration;
+  bool                        favorite;
+  std::vector<unsigned char>  cover;
+};
+
+} // namespace
+
+template<>
+struct SQLite::FieldsOf<Track> {
+  static constexpr auto fields = SQLite::fields(&Track::id, &Track::name, &Track::duration,
+                                                &Track::favorite, &Track::cover);
+};
+
+TEST(Fields, bindAndRead) {
+  SQLite::Database db(SQLite::MEMORY, SQLite::OPEN_READWRITE);
+  db.exec("CREATE TABLE tracks (id INTEGER PRIMARY KEY, name TEXT, duration REAL, favorite INTEGER, cover BLOB)");
+
+  SQLite::Statement insert(db, "INSERT INTO tracks VALUES (?, ?, ?, ?, ?)");
+  const std::vector<Track> tracks = {
+    {1, "first", 1.5, true, {0x01, 0x02}},
+    {2, "second", std::nullopt, false, {}},
+    {3, std::string("th\0ird", 6), 3.5, false, {0xFF}}
+  };
+  for (const Track& track : tracks) {
+    SQLite::bindStruct(insert, track);
+    EXPECT_EQ(1, insert.exec());
+    insert.reset();
+  }
+
+  SQLite::Statement query(db, "SELECT id, name, duration, favorite, cover FROM tracks ORDER BY id");
+  ASSERT_TRUE(query.executeStep());
+  const Track first = SQLite::readStruct<Track>(query);
+  EXPECT_EQ(1, first.id);
+  EXPECT_EQ("first", first.name);
+  ASSERT_TRUE(first.duration.has_value());
+  EXPECT_DOUBLE_EQ(1.5, *first.duration);
+  EXPECT_TRUE(first.favorite);
+  EXPECT_EQ((std::vector<unsigned char>{0x01, 0x02}), first.cover);
+
+  // readAll() continues from the current row
+  std::vector<Track> others;
+  EXPECT_EQ(2u, SQLite::readAll(query, others, 2));
+  ASSERT_EQ(2u, others.size());
+  EXPECT_EQ(2, others[0].id);
+  EXPECT_FALSE(others[0].duration.has_value());
+  EXPECT_TRUE(others[0].cover.empty());
+  EXPECT_EQ(tracks[2].name, others[1].name);
+  EXPECT_EQ(tracks[2].cover, others[1].cover);
+}
+
+TEST(Fields, errors) {
+  SQLite::Database db(SQLite::MEMORY, SQLite::OPEN_READWRITE);
+  db.exec("CREATE TABLE tracks (id INTEGER PRIMARY KEY, name TEXT)");
+  db.exec("INSERT INTO tracks VALUES (1, 'first')");
+
+  // No row
+  SQLite::Statement query(db, "SELECT id, name, NULL, 0, NULL FROM tracks");
+  EXPECT_THROW(SQLite::readStruct<Track>(query), SQLite::Exception);
+
+  // Not enough columns
+  SQLite::Statement tooFew(db, "SELECT id, name FROM tracks");
+  ASSERT_TRUE(tooFew.executeStep());
+  EXPECT_THROW(SQLite::readStruct<Track>(tooFew), SQLite::Exception);
+  tooFew.reset();
+  std::vector<Track> tracks;
+  EXPECT_THROW(SQLite::readAll(tooFew, tracks), SQLite::Exception);
+}
@@ -0,0 +1,157 @@
+#include <algorithm>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <gtest/gtest.h>
+#include <SQLiteCpp/Database.h>
+#include <SQLiteCpp/Statement.h>
+#include <SQLiteCpp/Function.h>
+
+static double half(double aValue) {
+  return aValue / 2;
+}
+
+static long long twice(long long aValue) noexcept {
+  return aValue * 2;
+}
+
+TEST(Function, scalar) {
+  SQLite::Database db(SQLite::MEMORY);
+
+  db.createFunction("sum2", [](long long a, long long b) { return a + b; });
+  EXPECT_EQ(5, db.execAndGet("SELECT sum2(2, 3)").getInt());
+
+  // Function pointer
+  db.createFunction("half", &half);
+  EXPECT_EQ(1.25, db.execAndGet("SELECT half(2.5)").getDouble());
+
+  // noexcept function pointer and call operator
+  db.createFunction("twice", &twice);
+  EXPECT_EQ(8, db.execAndGet("SELECT twice(4)").getInt());
+  db.createFunction("negate", [](long long aValue) noexcept { return -aValue; });
+  EXPECT_EQ(-4, db.execAndGet("SELECT negate(4)").getInt());
+
+  // Text argument decoded without copy, text result copied by SQLite
+  db.createFunction("first_word", [](std::string_view aText) { return aText.substr(0, aText.find(' ')); });
+  EXPECT_EQ("hello", db.execAndGet("SELECT first_word('hello world')").getText());
+
+  // Function object with state and no argument
+  int calls = 0;
+  db.createFunction("counter", [&calls]() { return ++calls; }, false);
+  EXPECT_EQ(1, db.execAndGet("SELECT counter()").getInt());
+  EXPECT_EQ(2, db.execAndGet("SELECT counter()").getInt());
+
+  // Wrong number of arguments
+  EXPECT_THROW(db.execAndGet("SELECT sum2(1)"), SQLite::Exception);
+}
+
+TEST(Function, nullAndBlob) {
+  SQLite::Database db(SQLite::MEMORY);
+
+  // std::optional for NULL arguments and results
+  db.createFunction("twice", [](std::optional<int> aValue) -> std::optional<int> {
+    if (aValue)
+      return *aValue * 2;
+    return std::nullopt;
+  });
+  EXPECT_EQ(42, db.execAndGet("SELECT twice(21)").getInt());
+  EXPECT_TRUE(db.execAndGet("SELECT twice(NULL)").isNull());
+
+  // void result is NULL
+  db.createFunction("noop", [](int) {});
+  EXPECT_TRUE(db.execAndGet("SELECT noop(1)").isNull());
+
+  // Blob argument and result
+  db.createFunction("blob_size", [](SQLite::Blob aBlob) { return static_cast<int>(aBlob.size()); });
+  EXPECT_EQ(3, db.execAndGet("SELECT blob_size(x'010203')").getInt());
+  const std::vector<unsigned char> bytes = {0xCA, 0xFE};
+  db.createFunction("cafe", [&bytes]() { return SQLite::Blob(bytes); });
+  SQLite::Statement query(db, "SELECT cafe()");
+  ASSERT_TRUE(query.executeStep());
+  EXPECT_TRUE(query.getColumn(0).isBlob());
+  EXPECT_EQ(std::string("\xCA\xFE"), query.getColumn(0).getString());
+}
+
+TEST(Function, exception) {
+  SQLite::Database db(SQLite::MEMORY);
+  db.createFunction("fail", [](int) -> int { throw std::runtime_error("failure in function"); });
+  try {
+    db.execAndGet("SELECT fail(1)");
+    FAIL();
+  } catch (SQLite::Exception& e) {
+    EXPECT_STREQ("failure in function", e.what());
+  }
+}
+
+namespace {
+
+// Median of the values of a group: the state owns memory, to check that it is destroyed
+struct Median {
+  static int alive;
+  std::vector<double> values;
+  Median() { ++alive; }
+  ~Median() { --alive; }
+  void step(std::optional<double> aValue) {
+    if (aValue)
+      values.push_back(*aValue);
+  }
+  std::optional<double> final() {
+    if (values.empty())
+      return std::nullopt;
+    std::sort(values.begin(), values.end());
+    const size_t middle = values.size() / 2;
+    return (values.size() % 2) ? values[middle] : (values[middle - 1] + values[middle]) / 2;
+  }
+};
+int Median::alive = 0;
+
+// Sum of the values in the window frame
+struct MovingSum {
+  long long sum = 0;
+  void step(long long aValue) noexcept { sum += aValue; }
+  void inverse(long long aValue) noexcept { sum -= aValue; }
+  long long value() const { return sum; }
+  long long final() const { return sum; }
+};
+
+} // namespace
+
+TEST(Function, aggregate) {
+  SQLite::Database db(SQLite::MEMORY, SQLite::OPEN_READWRITE);
+  db.exec("CREATE TABLE test (grp TEXT, value REAL)");
+  db.exec("INSERT INTO test VALUES ('a', 3), ('a', 1), ('a', 2), ('b', 4), ('b', 1), ('b', NULL)");
+  db.createAggregate<Median>("median");
+
+  EXPECT_DOUBLE_EQ(2.0, db.execAndGet("SELECT median(value) FROM test").getDouble());
+  SQLite::Statement query(db, "SELECT grp, median(value) FROM test GROUP BY grp ORDER BY grp");
+  ASSERT_TRUE(query.executeStep());
+  EXPECT_DOUBLE_EQ(2.0, query.getColumn(1).getDouble());
+  ASSERT_TRUE(query.executeStep());
+  EXPECT_DOUBLE_EQ(2.5, query.getColumn(1).getDouble());
+  EXPECT_FALSE(query.executeStep());
+
+  // No row: final() of a default constructed state
+  EXPECT_TRUE(db.execAndGet("SELECT median(value) FROM test WHERE 0").isNull());
+  EXPECT_EQ(0, Median::alive);
+
+  // Wrong number of arguments
+  EXPECT_THROW(db.execAndGet("SELECT median(value, 1) FROM test"), SQLite::Exception);
+}
+
+TEST(Function, window) {
+  SQLite::Database db(SQLite::MEMORY, SQLite::OPEN_READWRITE);
+  db.exec("CREATE TABLE test (id INTEGER PRIMARY KEY, value INTEGER)");
+  db.exec("INSERT INTO test VALUES (1, 1), (2, 10), (3, 100), (4, 1000)");
+  db.createWindowFunction<MovingSum>("msum");
+
+  SQLite::Statement query(db, "SELECT msum(value) OVER (ORDER BY id ROWS BETWEEN 1 PRECEDING AND CURRENT ROW) FROM test");
+  std::vector<long long> sums;
+  while (query.executeStep())
+    sums.push_back(query.getColumn(0).getInt64());
+  EXPECT_EQ((std::vector<long long>{1, 11, 110, 1100}), sums);
+
+  // Also usable as a regular aggregate
+  EXPECT_EQ(1111, db.execAndGet("SELECT msum(value) FROM test").getInt64());
+}
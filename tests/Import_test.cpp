@@ -0,0 +1,153 @@
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <gtest/gtest.h>
+#include <SQLiteCpp/Database.h>
+#include <SQLiteCpp/Exception.h>
+#include <SQLiteCpp/Import.h>
+#include <SQLiteCpp/Statement.h>
+
+namespace {
+
+const char* const CSV =
+    "id,name,comment\r\n"
+    "1,first,plain\r\n"
+    "2,\"second, quoted\",\"with \"\"doubled\"\" quotes\"\r\n"
+    "\r\n"
+    "3,third,\"multi\nline\"\r\n"
+    "4,fourth\n"
+    "5,fifth,";
+
+/// Single value of a query, as text (NULL as "<null>")
+std::string queryValue(SQLite::Database& aDb, const char* apQuery) {
+  SQLite::Statement query(aDb, apQuery);
+  query.executeStep();
+  return query.isColumnNull(0) ? "<null>" : query.getColumn(0).getString();
+}
+
+void checkImported(SQLite::Database& aDb) {
+  EXPECT_EQ("5", queryValue(aDb, "SELECT count(*) FROM data"));
+  EXPECT_EQ("second, quoted", queryValue(aDb, "SELECT name FROM data WHERE id = '2'"));
+  EXPECT_EQ("with \"doubled\" quotes", queryValue(aDb, "SELECT comment FROM data WHERE id = '2'"));
+  EXPECT_EQ("multi\nline", queryValue(aDb, "SELECT comment FROM data WHERE id = '3'"));
+  EXPECT_EQ("<null>", queryValue(aDb, "SELECT comment FROM data WHERE id = '4'"));
+  EXPECT_EQ("", queryValue(aDb, "SELECT comment FROM data WHERE id = '5'"));
+}
+
+} // namespace
+
+TEST(Import, stream) {
+  SQLite::Database db(":memory:", SQLite::OPEN_READWRITE);
+  std::istringstream input(CSV);
+  SQLite::CsvOptions options;
+  options.bCreateTable = true;
+  options.batchSize = 2;
+  const SQLite::ImportResult result = SQLite::importCsv(db, "data", input, options);
+  EXPECT_EQ(5, result.rows);
+  EXPECT_EQ(3, result.batches);
+  EXPECT_EQ(static_cast<long long>(std::string(CSV).size()), result.bytes);
+  EXPECT_GE(result.getRowsPerSecond(), 0.0);
+  checkImported(db);
+}
+
+TEST(Import, file) {
+  remove("test_import.csv");
+  {
+    std::ofstream file("test_import.csv", std::ios::binary);
+    file << CSV;
+  }
+  for (const unsigned threads : {1u, 3u}) {
+    SQLite::Database db(":memory:", SQLite::OPEN_READWRITE);
+    SQLite::CsvOptions options;
+    options.bCreateTable = true;
+    options.parserThreads = threads;
+    const SQLite::ImportResult result = SQLite::importCsv(db, "data", "test_import.csv", options);
+    EXPECT_EQ(5, result.rows);
+    EXPECT_EQ(1, result.batches);
+    checkImported(db);
+  }
+
+  // Large file without header into an existing table, with TSV, split in several chunks for the parser threads
+  {
+    std::ofstream file("test_import.csv", std::ios::binary);
+    for (int i = 0; i < 300000; ++i)
+      file << i << "\tname " << i << "\t\"quoted\t" << i << "\"\n";
+  }
+  SQLite::Database db(":memory:", SQLite::OPEN_READWRITE);
+  db.exec("CREATE TABLE data (id INTEGER PRIMARY KEY, name TEXT, comment TEXT)");
+  SQLite::CsvOptions options;
+  options.delimiter = '\t';
+  options.bHeader = false;
+  options.parserThreads = 4;
+  const SQLite::ImportResult result = SQLite::importCsv(db, "data", "test_import.csv", options);
+  EXPECT_EQ(300000, result.rows);
+  EXPECT_EQ(6, result.batches);
+  EXPECT_EQ("300000", queryValue(db, "SELECT count(*) FROM data"));
+  EXPECT_EQ("44999850000", queryValue(db, "SELECT sum(id) FROM data"));
+  EXPECT_EQ("quoted\t123456", queryValue(db, "SELECT comment FROM data WHERE id = 123456"));
+
+  // A quote inside an unquoted field is an ordinary character, also for the split into chunks:
+  // it must not make the newlines of the quoted fields after it look like the ends of records
+  {
+    std::ofstream file("test_import.csv", std::ios::binary);
+    file << "0,\"multi\nline 0\"\n1,in\"side\n";
+    for (int i = 2; i < 400000; ++i)
+      file << i << ",\"multi\nline " << i << "\"\n";
+  }
+  for (const unsigned threads : {1u, 4u}) {
+    SQLite::Database multi(":memory:", SQLite::OPEN_READWRITE);
+    multi.exec("CREATE TABLE data (id INTEGER PRIMARY KEY, comment TEXT)");
+    options.delimiter = ',';
+    options.parserThreads = threads;
+    EXPECT_EQ(400000, SQLite::importCsv(multi, "data", "test_import.csv", options).rows);
+    EXPECT_EQ("in\"side", queryValue(multi, "SELECT comment FROM data WHERE id = 1"));
+    EXPECT_EQ("multi\nline 399999", queryValue(multi, "SELECT comment FROM data WHERE id = 399999"));
+    EXPECT_EQ("0", queryValue(multi, "SELECT count(*) FROM data WHERE comment NOT LIKE 'multi%' AND id <> 1"));
+  }
+  remove("test_import.csv");
+}
+
+TEST(Import, emptyLines) {
+  const char* const csv = "a,b\n\n1,2\n\n\n3,4\r\n\r\n\n\n";
+  remove("test_import.csv");
+  {
+    std::ofstream file("test_import.csv", std::ios::binary);
+    file << csv;
+  }
+  for (const unsigned threads : {0u, 1u, 3u}) {
+    SQLite::Database db(":memory:", SQLite::OPEN_READWRITE);
+    SQLite::CsvOptions options;
+    options.bCreateTable = true;
+    options.parserThreads = threads;
+    std::istringstream input(csv);
+    // threads 0: from a stream
+    const SQLite::ImportResult result = (0 == threads) ? SQLite::importCsv(db, "data", input, options)
+                                                       : SQLite::importCsv(db, "data", "test_import.csv", options);
+    EXPECT_EQ(2, result.rows);
+    EXPECT_EQ("2", queryValue(db, "SELECT count(*) FROM data"));
+    EXPECT_EQ("0", queryValue(db, "SELECT count(*) FROM data WHERE a = '' OR b IS NULL"));
+  }
+  remove("test_import.csv");
+}
+
+TEST(Import, errors) {
+  SQLite::Database db(":memory:", SQLite::OPEN_READWRITE);
+  db.exec("CREATE TABLE data (a, b)");
+  SQLite::CsvOptions options;
+  options.batchSize = 1;
+
+  // the rows of the batches committed before the error remain
+  std::istringstream tooManyFields("a,b\n1,2\n3,4,5\n");
+  EXPECT_THROW(SQLite::importCsv(db, "data", tooManyFields, options), SQLite::Exception);
+  EXPECT_EQ("1", queryValue(db, "SELECT count(*) FROM data"));
+
+  std::istringstream unterminated("a,b\n1,\"2\n");
+  EXPECT_THROW(SQLite::importCsv(db, "data", unterminated, options), SQLite::Exception);
+  std::istringstream afterQuote("a,b\n1,\"2\"x\n");
+  EXPECT_THROW(SQLite::importCsv(db, "data", afterQuote, options), SQLite::Exception);
+  std::istringstream unknownColumn("a,c\n1,2\n");
+  EXPECT_THROW(SQLite::importCsv(db, "data", unknownColumn, options), SQLite::Exception);
+  EXPECT_THROW(SQLite::importCsv(db, "data", "no_such_file.csv", options), SQLite::Exception);
+  EXPECT_EQ("1", queryValue(db, "SELECT count(*) FROM data"));
+}
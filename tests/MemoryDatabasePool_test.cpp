@@ -0,0 +1,122 @@
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <sqlite3.h>
+#include <gtest/gtest.h>
+#include <SQLiteCpp/Database.h>
+#include <SQLiteCpp/Exception.h>
+#include <SQLiteCpp/MemoryDatabasePool.h>
+#include <SQLiteCpp/Statement.h>
+#include <SQLiteCpp/Transaction.h>
+
+namespace {
+
+int countRows(SQLite::Database& aDatabase) {
+  SQLite::Statement count(aDatabase, "SELECT count(*) FROM test");
+  count.executeStep();
+  return count.getColumn(0).getInt();
+}
+
+} // namespace
+
+TEST(MemoryDatabasePool, shared) {
+  EXPECT_THROW(SQLite::MemoryDatabasePool(""), SQLite::Exception);
+
+  SQLite::MemoryDatabasePool pool("test_pool", 2);
+  EXPECT_EQ("test_pool", pool.getName());
+  EXPECT_EQ("file:test_pool?mode=memory&cache=shared", pool.getUri());
+  EXPECT_EQ(2u, pool.getReaderCount());
+  {
+    SQLite::MemoryDatabasePool::Connection writer = pool.acquireWriter();
+    writer->exec("CREATE TABLE test (id INTEGER PRIMARY KEY, value TEXT)");
+    writer->exec("INSERT INTO test VALUES (1, 'one'), (2, 'two')");
+  }
+
+  // all the readers see the same database, and cannot modify it
+  SQLite::MemoryDatabasePool::Connection first = pool.acquireReader();
+  SQLite::MemoryDatabasePool::Connection second = pool.acquireReader();
+  EXPECT_NE(&*first, &*second);
+  EXPECT_EQ(2, countRows(*first));
+  EXPECT_EQ(2, countRows(*second));
+  EXPECT_THROW(first->exec("INSERT INTO test VALUES (3, 'three')"), SQLite::Exception);
+
+  // other connections to the same name share it, not the other names nor ":memory:"
+  SQLite::Database other(pool.getUri(), SQLite::OPEN_READONLY | SQLite::OPEN_URI);
+  EXPECT_EQ(2, countRows(other));
+  SQLite::MemoryDatabasePool otherPool("test_pool_other", 1);
+  EXPECT_FALSE(otherPool.acquireReader()->tableExists("test"));
+  SQLite::Database memory(":memory:");
+  EXPECT_FALSE(memory.tableExists("test"));
+
+  // all the readers are leased
+  EXPECT_FALSE(pool.tryAcquireReader());
+  SQLite::MemoryDatabasePool::Connection moved(std::move(second));
+  EXPECT_FALSE(second);
+  moved.release();
+  EXPECT_FALSE(moved);
+  SQLite::MemoryDatabasePool::Connection third = pool.tryAcquireReader();
+  ASSERT_TRUE(third);
+
+  // a thread waits for a reader to be given back
+  std::atomic<bool> bAcquired(false);
+  std::thread waiting([&] {
+    SQLite::MemoryDatabasePool::Connection reader = pool.acquireReader();
+    bAcquired = true;
+    EXPECT_EQ(2, countRows(*reader));
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_FALSE(bAcquired);
+  first.release();
+  waiting.join();
+  EXPECT_TRUE(bAcquired);
+}
+
+TEST(MemoryDatabasePool, readUncommitted) {
+  SQLite::MemoryDatabasePool pool("test_pool_uncommitted", 1);
+  SQLite::MemoryDatabasePool::Connection writer = pool.acquireWriter();
+  writer->exec("CREATE TABLE test (id INTEGER PRIMARY KEY)");
+
+  // the reader is not blocked by the transaction of the writer, and sees its changes
+  SQLite::Transaction transaction(*writer);
+  writer->exec("INSERT INTO test VALUES (1)");
+  EXPECT_EQ(1, countRows(*pool.acquireReader()));
+  transaction.commit();
+}
+
+TEST(MemoryDatabasePool, waitForUnlock) {
+  if (!SQLite::Database::hasUnlockNotify()) {
+    SQLite::Database db(":memory:");
+    EXPECT_THROW(db.setWaitForUnlock(true), SQLite::Exception);
+    return;
+  }
+
+  SQLite::MemoryDatabasePool pool("test_pool_committed", 1, false);
+  SQLite::MemoryDatabasePool::Connection writer = pool.acquireWriter();
+  EXPECT_TRUE(writer->getWaitForUnlock());
+  writer->exec("CREATE TABLE test (id INTEGER PRIMARY KEY)");
+
+  // without read_uncommitted, the table locked by the transaction of the writer fails without waiting
+  SQLite::Transaction transaction(*writer);
+  writer->exec("INSERT INTO test VALUES (1)");
+  {
+    SQLite::MemoryDatabasePool::Connection reader = pool.acquireReader();
+    reader->setWaitForUnlock(false);
+    SQLite::Statement count(*reader, "SELECT count(*) FROM test");
+    EXPECT_THROW(count.executeStep(), SQLite::Exception);
+    EXPECT_EQ(SQLITE_LOCKED_SHAREDCACHE, reader->getExtendedErrorCode());
+    reader->setWaitForUnlock(true);
+  }
+
+  // ... or waits for its commit
+  std::atomic<bool> bDone(false);
+  std::thread waiting([&] {
+    SQLite::MemoryDatabasePool::Connection reader = pool.acquireReader();
+    EXPECT_EQ(1, countRows(*reader));
+    bDone = true;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_FALSE(bDone);
+  transaction.commit();
+  waiting.join();
+  EXPECT_TRUE(bDone);
+}
@@ -0,0 +1,119 @@
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <sqlite3.h>
+#include <gtest/gtest.h>
+#include <SQLiteCpp/Database.h>
+#include <SQLiteCpp/Exception.h>
+#include <SQLiteCpp/MemoryGovernor.h>
+#include <SQLiteCpp/Statement.h>
+#include <SQLiteCpp/Transaction.h>
+
+namespace {
+
+// Fill the database file with a table of aRows rows of 100 bytes
+void createTable(SQLite::Database& aDatabase, const int aRows) {
+  aDatabase.exec("CREATE TABLE test (id INTEGER PRIMARY KEY, value TEXT)");
+  SQLite::Transaction transaction(aDatabase);
+  SQLite::Statement insert(aDatabase, "INSERT INTO test VALUES (?, printf('%100d', ?))");
+  for (int i = 1; i <= aRows; ++i) {
+    insert.bind(1, i);
+    insert.bind(2, i);
+    insert.exec();
+    insert.reset();
+  }
+  transaction.commit();
+}
+
+// Read the whole table, to fill the page cache of the connection
+void scan(SQLite::Database& aDatabase) {
+  SQLite::Statement query(aDatabase, "SELECT sum(length(value)) FROM test");
+  query.executeStep();
+}
+
+long long cacheUsed(const SQLite::Database& aDatabase) {
+  return aDatabase.getStatus().cacheUsed;
+}
+
+} // namespace
+
+TEST(MemoryGovernor, reclaim) {
+  remove("test_memory_a.db3");
+  remove("test_memory_b.db3");
+  {
+    SQLite::Database a("test_memory_a.db3", SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE);
+    SQLite::Database b("test_memory_b.db3", SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE);
+    createTable(a, 5000);
+    createTable(b, 5000);
+    EXPECT_GE(SQLite::getMemoryGovernorStats().connections, 2);
+
+    // without a budget, nothing is released, unless forced
+    scan(a);
+    scan(b);
+    EXPECT_EQ(0, SQLite::reclaimMemory());
+    EXPECT_GT(cacheUsed(a), 100000);
+    const SQLite::MemoryGovernorStats before = SQLite::getMemoryGovernorStats();
+    EXPECT_GT(SQLite::reclaimMemory(true), 0);
+    const SQLite::MemoryGovernorStats after = SQLite::getMemoryGovernorStats();
+    EXPECT_EQ(before.reclaims + 1, after.reclaims);
+    EXPECT_GE(after.connectionsReleased - before.connectionsReleased, 2);
+    EXPECT_GT(after.bytesReclaimed, before.bytesReclaimed);
+    EXPECT_LT(cacheUsed(a), 100000);
+    EXPECT_LT(cacheUsed(b), 100000);
+
+    // least recently used first: b is released, enough to get back under the target, and a is kept
+    scan(b);
+    EXPECT_EQ(0, SQLite::reclaimMemory()); // each check advances the clock of the last uses
+    scan(a);
+    SQLite::MemoryBudget budget;
+    budget.target = sqlite3_memory_used() - cacheUsed(b) / 2;
+    SQLite::setMemoryBudget(budget);
+    EXPECT_EQ(budget.target, SQLite::getMemoryBudget().target);
+    EXPECT_GT(cacheUsed(a), 100000);
+    EXPECT_LT(cacheUsed(b), 100000);
+
+    // a connection with a running statement is in use
+    scan(a);
+    SQLite::Statement running(a, "SELECT value FROM test");
+    ASSERT_TRUE(running.executeStep());
+    const long long skipped = SQLite::getMemoryGovernorStats().connectionsSkipped;
+    SQLite::reclaimMemory(true);
+    EXPECT_GT(SQLite::getMemoryGovernorStats().connectionsSkipped, skipped);
+    EXPECT_GT(cacheUsed(a), 100000);
+  }
+  SQLite::setMemoryBudget(SQLite::MemoryBudget());
+  remove("test_memory_a.db3");
+  remove("test_memory_b.db3");
+}
+
+TEST(MemoryGovernor, budget) {
+  remove("test_memory_a.db3");
+  {
+    SQLite::MemoryBudget budget;
+    budget.softLimit = 64 * 1024 * 1024;
+    budget.hardLimit = 256 * 1024 * 1024;
+    budget.target = 1; // always over the target
+    budget.checkInterval = std::chrono::milliseconds(10);
+    SQLite::setMemoryBudget(budget);
+    EXPECT_EQ(budget.softLimit, sqlite3_soft_heap_limit64(-1));
+    EXPECT_EQ(budget.hardLimit, sqlite3_hard_heap_limit64(-1));
+
+    // the background thread releases the cache of the idle connection
+    SQLite::Database db("test_memory_a.db3", SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE);
+    createTable(db, 5000);
+    scan(db);
+    const long long reclaims = SQLite::getMemoryGovernorStats().reclaims;
+    for (int i = 0; (i < 200) && (cacheUsed(db) > 100000); ++i)
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    EXPECT_LT(cacheUsed(db), 100000);
+    EXPECT_GT(SQLite::getMemoryGovernorStats().reclaims, reclaims);
+
+    budget.target = -1;
+    EXPECT_THROW(SQLite::setMemoryBudget(budget), SQLite::Exception);
+  }
+  SQLite::setMemoryBudget(SQLite::MemoryBudget());
+  EXPECT_EQ(0, sqlite3_soft_heap_limit64(-1));
+  EXPECT_EQ(0, sqlite3_hard_heap_limit64(-1));
+  remove("test_memory_a.db3");
+}
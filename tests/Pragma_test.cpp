@@ -0,0 +1,82 @@
+#include <cstdio>
+#include <string>
+#include <gtest/gtest.h>
+#include <SQLiteCpp/Database.h>
+#include <SQLiteCpp/Pragma.h>
+
+TEST(Pragma, typedAccessors) {
+  remove("test_pragma.db3");
+  {
+    SQLite::Database db("test_pragma.db3", SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE);
+
+    db.setPageSize(8192);
+    db.exec("CREATE TABLE test (id INTEGER PRIMARY KEY)");
+    EXPECT_EQ(8192, db.getPageSize());
+
+    EXPECT_EQ(SQLite::JournalMode::Delete, db.getJournalMode());
+    EXPECT_EQ(SQLite::JournalMode::Wal, db.setJournalMode(SQLite::JournalMode::Wal));
+    EXPECT_EQ(SQLite::JournalMode::Wal, db.getJournalMode());
+
+    db.setSynchronous(SQLite::Synchronous::Normal);
+    EXPECT_EQ(SQLite::Synchronous::Normal, db.getSynchronous());
+
+    db.setCacheSize(-4096);
+    EXPECT_EQ(-4096, db.getCacheSize());
+
+    db.setMmapSize(1024 * 1024);
+    EXPECT_EQ(1024 * 1024, db.getMmapSize());
+
+    db.setTempStore(SQLite::TempStore::Memory);
+    EXPECT_EQ(SQLite::TempStore::Memory, db.getTempStore());
+
+    db.setWalAutoCheckpoint(500);
+    EXPECT_EQ(500, db.getWalAutoCheckpoint());
+
+    EXPECT_EQ(SQLite::JournalMode::Delete, db.setJournalMode(SQLite::JournalMode::Delete));
+  }
+  remove("test_pragma.db3");
+}
+
+TEST(Pragma, profiles) {
+  remove("test_pragma.db3");
+  {
+    SQLite::Database db("test_pragma.db3", SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE,
+                        SQLite::ConnectionProfile::bulkLoad());
+    EXPECT_EQ(65536, db.getPageSize());
+    EXPECT_EQ(SQLite::JournalMode::Off, db.getJournalMode());
+    EXPECT_EQ(SQLite::Synchronous::Off, db.getSynchronous());
+    EXPECT_EQ(-256 * 1024, db.getCacheSize());
+    db.exec("CREATE TABLE test (id INTEGER PRIMARY KEY)");
+  }
+  {
+    SQLite::Database db("test_pragma.db3", SQLite::OPEN_READWRITE, SQLite::ConnectionProfile::readHeavy());
+    EXPECT_EQ(65536, db.getPageSize());
+    EXPECT_EQ(SQLite::JournalMode::Wal, db.getJournalMode());
+    EXPECT_EQ(SQLite::Synchronous::Normal, db.getSynchronous());
+    EXPECT_EQ(SQLite::TempStore::Memory, db.getTempStore());
+
+    // Only the values set are applied
+    SQLite::ConnectionProfile profile;
+    profile.walAutoCheckpoint = 100;
+    db.applyProfile(profile);
+    EXPECT_EQ(100, db.getWalAutoCheckpoint());
+    EXPECT_EQ(SQLite::Synchronous::Normal, db.getSynchronous());
+  }
+  {
+    // An in-memory database keeps its journal in memory
+    SQLite::Database db(SQLite::MEMORY, SQLite::OPEN_READWRITE, SQLite::ConnectionProfile::writeHeavy());
+    EXPECT_EQ(SQLite::JournalMode::Memory, db.getJournalMode());
+    EXPECT_EQ(4000, db.getWalAutoCheckpoint());
+    SQLite::Database ephemeral(SQLite::MEMORY, SQLite::OPEN_READWRITE,
+                               SQLite::ConnectionProfile::inMemoryEphemeral());
+    EXPECT_EQ(SQLite::Synchronous::Off, ephemeral.getSynchronous());
+  }
+  remove("test_pragma.db3");
+  remove("test_pragma.db3-wal");
+  remove("test_pragma.db3-shm");
+
+  // Invalid value
+  SQLite::ConnectionProfile invalid;
+  invalid.journalMode = static_cast<SQLite::JournalMode>(42);
+  EXPECT_THROW(SQLite::Database(SQLite::MEMORY, SQLite::OPEN_READWRITE, invalid), SQLite::Exception);
+}
@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <SQLiteCpp/Database.h>
+#include <SQLiteCpp/Statement.h>
+#include <SQLiteCpp/QueryPlan.h>
+
+TEST(QueryPlan, node) {
+  const SQLite::QueryPlanNode scan{2, 0, "SCAN test", {}};
+  EXPECT_TRUE(scan.isScan());
+  EXPECT_FALSE(scan.isTempBTree());
+  EXPECT_EQ("test", scan.getTable());
+
+  const SQLite::QueryPlanNode legacyScan{2, 0, "SCAN TABLE test AS t", {}};
+  EXPECT_TRUE(legacyScan.isScan());
+  EXPECT_EQ("test", legacyScan.getTable());
+
+  const SQLite::QueryPlanNode coveringScan{2, 0, "SCAN test USING COVERING INDEX idx", {}};
+  EXPECT_TRUE(coveringScan.isScan());
+  EXPECT_EQ("test", coveringScan.getTable());
+
+  const SQLite::QueryPlanNode search{2, 0, "SEARCH test USING INTEGER PRIMARY KEY (rowid=?)", {}};
+  EXPECT_FALSE(search.isScan());
+  EXPECT_EQ("test", search.getTable());
+
+  const SQLite::QueryPlanNode constant{2, 0, "SCAN CONSTANT ROW", {}};
+  EXPECT_FALSE(constant.isScan());
+
+  const SQLite::QueryPlanNode sort{3, 0, "USE TEMP B-TREE FOR ORDER BY", {}};
+  EXPECT_FALSE(sort.isScan());
+  EXPECT_TRUE(sort.isTempBTree());
+  EXPECT_EQ("", sort.getTable());
+}
+
+TEST(QueryPlan, explainPlan) {
+  SQLite::Database db(SQLite::MEMORY);
+  db.exec("CREATE TABLE test (id INTEGER PRIMARY KEY, value TEXT, weight INTEGER)");
+
+  SQLite::Statement lookup(db, "SELECT value FROM test WHERE id = ?");
+  SQLite::QueryPlan plan = lookup.explainPlan();
+  ASSERT_EQ(1u, plan.size());
+  EXPECT_EQ(0, plan[0].parent);
+  EXPECT_FALSE(plan[0].isScan());
+  EXPECT_EQ("test", plan[0].getTable());
+  EXPECT_TRUE(plan[0].children.empty());
+
+  SQLite::Statement scan(db, "SELECT value FROM test WHERE weight > 3 ORDER BY value");
+  plan = scan.explainPlan();
+  ASSERT_EQ(2u, plan.size());
+  EXPECT_TRUE(plan[0].isScan());
+  EXPECT_TRUE(plan[1].isTempBTree());
+
+  // Subqueries are children of their parent node
+  SQLite::Statement subquery(db, "SELECT * FROM test WHERE id IN (SELECT weight FROM test WHERE value = 'a')");
+  plan = subquery.explainPlan();
+  ASSERT_FALSE(plan.empty());
+  bool hasChildren = false;
+  for (const SQLite::QueryPlanNode& node : plan)
+    hasChildren = hasChildren || !node.children.empty();
+  EXPECT_TRUE(hasChildren);
+
+  // The statement itself is left untouched
+  EXPECT_FALSE(scan.executeStep());
+}
+
+TEST(QueryPlan, planCheck) {
+  SQLite::Database db(SQLite::MEMORY);
+  db.exec("CREATE TABLE small (id INTEGER PRIMARY KEY, value TEXT)");
+  db.exec("CREATE TABLE big (id INTEGER PRIMARY KEY, value TEXT)");
+  db.exec("INSERT INTO small VALUES (1, 'a')");
+  db.exec("WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i+1 FROM n WHERE i < 100) INSERT INTO big SELECT i, 'v' FROM n");
+
+  std::vector<SQLite::QueryPlanWarning> warnings;
+  db.setPlanCheck([&warnings](const SQLite::QueryPlanWarning& aWarning) { warnings.push_back(aWarning); }, 50);
+
+  // Point lookup: no warning
+  { SQLite::Statement query(db, "SELECT value FROM big WHERE id = 1"); }
+  EXPECT_TRUE(warnings.empty());
+
+  // Full scan of a small table: no warning
+  { SQLite::Statement query(db, "SELECT * FROM small WHERE value = 'a'"); }
+  EXPECT_TRUE(warnings.empty());
+
+  // Full scan of a big table
+  { SQLite::Statement query(db, "SELECT * FROM big WHERE value = 'a'"); }
+  ASSERT_EQ(1u, warnings.size());
+  EXPECT_EQ(SQLite::QueryPlanWarning::FULL_SCAN, warnings[0].kind);
+  EXPECT_EQ("SELECT * FROM big WHERE value = 'a'", warnings[0].sql);
+  EXPECT_EQ("big", warnings[0].table);
+  EXPECT_EQ(100, warnings[0].tableRows);
+
+  // Full scan of an aliased table: the plan names the alias, counted as the table
+  warnings.clear();
+  { SQLite::Statement query(db, "SELECT * FROM big AS x WHERE x.value = 'a'"); }
+  ASSERT_EQ(1u, warnings.size());
+  EXPECT_EQ(SQLite::QueryPlanWarning::FULL_SCAN, warnings[0].kind);
+  EXPECT_EQ("x", warnings[0].table);
+  EXPECT_EQ(100, warnings[0].tableRows);
+
+  // Self-join without index: both aliases of the big table are reported
+  warnings.clear();
+  { SQLite::Statement query(db, "SELECT * FROM small s, big x JOIN \"big\" AS y WHERE s.id = 1 AND x.value < y.value"); }
+  std::vector<std::string> scanned;
+  for (const SQLite::QueryPlanWarning& warning : warnings) {
+    if (SQLite::QueryPlanWarning::FULL_SCAN == warning.kind) {
+      EXPECT_EQ(100, warning.tableRows);
+      scanned.push_back(warning.table);
+    }
+  }
+  EXPECT_EQ((std::vector<std::string>{"x", "y"}), scanned);
+
+  // Full scan of a subquery, whose number of rows is unknown: reported anyway
+  warnings.clear();
+  { SQLite::Statement query(db, "SELECT * FROM (SELECT value FROM small ORDER BY value LIMIT 10) AS sub, big WHERE big.id = length(sub.value)"); }
+  bool bUnknown = false;
+  for (const SQLite::QueryPlanWarning& warning : warnings) {
+    if ((SQLite::QueryPlanWarning::FULL_SCAN == warning.kind) && (-1 == warning.tableRows))
+      bUnknown = true;
+  }
+  EXPECT_TRUE(bUnknown);
+
+  // Sort without index, on a small table
+  warnings.clear();
+  { SQLite::Statement query(db, "SELECT * FROM small ORDER BY value"); }
+  ASSERT_EQ(1u, warnings.size());
+  EXPECT_EQ(SQLite::QueryPlanWarning::TEMP_BTREE, warnings[0].kind);
+
+  // Callback can throw to make a test fail
+  db.setPlanCheck([](const SQLite::QueryPlanWarning&) { throw SQLite::Exception("full scan"); });
+  EXPECT_THROW(SQLite::Statement query(db, "SELECT * FROM small"), SQLite::Exception);
+
+  // Stop checking plans
+  warnings.clear();
+  db.setPlanCheck(nullptr);
+  { SQLite::Statement query(db, "SELECT * FROM big WHERE value = 'a'"); }
+  EXPECT_TRUE(warnings.empty());
+}
@@ -0,0 +1,144 @@
+#include <string>
+#include <vector>
+#include <sqlite3.h>
+#include <gtest/gtest.h>
+#include <SQLiteCpp/Database.h>
+#include <SQLiteCpp/Exception.h>
+#include <SQLiteCpp/Transaction.h>
+
+TEST(ResultCache, resultSet) {
+  SQLite::Database db(":memory:", SQLite::OPEN_READWRITE);
+  db.exec("CREATE TABLE test (id INTEGER PRIMARY KEY, name TEXT, weight REAL, data BLOB)");
+  db.exec("INSERT INTO test VALUES (1, 'first', 1.5, x'00ff'), (2, NULL, 2, NULL)");
+
+  // without the cache, the query is just executed
+  const auto rows = db.queryCached("SELECT id, name, weight, data FROM test ORDER BY id");
+  ASSERT_EQ(4, rows->getColumnCount());
+  ASSERT_EQ(2u, rows->getRowCount());
+  EXPECT_EQ("name", rows->getColumnName(1));
+  EXPECT_EQ(SQLite::INTEGER, rows->getType(0, 0));
+  EXPECT_EQ(1, rows->getInt64(0, 0));
+  EXPECT_EQ("first", rows->getText(0, 1));
+  EXPECT_EQ(1.5, rows->getDouble(0, 2));
+  ASSERT_EQ(2u, rows->getBlob(0, 3).size());
+  EXPECT_EQ(0xff, rows->getBlob(0, 3)[1]);
+  EXPECT_TRUE(rows->isNull(1, 1));
+  EXPECT_EQ(SQLite::FLOAT, rows->getType(1, 2));
+  EXPECT_EQ(2, rows->getInt64(1, 2));
+  EXPECT_TRUE(rows->getText(1, 3).empty());
+  EXPECT_THROW(rows->getInt64(2, 0), std::out_of_range);
+  EXPECT_EQ(0, db.getResultCacheStats().misses);
+
+  EXPECT_THROW(db.queryCached("SELECT * FROM nope"), SQLite::Exception);
+}
+
+TEST(ResultCache, hitsAndInvalidation) {
+  SQLite::Database db(":memory:", SQLite::OPEN_READWRITE);
+  db.exec("CREATE TABLE test (id INTEGER PRIMARY KEY, kind TEXT)");
+  db.exec("CREATE TABLE other (id INTEGER PRIMARY KEY)");
+  db.exec("CREATE VIEW kinds AS SELECT DISTINCT kind FROM test");
+  db.exec("INSERT INTO test VALUES (1, 'a'), (2, 'b'), (3, 'a')");
+  db.setResultCache(1024 * 1024);
+
+  const std::string byKind = "SELECT id FROM test WHERE kind = ? ORDER BY id";
+  const auto a = db.queryCached(byKind, "a");
+  EXPECT_EQ(2u, a->getRowCount());
+  EXPECT_EQ(a, db.queryCached(byKind, std::string("a"))); // same key: shared result
+  EXPECT_NE(a, db.queryCached(byKind, "b"));              // other value
+  EXPECT_NE(a, db.queryCached(byKind, 1));                // other type
+  const auto count = db.queryCached("SELECT count(*) FROM test");
+  const auto view = db.queryCached("SELECT * FROM kinds");
+  EXPECT_EQ(count, db.queryCached("SELECT count(*) FROM test"));
+  SQLite::ResultCacheStats stats = db.getResultCacheStats();
+  EXPECT_EQ(2, stats.hits);
+  EXPECT_EQ(5, stats.misses);
+  EXPECT_EQ(5u, stats.entries);
+  EXPECT_GT(stats.bytes, 0u);
+
+  // modifying another table keeps the results
+  db.exec("INSERT INTO other VALUES (1)");
+  EXPECT_EQ(a, db.queryCached(byKind, "a"));
+
+  // modifying the table drops all the results reading it, including through the view
+  db.exec("INSERT INTO test VALUES (4, 'c')");
+  stats = db.getResultCacheStats();
+  EXPECT_EQ(5, stats.invalidations);
+  EXPECT_EQ(0u, stats.entries);
+  EXPECT_EQ(0u, stats.bytes);
+  EXPECT_EQ(4, db.queryCached("SELECT count(*) FROM test")->getInt64(0, 0));
+  EXPECT_EQ(3u, db.queryCached("SELECT * FROM kinds")->getRowCount());
+
+  // "DELETE FROM table" is reported row by row
+  db.queryCached(byKind, "a");
+  db.exec("DELETE FROM test");
+  EXPECT_EQ(0, db.queryCached("SELECT count(*) FROM test")->getInt64(0, 0));
+  EXPECT_EQ(0u, db.queryCached(byKind, "a")->getRowCount());
+
+  // a rollback drops everything, as the results may have read uncommitted changes
+  {
+    SQLite::Transaction transaction(db);
+    db.exec("INSERT INTO test VALUES (5, 'a')");
+    EXPECT_EQ(1u, db.queryCached(byKind, "a")->getRowCount());
+  }
+  EXPECT_EQ(0u, db.getResultCacheStats().entries);
+  EXPECT_EQ(0u, db.queryCached(byKind, "a")->getRowCount());
+
+  // statements that are not read-only are not cached
+  db.queryCached("INSERT INTO other VALUES (?)", 2);
+  EXPECT_EQ(2, db.queryCached("SELECT count(*) FROM other")->getInt64(0, 0));
+  const std::size_t entries = db.getResultCacheStats().entries;
+  db.queryCached("INSERT INTO other VALUES (?)", 3);
+  EXPECT_EQ(entries - 1, db.getResultCacheStats().entries);
+
+  // dropping a table empties the cache
+  db.exec("DROP VIEW kinds");
+  EXPECT_EQ(0u, db.getResultCacheStats().entries);
+  db.exec("DROP TABLE other");
+  EXPECT_FALSE(db.tableExists("other"));
+
+  db.setResultCache(0);
+  EXPECT_EQ(0u, db.getResultCacheStats().entries);
+  EXPECT_NE(db.queryCached(byKind, "a"), db.queryCached(byKind, "a"));
+}
+
+TEST(ResultCache, eviction) {
+  SQLite::Database db(":memory:", SQLite::OPEN_READWRITE);
+  db.exec("CREATE TABLE test (id INTEGER PRIMARY KEY, value TEXT)");
+  db.exec("INSERT INTO test VALUES (1, 'one')");
+  db.setResultCache(1024 * 1024);
+  const std::string query = "SELECT value FROM test WHERE id = ?";
+  for (int id = 0; id < 10; ++id)
+    db.queryCached(query, id);
+  const std::size_t bytesPerEntry = db.getResultCacheStats().bytes / 10;
+
+  // the least recently used results are evicted first
+  db.setResultCache(bytesPerEntry * 3 + bytesPerEntry / 2);
+  EXPECT_EQ(3u, db.getResultCacheStats().entries);
+  EXPECT_EQ(7, db.getResultCacheStats().evictions);
+  const auto recent = db.queryCached(query, 7);
+  db.queryCached(query, 100);
+  EXPECT_EQ(recent, db.queryCached(query, 7));
+  EXPECT_EQ(3u, db.getResultCacheStats().entries);
+}
+
+TEST(ResultCache, withChangeSink) {
+  SQLite::Database db(":memory:", SQLite::OPEN_READWRITE);
+  db.exec("CREATE TABLE test (id INTEGER PRIMARY KEY)");
+  std::size_t changes = 0;
+  db.setChangeSink([&](const std::vector<SQLite::RowChange>& aChanges) { changes += aChanges.size(); });
+  db.setResultCache(1024 * 1024);
+
+  EXPECT_EQ(0, db.queryCached("SELECT count(*) FROM test")->getInt64(0, 0));
+  db.exec("INSERT INTO test VALUES (1)");
+  EXPECT_EQ(1u, changes);
+  EXPECT_EQ(1, db.queryCached("SELECT count(*) FROM test")->getInt64(0, 0));
+
+  // each one keeps working without the other
+  db.setChangeSink(nullptr);
+  db.exec("INSERT INTO test VALUES (2)");
+  EXPECT_EQ(2, db.queryCached("SELECT count(*) FROM test")->getInt64(0, 0));
+  db.setChangeSink([&](const std::vector<SQLite::RowChange>& aChanges) { changes += aChanges.size(); });
+  db.setResultCache(0);
+  db.exec("INSERT INTO test VALUES (3)");
+  EXPECT_EQ(2u, changes);
+}
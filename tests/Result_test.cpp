@@ -0,0 +1,99 @@
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <gtest/gtest.h>
+#include <sqlite3.h>
+#include <SQLiteCpp/Database.h>
+#include <SQLiteCpp/Exception.h>
+#include <SQLiteCpp/Result.h>
+#include <SQLiteCpp/Statement.h>
+#include <SQLiteCpp/Transaction.h>
+
+TEST(Result, statement) {
+  SQLite::Database db(":memory:", SQLite::OPEN_READWRITE);
+  EXPECT_EQ(0, db.tryExec("CREATE TABLE test (id INTEGER PRIMARY KEY, name TEXT NOT NULL, value REAL, data BLOB)").value());
+
+  SQLite::Expected<std::unique_ptr<SQLite::Statement>> prepared =
+      SQLite::Statement::tryPrepare(db, "INSERT INTO test VALUES (?, ?, ?, ?)");
+  ASSERT_TRUE(prepared.isOk());
+  SQLite::Statement& insert = *prepared.value();
+  EXPECT_TRUE(insert.tryBind(1, 1));
+  EXPECT_TRUE(insert.tryBind(2, std::string("first")));
+  EXPECT_TRUE(insert.tryBind(3, 0.5));
+  EXPECT_TRUE(insert.tryBind(4, "\x01\x02", 2));
+  SQLite::Expected<int> changes = insert.tryExec();
+  EXPECT_TRUE(changes);
+  EXPECT_EQ(SQLITE_DONE, changes.getErrorCode());
+  EXPECT_EQ(1, changes.value());
+
+  insert.reset();
+  EXPECT_TRUE(insert.tryBind(1, 2LL));
+  EXPECT_TRUE(insert.tryBind(2, "second"));
+  EXPECT_TRUE(insert.tryBind(3, 2u));
+  EXPECT_TRUE(insert.tryBind(4));
+  EXPECT_EQ(1, insert.tryExec().value());
+
+  // errors: out of range index, constraint, and rows returned
+  insert.reset();
+  insert.clearBindings();
+  const SQLite::Result range = insert.tryBind(5, 5);
+  EXPECT_FALSE(range);
+  EXPECT_EQ(SQLITE_RANGE, range.getErrorCode());
+  EXPECT_STREQ("column index out of range", range.getErrorMsg());
+  const SQLite::Expected<int> constraint = insert.tryExec();
+  EXPECT_FALSE(constraint.isOk());
+  EXPECT_FALSE(constraint.isBusy());
+  EXPECT_EQ(SQLITE_CONSTRAINT, constraint.getErrorCode());
+  EXPECT_STREQ("NOT NULL constraint failed: test.name", constraint.getErrorMsg());
+  try {
+    constraint.check();
+    FAIL();
+  } catch (const SQLite::Exception& e) {
+    EXPECT_EQ(SQLITE_CONSTRAINT, e.code());
+    EXPECT_STREQ("NOT NULL constraint failed: test.name", e.what());
+  }
+  EXPECT_THROW(constraint.value(), SQLite::Exception);
+
+  SQLite::Statement query(db, "SELECT * FROM test");
+  EXPECT_EQ(SQLITE_MISUSE, query.tryExec().getErrorCode());
+
+  // errors of prepare and exec
+  const SQLite::Expected<std::unique_ptr<SQLite::Statement>> invalid = SQLite::Statement::tryPrepare(db, "SELECT * FROM nope");
+  EXPECT_FALSE(invalid);
+  EXPECT_EQ(SQLITE_ERROR, invalid.getErrorCode());
+  EXPECT_STREQ("no such table: nope", invalid.getErrorMsg());
+  EXPECT_THROW(invalid.value(), SQLite::Exception);
+  const SQLite::Expected<int> syntax = db.tryExec("INSERT INTO");
+  EXPECT_FALSE(syntax);
+  EXPECT_EQ(SQLITE_ERROR, syntax.getErrorCode());
+
+  // message of a result no longer reported by the connection: the generic description of the code
+  EXPECT_TRUE(db.tryExec("SELECT 1"));
+  EXPECT_STREQ("SQL logic error", syntax.getErrorMsg());
+}
+
+TEST(Result, busyCommit) {
+  remove("test_result.db3");
+  {
+    SQLite::Database db1("test_result.db3", SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE);
+    SQLite::Database db2("test_result.db3", SQLite::OPEN_READWRITE);
+    db1.exec("CREATE TABLE test (id INTEGER PRIMARY KEY)");
+
+    // a reader in the middle of a statement prevents the commit of the writer (rollback journal)
+    db1.exec("INSERT INTO test VALUES (1)");
+    SQLite::Statement reader(db2, "SELECT id FROM test");
+    ASSERT_TRUE(reader.executeStep());
+
+    SQLite::Transaction transaction(db1);
+    EXPECT_TRUE(db1.tryExec("INSERT INTO test VALUES (2)"));
+    const SQLite::Result busy = transaction.tryCommit();
+    EXPECT_TRUE(busy.isBusy());
+    EXPECT_EQ(SQLITE_BUSY, busy.getErrorCode());
+
+    // retry once the reader is done
+    reader.reset();
+    EXPECT_TRUE(transaction.tryCommit());
+    EXPECT_EQ(SQLITE_MISUSE, transaction.tryCommit().getErrorCode());
+  }
+  remove("test_result.db3");
+}
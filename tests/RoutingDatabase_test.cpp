@@ -0,0 +1,199 @@
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include <SQLiteCpp/Exception.h>
+#include <SQLiteCpp/MemoryDatabasePool.h>
+#include <SQLiteCpp/RoutingDatabase.h>
+#include <SQLiteCpp/Transaction.h>
+
+namespace {
+
+struct Event {
+  long long   id;
+  std::string kind;
+};
+
+} // namespace
+
+template<>
+struct SQLite::FieldsOf<Event> {
+  static constexpr auto fields = SQLite::fields(&Event::id, &Event::kind);
+};
+
+TEST(RoutingDatabase, route) {
+  remove("test_routing.db3");
+  remove("test_routing.db3-wal");
+  remove("test_routing.db3-shm");
+  {
+    SQLite::RoutingDatabase db("test_routing.db3", 2, SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE, 1000);
+    EXPECT_EQ(2u, db.getReaderCount());
+    db.withWriter([](SQLite::Database& aWriter) {
+      aWriter.exec("PRAGMA journal_mode = WAL");
+      aWriter.exec("CREATE TABLE events (id INTEGER PRIMARY KEY, kind TEXT)");
+    });
+
+    // the writes go to the writer, the reads to a reader
+    EXPECT_EQ(SQLite::Route::Writer, db.getRoute("INSERT INTO events (kind) VALUES (?)"));
+    EXPECT_EQ(SQLite::Route::Reader, db.getRoute("SELECT id, kind FROM events WHERE kind = ?"));
+    EXPECT_EQ(1, db.exec("INSERT INTO events (kind) VALUES (?)", "click"));
+    EXPECT_EQ(1, db.exec("INSERT INTO events (kind) VALUES (?)", "view"));
+    const std::vector<Event> clicks = db.queryAll<Event>("SELECT id, kind FROM events WHERE kind = ?", "click");
+    ASSERT_EQ(1u, clicks.size());
+    EXPECT_EQ(1, clicks[0].id);
+
+    // the statements changing the connection go to the writer
+    EXPECT_EQ(SQLite::Route::Writer, db.getRoute("BEGIN"));
+    EXPECT_EQ(SQLite::Route::Writer, db.getRoute("  /* comment */ commit"));
+    EXPECT_EQ(SQLite::Route::Writer, db.getRoute("PRAGMA cache_size = 100"));
+    EXPECT_EQ(SQLite::Route::Reader, db.getRoute("-- commit\nSELECT 1"));
+    EXPECT_EQ(SQLite::Route::Reader, db.getRoute("SELECT 1 AS beginning"));
+    db.run("SELECT count(*) FROM events", [&](SQLite::Statement& aStatement) {
+      ASSERT_TRUE(aStatement.executeStep());
+      EXPECT_EQ(2, aStatement.getColumn(0).getInt());
+      EXPECT_TRUE(aStatement.isReadOnly());
+    });
+
+    // the decisions are cached per SQL text
+    const SQLite::RoutingStats stats = db.getStats();
+    EXPECT_EQ(2, stats.reads);
+    EXPECT_EQ(2, stats.writes);
+    EXPECT_EQ(3, stats.routeHits);
+    EXPECT_EQ(8, stats.routeMisses);
+    EXPECT_EQ(8u, stats.routes);
+    db.clearRoutes();
+    EXPECT_EQ(0u, db.getStats().routes);
+
+    // the readers cannot write, even when called directly
+    int readOnly = 0;
+    db.forEachConnection([&](SQLite::Database& aConnection) {
+      aConnection.exec("PRAGMA cache_size = 100");
+      try {
+        aConnection.exec("DELETE FROM events WHERE id < 0");
+      } catch (const SQLite::Exception&) {
+        ++readOnly;
+      }
+    });
+    EXPECT_EQ(2, readOnly);
+    EXPECT_THROW(db.exec("INSERT INTO nope VALUES (1)"), SQLite::Exception);
+
+    // transactions on the writer, not seen by the readers until committed
+    db.withWriter([&](SQLite::Database& aWriter) {
+      SQLite::Transaction transaction(aWriter);
+      aWriter.exec("INSERT INTO events (kind) VALUES ('click')");
+      EXPECT_EQ(1u, db.queryAll<Event>("SELECT id, kind FROM events WHERE kind = ?", "click").size());
+      transaction.commit();
+    });
+    EXPECT_EQ(2u, db.queryAll<Event>("SELECT id, kind FROM events WHERE kind = ?", "click").size());
+
+    // concurrent reads and writes
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+      threads.emplace_back([&db, t] {
+        for (int i = 0; i < 20; ++i) {
+          if (0 == t)
+            db.exec("INSERT INTO events (kind) VALUES (?)", "thread");
+          else
+            db.queryAll<Event>("SELECT id, kind FROM events WHERE kind = ?", "thread");
+        }
+      });
+    }
+    for (std::thread& thread : threads)
+      thread.join();
+    EXPECT_EQ(20u, db.queryAll<Event>("SELECT id, kind FROM events WHERE kind = ?", "thread").size());
+  }
+  remove("test_routing.db3");
+  remove("test_routing.db3-wal");
+  remove("test_routing.db3-shm");
+}
+
+TEST(RoutingDatabase, sharedMemory) {
+  SQLite::MemoryDatabasePool pool("test_routing_memory", 1);
+  SQLite::RoutingDatabase db(pool.getUri(), 2, SQLite::OPEN_READWRITE | SQLite::OPEN_URI);
+  db.withWriter([](SQLite::Database& aWriter) {
+    aWriter.exec("CREATE TABLE events (id INTEGER PRIMARY KEY, kind TEXT)");
+  });
+  db.exec("INSERT INTO events (kind) VALUES (?)", "click");
+  EXPECT_EQ(1u, db.queryAll<Event>("SELECT id, kind FROM events").size());
+  EXPECT_EQ(1u, pool.acquireReader()->execAndGet("SELECT count(*) FROM events").getUInt());
+  int readOnly = 0;
+  db.forEachConnection([&](SQLite::Database& aConnection) {
+    try {
+      aConnection.exec("DELETE FROM events WHERE id < 0");
+    } catch (const SQLite::Exception&) {
+      ++readOnly;
+    }
+  });
+  EXPECT_EQ(2, readOnly);
+}
+
+TEST(RoutingDatabase, parallelScan) {
+  remove("test_routing.db3");
+  remove("test_routing.db3-wal");
+  remove("test_routing.db3-shm");
+  {
+    SQLite::RoutingDatabase db("test_routing.db3", 3, SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE, 1000);
+    db.withWriter([](SQLite::Database& aWriter) {
+      aWriter.exec("PRAGMA journal_mode = WAL");
+      aWriter.exec("CREATE TABLE events (id INTEGER PRIMARY KEY, kind TEXT, value INTEGER)");
+      aWriter.exec("CREATE TABLE keyed (key TEXT PRIMARY KEY) WITHOUT ROWID");
+      aWriter.exec("CREATE TABLE empty (id INTEGER PRIMARY KEY)");
+      SQLite::Transaction transaction(aWriter);
+      SQLite::Statement insert(aWriter, "INSERT INTO events VALUES (?, 'kind', ?)");
+      for (int id = 1; id <= 1000; ++id) {
+        insert.bind(1, (id <= 900) ? id : id * 1000); // with a gap
+        insert.bind(2, id);
+        insert.exec();
+        insert.reset();
+      }
+      transaction.commit();
+    });
+    const auto add = [](long long& aPartial, SQLite::Statement& aRow) { aPartial += aRow.getColumn(0).getInt64(); };
+    const auto sum = [](long long aLeft, long long aRight) { return aLeft + aRight; };
+    EXPECT_EQ(3u, db.getPartitionCount(0));
+    EXPECT_EQ(2u, db.getPartitionCount(2));
+    EXPECT_EQ(3u, db.getPartitionCount(10));
+
+    // the partial results of all the partitions are merged
+    EXPECT_EQ(500500, db.parallelScan("events", "value", 0LL, add, sum));
+    EXPECT_EQ(500500, db.parallelScan("events", "value", 0LL, add, sum, 2));
+    EXPECT_EQ(500500, db.parallelScan("events", "value", 0LL, add, sum, 1));
+    EXPECT_EQ(0, db.parallelScan("empty", "id", 0LL, add, sum));
+
+    // each row is read by exactly one partition, in order of the partitions
+    std::vector<std::vector<long long>> ids(3);
+    db.scanPartitions("events", "id", 0, [&](SQLite::Statement& aQuery, std::size_t aPartition) {
+      while (aQuery.executeStep())
+        ids[aPartition].push_back(aQuery.getColumn(0).getInt64());
+    });
+    std::size_t total = 0;
+    for (std::size_t partition = 0; partition < ids.size(); ++partition) {
+      total += ids[partition].size();
+      if ((partition > 0) && !ids[partition - 1].empty() && !ids[partition].empty()) {
+        EXPECT_LT(ids[partition - 1].back(), ids[partition].front());
+      }
+    }
+    EXPECT_EQ(1000u, total);
+
+    // all the partitions read the state at the start of the scan, whatever is committed meanwhile
+    SQLite::Database other("test_routing.db3", SQLite::OPEN_READWRITE, 1000);
+    const long long count = db.parallelScan("events", "id", 0LL, [&](long long& aPartial, SQLite::Statement&) {
+      if (0 == aPartial++)
+        other.exec("DELETE FROM events WHERE id = 1000000");
+    }, sum);
+    EXPECT_EQ(1000, count);
+    EXPECT_EQ(999, db.parallelScan("events", "id", 0LL, [](long long& aPartial, SQLite::Statement&) { ++aPartial; }, sum));
+
+    // errors
+    EXPECT_THROW(db.parallelScan("keyed", "key", 0LL, add, sum), SQLite::Exception);
+    EXPECT_THROW(db.scanPartitions("events", "id", 0, [](SQLite::Statement&, std::size_t aPartition) {
+      if (1 == aPartition)
+        throw SQLite::Exception("partition");
+    }), SQLite::Exception);
+    EXPECT_EQ(999, db.parallelScan("events", "id", 0LL, [](long long& aPartial, SQLite::Statement&) { ++aPartial; }, sum));
+  }
+  remove("test_routing.db3");
+  remove("test_routing.db3-wal");
+  remove("test_routing.db3-shm");
+}
@@ -0,0 +1,152 @@
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <SQLiteCpp/Exception.h>
+#include <SQLiteCpp/Session.h>
+#include <SQLiteCpp/Statement.h>
+#include <SQLiteCpp/Transaction.h>
+
+namespace {
+
+const char* const SCHEMA = "CREATE TABLE test (id INTEGER PRIMARY KEY, value TEXT)";
+
+// Concatenation of the rows of the table, in order
+std::string dump(SQLite::Database& aDatabase) {
+  SQLite::Statement query(aDatabase, "SELECT id, value FROM test ORDER BY id");
+  std::string rows;
+  while (query.executeStep())
+    rows += std::to_string(query.getColumn(0).getInt()) + "=" + query.getColumn(1).getText() + ";";
+  return rows;
+}
+
+} // namespace
+
+TEST(Session, replicate) {
+  SQLite::Database primary(":memory:", SQLite::OPEN_READWRITE);
+  if (!SQLite::Session::isAvailable()) {
+    EXPECT_THROW(SQLite::Session session(primary), SQLite::Exception);
+    return;
+  }
+  SQLite::Database replica(":memory:", SQLite::OPEN_READWRITE);
+  primary.exec(SCHEMA);
+  replica.exec(SCHEMA);
+  primary.exec("INSERT INTO test VALUES (1, 'one'), (2, 'two')");
+  replica.exec("INSERT INTO test VALUES (1, 'one'), (2, 'two')");
+
+  SQLite::Session session(primary);
+  session.attach();
+  EXPECT_TRUE(session.isEmpty());
+  {
+    SQLite::Transaction transaction(primary);
+    primary.exec("INSERT INTO test VALUES (3, 'three')");
+    primary.exec("UPDATE test SET value = 'TWO' WHERE id = 2");
+    primary.exec("UPDATE test SET value = 'Two' WHERE id = 2"); // one change per row
+    primary.exec("DELETE FROM test WHERE id = 1");
+    transaction.commit();
+  }
+  EXPECT_FALSE(session.isEmpty());
+  const SQLite::Changeset changeset = session.changeset();
+  EXPECT_LE(session.patchset().size(), changeset.size());
+
+  SQLite::applyChangeset(replica, changeset);
+  EXPECT_EQ("2=Two;3=three;", dump(replica));
+  EXPECT_EQ(dump(primary), dump(replica));
+
+  // undo
+  SQLite::applyChangeset(replica, SQLite::invertChangeset(changeset));
+  EXPECT_EQ("1=one;2=two;", dump(replica));
+
+  // the next transaction in its own changeset
+  session.clear();
+  EXPECT_TRUE(session.isEmpty());
+  session.setEnabled(false);
+  primary.exec("INSERT INTO test VALUES (4, 'ignored')");
+  EXPECT_TRUE(session.isEmpty());
+  session.setEnabled(true);
+  primary.exec("INSERT INTO test VALUES (5, 'five')");
+  SQLite::applyChangeset(replica, session.changeset());
+  EXPECT_EQ("1=one;2=two;5=five;", dump(replica));
+}
+
+TEST(Session, conflicts) {
+  if (!SQLite::Session::isAvailable())
+    return;
+  SQLite::Database primary(":memory:", SQLite::OPEN_READWRITE);
+  SQLite::Database replica(":memory:", SQLite::OPEN_READWRITE);
+  primary.exec(SCHEMA);
+  replica.exec(SCHEMA);
+  primary.exec("INSERT INTO test VALUES (1, 'one')");
+  replica.exec("INSERT INTO test VALUES (1, 'diverged'), (2, 'local')");
+
+  SQLite::Session session(primary, "main");
+  session.attach("test");
+  primary.exec("UPDATE test SET value = 'ONE' WHERE id = 1"); // Data conflict: old value differs
+  primary.exec("INSERT INTO test VALUES (2, 'two')");         // Conflict: primary key exists
+  primary.exec("INSERT INTO test VALUES (3, 'three')");
+  const SQLite::Changeset changeset = session.changeset();
+
+  // abort: nothing applied
+  EXPECT_THROW(SQLite::applyChangeset(replica, changeset), SQLite::Exception);
+  EXPECT_EQ("1=diverged;2=local;", dump(replica));
+
+  // the handler sees each conflict, and an exception it throws aborts
+  std::vector<SQLite::ConflictType> conflicts;
+  EXPECT_THROW(SQLite::applyChangeset(replica, changeset, [&](SQLite::ConflictType aType, const std::string& aTable) {
+    EXPECT_EQ("test", aTable);
+    conflicts.push_back(aType);
+    if (conflicts.size() == 2)
+      throw std::runtime_error("stop");
+    return SQLite::ConflictAction::Omit;
+  }), std::runtime_error);
+  ASSERT_EQ(2u, conflicts.size());
+  EXPECT_EQ(SQLite::ConflictType::Data, conflicts[0]);
+  EXPECT_EQ(SQLite::ConflictType::Conflict, conflicts[1]);
+  EXPECT_EQ("1=diverged;2=local;", dump(replica));
+
+  // omit: the conflicting changes are skipped
+  SQLite::applyChangeset(replica, changeset, SQLite::ConflictAction::Omit);
+  EXPECT_EQ("1=diverged;2=local;3=three;", dump(replica));
+
+  // replace: the changes win
+  replica.exec("DELETE FROM test WHERE id = 3");
+  SQLite::applyChangeset(replica, changeset, SQLite::ConflictAction::Replace);
+  EXPECT_EQ("1=ONE;2=two;3=three;", dump(replica));
+}
+
+TEST(Session, withChangeSink) {
+  if (!SQLite::Session::isAvailable())
+    return;
+  SQLite::Database db(":memory:", SQLite::OPEN_READWRITE);
+  db.exec(SCHEMA);
+  int batches = 0;
+  const auto sink = [&](const std::vector<SQLite::RowChange>&) { ++batches; };
+  {
+    SQLite::Session session(db);
+    session.attach();
+
+    // the change sink without the values and the result cache leave the preupdate hook of the session alone
+    db.setChangeSink(sink);
+    db.setResultCache(1024 * 1024);
+    db.exec("INSERT INTO test VALUES (1, 'one')");
+    db.setChangeSink(nullptr);
+    db.setResultCache(0);
+    db.exec("INSERT INTO test VALUES (2, 'two')");
+    EXPECT_EQ(1, batches);
+
+    SQLite::Database replica(":memory:", SQLite::OPEN_READWRITE);
+    replica.exec(SCHEMA);
+    SQLite::applyChangeset(replica, session.changeset());
+    EXPECT_EQ("1=one;2=two;", dump(replica));
+
+    // the values are captured with the same preupdate hook
+    EXPECT_THROW(db.setChangeSink(sink, true), SQLite::Exception);
+    EXPECT_FALSE(session.isEmpty());
+  }
+  db.setChangeSink(sink, true);
+  EXPECT_THROW(SQLite::Session{db}, SQLite::Exception);
+  db.setChangeSink(nullptr);
+  SQLite::Session session(db);
+  session.attach();
+  db.exec("INSERT INTO test VALUES (3, 'three')");
+  EXPECT_FALSE(session.isEmpty());
+}
@@ -0,0 +1,96 @@
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <SQLiteCpp/Exception.h>
+#include <SQLiteCpp/ShardedDatabase.h>
+
+namespace {
+
+struct Event {
+  long long   id;
+  std::string kind;
+  double      value;
+};
+
+const std::vector<std::string> SHARD_FILES = {"test_shard_0.db3", "test_shard_1.db3", "test_shard_2.db3"};
+
+void removeShardFiles() {
+  for (const std::string& file : SHARD_FILES)
+    remove(file.c_str());
+}
+
+} // namespace
+
+template<>
+struct SQLite::FieldsOf<Event> {
+  static constexpr auto fields = SQLite::fields(&Event::id, &Event::kind, &Event::value);
+};
+
+TEST(ShardedDatabase, routeAndMerge) {
+  removeShardFiles();
+  {
+    SQLite::ShardedDatabase shards(SHARD_FILES, SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE);
+    EXPECT_EQ(3u, shards.getShardCount());
+    EXPECT_EQ(0, shards.exec("CREATE TABLE events (id INTEGER PRIMARY KEY, kind TEXT, value REAL)"));
+
+    // keyed writes: each row to its owning shard
+    for (long long id = 1; id <= 300; ++id) {
+      SQLite::Statement insert(shards.getShard(id), "INSERT INTO events VALUES (?, ?, ?)");
+      SQLite::bindStruct(insert, Event{id, (id % 2) ? "odd" : "even", id * 0.5});
+      insert.exec();
+    }
+    std::vector<int> counts(shards.getShardCount(), 0);
+    for (long long id = 1; id <= 300; ++id) {
+      const std::size_t index = shards.getShardIndex(id);
+      EXPECT_EQ(&shards.getShardAt(index), &shards.getShard(id));
+      ++counts[index];
+    }
+    for (std::size_t index = 0; index < shards.getShardCount(); ++index) {
+      EXPECT_GT(counts[index], 50); // sequential keys are spread
+      SQLite::Statement count(shards.getShardAt(index), "SELECT count(*) FROM events");
+      ASSERT_TRUE(count.executeStep());
+      EXPECT_EQ(counts[index], count.getColumn(0).getInt());
+    }
+
+    // concat
+    const std::vector<Event> odd = shards.queryAll<Event>("SELECT id, kind, value FROM events WHERE kind = ?", "odd");
+    EXPECT_EQ(150u, odd.size());
+
+    // ordered merge, with a global top-N
+    const std::vector<Event> all = shards.queryOrdered<Event>("SELECT id, kind, value FROM events ORDER BY id",
+        [](const Event& a, const Event& b) { return a.id < b.id; }, 0);
+    ASSERT_EQ(300u, all.size());
+    for (std::size_t i = 0; i < all.size(); ++i)
+      EXPECT_EQ(static_cast<long long>(i) + 1, all[i].id);
+    const std::vector<Event> top = shards.queryOrdered<Event>(
+        "SELECT id, kind, value FROM events WHERE kind = ? ORDER BY value DESC LIMIT 5",
+        [](const Event& a, const Event& b) { return a.value > b.value; }, 5, "even");
+    ASSERT_EQ(5u, top.size());
+    EXPECT_EQ(300, top[0].id);
+    EXPECT_EQ(292, top[4].id);
+
+    // aggregates
+    EXPECT_EQ(300, shards.queryAggregate<long long>(SQLite::Aggregate::Count, "SELECT count(*) FROM events").value());
+    EXPECT_EQ(22575.0, shards.queryAggregate<double>(SQLite::Aggregate::Sum, "SELECT total(value) FROM events").value());
+    EXPECT_EQ(1, shards.queryAggregate<long long>(SQLite::Aggregate::Min, "SELECT min(id) FROM events").value());
+    EXPECT_EQ(299, shards.queryAggregate<long long>(SQLite::Aggregate::Max,
+                                                   "SELECT max(id) FROM events WHERE kind = ?", "odd").value());
+    EXPECT_FALSE(shards.queryAggregate<long long>(SQLite::Aggregate::Max, "SELECT max(id) FROM events WHERE id < 0"));
+
+    // the error of a shard is rethrown once all the shards are done
+    EXPECT_THROW(shards.queryAll<Event>("SELECT * FROM nope"), SQLite::Exception);
+    EXPECT_THROW(shards.exec("INSERT INTO nope VALUES (1)"), SQLite::Exception);
+  }
+
+  // custom hash: modulo, on a single thread
+  {
+    SQLite::ShardedDatabase shards(SHARD_FILES, SQLite::OPEN_READONLY,
+                                   [](long long aKey) { return static_cast<std::size_t>(aKey); }, 1);
+    EXPECT_EQ(1u, shards.getShardIndex(4));
+    EXPECT_EQ(300, shards.queryAggregate<long long>(SQLite::Aggregate::Count, "SELECT count(*) FROM events").value());
+  }
+  removeShardFiles();
+
+  EXPECT_THROW(SQLite::ShardedDatabase(std::vector<std::string>()), SQLite::Exception);
+}
@@ -0,0 +1,84 @@
+#include <cstdio>
+#include <gtest/gtest.h>
+#include <SQLiteCpp/Database.h>
+#include <SQLiteCpp/Exception.h>
+#include <SQLiteCpp/Snapshot.h>
+
+namespace {
+
+void removeFiles() {
+  remove("test_snapshot.db3");
+  remove("test_snapshot.db3-wal");
+  remove("test_snapshot.db3-shm");
+}
+
+int countRows(SQLite::Database& aDatabase) {
+  return aDatabase.execAndGet("SELECT count(*) FROM test").getInt();
+}
+
+} // namespace
+
+TEST(Snapshot, readTransaction) {
+  removeFiles();
+  {
+    SQLite::Database writer("test_snapshot.db3", SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE);
+    writer.exec("PRAGMA journal_mode = WAL");
+    writer.exec("CREATE TABLE test (id INTEGER PRIMARY KEY)");
+    writer.exec("INSERT INTO test VALUES (1)");
+    SQLite::Database reader("test_snapshot.db3", SQLite::OPEN_READONLY);
+
+    // the read transaction sees the state at its start, not the changes committed since
+    {
+      SQLite::ReadTransaction transaction(reader);
+      writer.exec("INSERT INTO test VALUES (2)");
+      EXPECT_EQ(1, countRows(reader));
+      EXPECT_THROW(SQLite::ReadTransaction{reader}, SQLite::Exception); // already in a transaction
+      transaction.end();
+      EXPECT_THROW(transaction.end(), SQLite::Exception);
+    }
+    EXPECT_EQ(2, countRows(reader));
+    EXPECT_THROW(SQLite::ReadTransaction(reader, "nope"), SQLite::Exception);
+    EXPECT_NO_THROW(SQLite::ReadTransaction{reader}); // the failed transaction was rolled back
+  }
+  removeFiles();
+}
+
+TEST(Snapshot, sameState) {
+  removeFiles();
+  {
+    SQLite::Database writer("test_snapshot.db3", SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE);
+    writer.exec("PRAGMA journal_mode = WAL");
+    writer.exec("CREATE TABLE test (id INTEGER PRIMARY KEY)");
+    writer.exec("INSERT INTO test VALUES (1)");
+    SQLite::Database first("test_snapshot.db3", SQLite::OPEN_READONLY);
+    SQLite::Database second("test_snapshot.db3", SQLite::OPEN_READONLY);
+
+    if (!SQLite::Snapshot::isAvailable()) {
+      SQLite::ReadTransaction transaction(first);
+      EXPECT_THROW(transaction.getSnapshot(), SQLite::Exception);
+    } else {
+      // the second connection reads the state captured by the first one, whatever was committed since
+      SQLite::ReadTransaction firstTransaction(first);
+      const SQLite::Snapshot snapshot = firstTransaction.getSnapshot();
+      EXPECT_EQ("main", snapshot.getDbName());
+      writer.exec("INSERT INTO test VALUES (2)");
+      {
+        SQLite::ReadTransaction secondTransaction(second, snapshot);
+        EXPECT_EQ(1, countRows(second));
+        EXPECT_EQ(0, snapshot.compare(secondTransaction.getSnapshot()));
+      }
+      {
+        SQLite::ReadTransaction latest(second);
+        EXPECT_EQ(2, countRows(second));
+        EXPECT_GT(latest.getSnapshot().compare(snapshot), 0);
+      }
+
+      // outside of a read transaction, or without WAL
+      EXPECT_THROW(SQLite::Snapshot{writer}, SQLite::Exception);
+      SQLite::Database memory(":memory:", SQLite::OPEN_READWRITE);
+      SQLite::ReadTransaction transaction(memory);
+      EXPECT_THROW(transaction.getSnapshot(), SQLite::Exception);
+    }
+  }
+  removeFiles();
+}
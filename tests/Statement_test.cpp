@@ -777,3 +777,38 @@ TEST(Statement, bind64bitsLong) {
     EXPECT_EQ(4294967297L, query.getColumn(0).getInt64());
 }
 #endif
+
+TEST(Statement, getStatus) {
+    SQLite::Database db(":memory:", SQLite::OPEN_READWRITE|SQLite::OPEN_CREATE);
+    db.exec("CREATE TABLE test (id INTEGER PRIMARY KEY, value TEXT)");
+    db.exec("INSERT INTO test VALUES (1, 'b'), (2, 'a'), (3, 'c')");
+
+    // Full table scan with a temporary sort
+    SQLite::Statement query(db, "SELECT * FROM test WHERE value > '' ORDER BY value");
+    SQLite::StatementStatus status = query.getStatus();
+    EXPECT_EQ(0, status.fullscanSteps);
+    EXPECT_EQ(0, status.runs);
+    EXPECT_LT(0, status.memUsed);
+
+    while (query.executeStep()) {}
+    status = query.getStatus(true);
+    EXPECT_EQ(2, status.fullscanSteps);
+    EXPECT_EQ(1, status.sorts);
+    EXPECT_LT(0, status.vmSteps);
+    EXPECT_EQ(1, status.runs);
+
+    // Counters have been reset
+    status = query.getStatus();
+    EXPECT_EQ(0, status.fullscanSteps);
+    EXPECT_EQ(0, status.sorts);
+    EXPECT_EQ(0, status.vmSteps);
+    EXPECT_EQ(0, status.runs);
+    EXPECT_LT(0, status.memUsed);
+
+    // Point lookup by rowid: no scan, no sort
+    SQLite::Statement lookup(db, "SELECT value FROM test WHERE id = 2");
+    EXPECT_TRUE(lookup.executeStep());
+    status = lookup.getStatus();
+    EXPECT_EQ(0, status.fullscanSteps);
+    EXPECT_EQ(0, status.sorts);
+}
@@ -0,0 +1,61 @@
+#include <string>
+#include <gtest/gtest.h>
+#include <SQLiteCpp/Database.h>
+#include <SQLiteCpp/Statement.h>
+#include <SQLiteCpp/Status.h>
+
+TEST(Status, database) {
+  SQLite::Database db(SQLite::MEMORY);
+  db.exec("CREATE TABLE test (id INTEGER PRIMARY KEY, value TEXT)");
+
+  const SQLite::DatabaseStatus before = db.getStatus();
+  EXPECT_LT(0, before.cacheUsed);
+  EXPECT_LT(0, before.schemaUsed);
+
+  for (int i = 0; i < 100; ++i)
+    db.exec("INSERT INTO test VALUES (NULL, 'some text to fill a few pages of the page cache')");
+  SQLite::Statement query(db, "SELECT count(*) FROM test");
+  EXPECT_TRUE(query.executeStep());
+
+  const SQLite::DatabaseStatus after = db.getStatus();
+  EXPECT_LT(0, after.stmtUsed);
+
+  const SQLite::DatabaseStatus delta = after - before;
+  EXPECT_LT(0, delta.cacheHit);
+  EXPECT_EQ(after.cacheHit - before.cacheHit, delta.cacheHit);
+  EXPECT_EQ(after.stmtUsed - before.stmtUsed, delta.stmtUsed);
+  EXPECT_LT(0.0, after.getCacheHitRate());
+  EXPECT_GE(1.0, after.getCacheHitRate());
+
+  // Reset the counters
+  (void)db.getStatus(true);
+  const SQLite::DatabaseStatus reset = db.getStatus();
+  EXPECT_EQ(0, reset.cacheHit);
+  EXPECT_EQ(0, reset.cacheMiss);
+  EXPECT_EQ(0.0, reset.getCacheHitRate());
+  EXPECT_EQ(after.cacheUsed, reset.cacheUsed);
+}
+
+TEST(Status, memory) {
+  const SQLite::MemoryStatus before = SQLite::getMemoryStatus();
+  {
+    SQLite::Database db(SQLite::MEMORY);
+    db.exec("CREATE TABLE test (id INTEGER PRIMARY KEY, value TEXT)");
+
+    const SQLite::MemoryStatus during = SQLite::getMemoryStatus();
+    EXPECT_LT(0, during.memoryUsed);
+    EXPECT_LE(during.memoryUsed, during.memoryUsedHighwater);
+    EXPECT_LT(0, during.mallocCount);
+    EXPECT_LT(0, during.mallocSizeHighwater);
+
+    const SQLite::MemoryStatus delta = during - before;
+    EXPECT_LT(0, delta.memoryUsed);
+    EXPECT_LT(0, delta.mallocCount);
+  }
+  const SQLite::MemoryStatus after = SQLite::getMemoryStatus(true);
+  EXPECT_EQ(before.memoryUsed, after.memoryUsed);
+
+  // Highwater marks have been reset to the current values
+  const SQLite::MemoryStatus reset = SQLite::getMemoryStatus();
+  EXPECT_EQ(reset.memoryUsed, reset.memoryUsedHighwater);
+}
@@ -0,0 +1,84 @@
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <SQLiteCpp/Database.h>
+#include <SQLiteCpp/Statement.h>
+#include <SQLiteCpp/Trace.h>
+
+TEST(Trace, sink) {
+  SQLite::Database db(SQLite::MEMORY);
+  db.exec("CREATE TABLE test (id INTEGER PRIMARY KEY, value TEXT)");
+  db.exec("INSERT INTO test VALUES (NULL, 'first'), (NULL, 'second'), (NULL, 'third')");
+
+  std::vector<SQLite::TraceEvent> events;
+  db.setTraceSink([&events](const SQLite::TraceEvent& aEvent) { events.push_back(aEvent); });
+
+  {
+    SQLite::Statement query(db, "SELECT * FROM test WHERE id > ?");
+    query.bind(1, 1);
+    while (query.executeStep()) {}
+  }
+  ASSERT_EQ(1u, events.size());
+  EXPECT_EQ("SELECT * FROM test WHERE id > ?", events[0].sql);
+  EXPECT_EQ(2, events[0].rows);
+  EXPECT_LE(0, events[0].elapsedNs);
+
+  // Statements run by exec() are traced too
+  db.exec("UPDATE test SET value='updated' WHERE id=1");
+  ASSERT_EQ(2u, events.size());
+  EXPECT_EQ("UPDATE test SET value='updated' WHERE id=1", events[1].sql);
+  EXPECT_EQ(0, events[1].rows);
+
+  // A statement reset before the end reports the rows fetched so far
+  {
+    SQLite::Statement query(db, "SELECT * FROM test");
+    EXPECT_TRUE(query.executeStep());
+    query.reset();
+  }
+  ASSERT_EQ(3u, events.size());
+  EXPECT_EQ(1, events[2].rows);
+
+  // Stop tracing
+  db.setTraceSink(nullptr);
+  db.exec("DELETE FROM test");
+  EXPECT_EQ(3u, events.size());
+}
+
+TEST(Trace, expandedSql) {
+  SQLite::Database db(SQLite::MEMORY);
+  db.exec("CREATE TABLE test (id INTEGER PRIMARY KEY, value TEXT)");
+
+  std::vector<SQLite::TraceEvent> events;
+  db.setTraceSink([&events](const SQLite::TraceEvent& aEvent) { events.push_back(aEvent); }, true);
+
+  SQLite::Statement insert(db, "INSERT INTO test VALUES (?, ?)");
+  insert.bind(1, 42);
+  insert.bind(2, std::string("answer"));
+  EXPECT_EQ(1, insert.exec());
+  insert.reset();
+
+  ASSERT_EQ(1u, events.size());
+  EXPECT_EQ("INSERT INTO test VALUES (42, 'answer')", events[0].sql);
+}
+
+TEST(Trace, slowQueryLogger) {
+  std::ostringstream log;
+
+  const SQLite::SlowQueryLogger logAll(log, std::chrono::nanoseconds(0));
+  logAll(SQLite::TraceEvent{"SELECT 1", 1500000, 1});
+  EXPECT_EQ("slow query (1.500 ms, 1 rows): SELECT 1\n", log.str());
+
+  log.str("");
+  const SQLite::SlowQueryLogger logSlow(log, std::chrono::seconds(1));
+  EXPECT_EQ(std::chrono::seconds(1), logSlow.getThreshold());
+  logSlow(SQLite::TraceEvent{"SELECT 1", 1500000, 1});
+  EXPECT_EQ("", log.str());
+
+  // Plugged into a Database
+  SQLite::Database db(SQLite::MEMORY);
+  db.setTraceSink(logAll);
+  db.exec("CREATE TABLE test (id INTEGER PRIMARY KEY)");
+  EXPECT_NE(std::string::npos, log.str().find("rows): CREATE TABLE test (id INTEGER PRIMARY KEY)\n"));
+}
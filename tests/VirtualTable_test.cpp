@@ -0,0 +1,169 @@
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <gtest/gtest.h>
+#include <SQLiteCpp/Database.h>
+#include <SQLiteCpp/Statement.h>
+#include <SQLiteCpp/VirtualTable.h>
+
+namespace {
+
+struct Track {
+  long long               id;
+  std::string             name;
+  double                  duration;
+  std::optional<int>      rating;
+};
+
+const std::vector<Track> tracks = {
+  {10, "first", 1.5, 3},
+  {20, "second", 2.5, std::nullopt},
+  {20, "second bis", 2.0, 5},
+  {30, "third", 3.5, 4},
+  {40, "fourth", 4.5, 1}
+};
+
+std::vector<long long> getIds(SQLite::Statement& aQuery) {
+  std::vector<long long> ids;
+  while (aQuery.executeStep())
+    ids.push_back(aQuery.getColumn(0).getInt64());
+  return ids;
+}
+
+} // namespace
+
+TEST(VirtualTable, scan) {
+  SQLite::Database db(SQLite::MEMORY, SQLite::OPEN_READWRITE);
+  db.createContainerTable("tracks", tracks,
+                          SQLite::sortedKeyColumn("id", &Track::id),
+                          SQLite::tableColumn("name", &Track::name),
+                          SQLite::tableColumn("duration", &Track::duration),
+                          SQLite::tableColumn("rating", &Track::rating));
+
+  EXPECT_EQ(5, db.execAndGet("SELECT count(*) FROM tracks").getInt());
+  SQLite::Statement query(db, "SELECT rowid, id, name, duration, rating FROM tracks");
+  ASSERT_TRUE(query.executeStep());
+  EXPECT_EQ(0, query.getColumn(0).getInt64());
+  EXPECT_EQ(10, query.getColumn(1).getInt64());
+  EXPECT_EQ(std::string("first"), query.getColumn(2).getString());
+  EXPECT_DOUBLE_EQ(1.5, query.getColumn(3).getDouble());
+  EXPECT_EQ(3, query.getColumn(4).getInt());
+  ASSERT_TRUE(query.executeStep());
+  EXPECT_TRUE(query.getColumn(4).isNull());
+
+  // Read only
+  EXPECT_THROW(db.exec("DELETE FROM tracks"), SQLite::Exception);
+}
+
+TEST(VirtualTable, sortedKey) {
+  SQLite::Database db(SQLite::MEMORY, SQLite::OPEN_READWRITE);
+  db.createContainerTable("tracks", tracks,
+                          SQLite::sortedKeyColumn("id", &Track::id),
+                          SQLite::tableColumn("name", &Track::name));
+
+  SQLite::Statement equal(db, "SELECT id FROM tracks WHERE id = ?");
+  equal.bind(1, 20);
+  EXPECT_EQ((std::vector<long long>{20, 20}), getIds(equal));
+  equal.reset();
+  equal.bind(1, 25);
+  EXPECT_TRUE(getIds(equal).empty());
+  equal.reset();
+  equal.bind(1, "20"); // text compared to an INTEGER column: not used for the binary search
+  EXPECT_EQ((std::vector<long long>{20, 20}), getIds(equal));
+
+  SQLite::Statement range(db, "SELECT id FROM tracks WHERE id > ? AND id <= ?");
+  range.bind(1, 10);
+  range.bind(2, 30);
+  EXPECT_EQ((std::vector<long long>{20, 20, 30}), getIds(range));
+  range.reset();
+  range.bind(1, 19.5);
+  range.bind(2, 20.5);
+  EXPECT_EQ((std::vector<long long>{20, 20}), getIds(range));
+
+  SQLite::Statement less(db, "SELECT id FROM tracks WHERE id < 20 OR id >= 40 ORDER BY id");
+  EXPECT_EQ((std::vector<long long>{10, 40}), getIds(less));
+
+  SQLite::Statement rowid(db, "SELECT id FROM tracks WHERE rowid = 3");
+  EXPECT_EQ((std::vector<long long>{30}), getIds(rowid));
+
+  // Binary search instead of full scan, and no sort for the ORDER BY on the sorted key
+  SQLite::Statement ordered(db, "SELECT id FROM tracks WHERE id >= 20 ORDER BY id");
+  for (const SQLite::QueryPlanNode& node : ordered.explainPlan())
+    EXPECT_FALSE(node.isTempBTree()) << node.detail;
+  EXPECT_EQ((std::vector<long long>{20, 20, 30, 40}), getIds(ordered));
+}
+
+TEST(VirtualTable, join) {
+  SQLite::Database db(SQLite::MEMORY, SQLite::OPEN_READWRITE);
+  db.exec("CREATE TABLE plays (track_id INTEGER, count INTEGER)");
+  db.exec("INSERT INTO plays VALUES (30, 7), (10, 2), (99, 1)");
+  db.createContainerTable("tracks", tracks,
+                          SQLite::sortedKeyColumn("id", &Track::id),
+                          SQLite::tableColumn("name", &Track::name));
+
+  SQLite::Statement query(db, "SELECT name, count FROM plays JOIN tracks ON tracks.id = plays.track_id "
+                              "ORDER BY count DESC");
+  ASSERT_TRUE(query.executeStep());
+  EXPECT_EQ(std::string("third"), query.getColumn(0).getString());
+  ASSERT_TRUE(query.executeStep());
+  EXPECT_EQ(std::string("first"), query.getColumn(0).getString());
+  EXPECT_FALSE(query.executeStep());
+
+  // The container is read in place: later changes are visible
+  std::vector<Track> more = tracks;
+  db.createContainerTable("tracks", more, SQLite::sortedKeyColumn("id", &Track::id));
+  more.push_back({99, "new", 0.0, std::nullopt});
+  EXPECT_EQ(3, db.execAndGet("SELECT count(*) FROM plays JOIN tracks ON tracks.id = plays.track_id").getInt());
+}
+
+TEST(VirtualTable, array) {
+  SQLite::Database db(SQLite::MEMORY, SQLite::OPEN_READWRITE);
+  db.exec("CREATE TABLE test (id INTEGER PRIMARY KEY, value REAL, name TEXT)");
+  db.exec("INSERT INTO test VALUES (1, 0.5, 'one'), (2, 1.5, 'two'), (3, 2.5, 'three'), (4, 3.5, 'four')");
+  db.createArrayFunction();
+
+  // One prepared statement for IN lists of any size
+  SQLite::Statement query(db, "SELECT id FROM test WHERE id IN carray(?) ORDER BY id");
+  const std::vector<long long> ids = {4, 2, 42};
+  query.bindArray(1, ids);
+  EXPECT_EQ((std::vector<long long>{2, 4}), getIds(query));
+  query.reset();
+  std::vector<long long> many(1000);
+  for (size_t i = 0; i < many.size(); ++i)
+    many[i] = static_cast<long long>(i);
+  query.bindArray(1, many);
+  EXPECT_EQ((std::vector<long long>{1, 2, 3, 4}), getIds(query));
+  query.reset();
+  query.bindArray(1, SQLite::Span<const long long>());
+  EXPECT_TRUE(getIds(query).empty());
+  query.reset();
+  const std::vector<std::int64_t> ids64 = {3, 1};
+  query.bindArray(1, ids64);
+  EXPECT_EQ((std::vector<long long>{1, 3}), getIds(query));
+  SQLite::Statement named(db, "SELECT id FROM test WHERE id IN carray(:ids) ORDER BY id");
+  named.bindArray(":ids", ids64);
+  EXPECT_EQ((std::vector<long long>{1, 3}), getIds(named));
+
+  SQLite::Statement reals(db, "SELECT id FROM test WHERE value IN carray(:values)");
+  const std::vector<double> values = {1.5, 3.5};
+  reals.bindArray(":values", values);
+  EXPECT_EQ((std::vector<long long>{2, 4}), getIds(reals));
+
+  SQLite::Statement names(db, "SELECT id FROM test WHERE name IN carray(?)");
+  const std::vector<std::string_view> texts = {"three", "five"};
+  names.bindArray(1, texts);
+  EXPECT_EQ((std::vector<long long>{3}), getIds(names));
+
+  SQLite::Statement table(db, "SELECT value FROM carray(?)");
+  table.bindArray(1, texts);
+  ASSERT_TRUE(table.executeStep());
+  EXPECT_EQ(std::string("three"), table.getColumn(0).getString());
+
+  // A value bound by bind() is not an array
+  SQLite::Statement notArray(db, "SELECT count(*) FROM carray(?)");
+  notArray.bind(1, 42);
+  ASSERT_TRUE(notArray.executeStep());
+  EXPECT_EQ(0, notArray.getColumn(0).getInt());
+}